@@ -140,6 +140,10 @@ static char * opt_mysql_unix_port=0;
 static char *opt_bind_addr = NULL;
 static int   first_error=0;
 static DYNAMIC_STRING extended_row;
+static uint opt_parallel= 0;
+static char *opt_parallel_dir= 0;
+/* SQL_LOG_BIN=0 is in effect for the dump */
+static my_bool is_binlog_disabled= FALSE;
 #include <sslopt-vars.h>
 FILE *md_result_file= 0;
 FILE *stderror_file=0;
@@ -173,6 +177,7 @@ static void dynstr_set_checked(DYNAMIC_STRING *str, const char *init_str);
 static void dynstr_append_mem_checked(DYNAMIC_STRING *str, const char *append,
 			  uint length);
 static void dynstr_realloc_checked(DYNAMIC_STRING *str, ulong additional_size);
+static int start_transaction(MYSQL *mysql_con);
 /*
   Constant for detection of default value of default_charset.
   If default_charset is equal to mysql_universal_client_charset, then
@@ -437,6 +442,16 @@ static struct my_option my_long_options[] =
   {"order-by-primary", OPT_ORDER_BY_PRIMARY,
    "Sorts each table's rows by primary key, or first unique key, if such a key exists.  Useful when dumping a MyISAM table to be loaded into an InnoDB table, but will make the dump itself take considerably longer.",
    &opt_order_by_primary, &opt_order_by_primary, 0, GET_BOOL, NO_ARG, 0, 0, 0, 0, 0, 0},
+  {"parallel", 0,
+   "Dump table data with this many extra connections, each table to a file "
+   "of its own in --parallel-dir. Data of the mysql database is dumped "
+   "normally. Requires --single-transaction. Load the dump first, then the "
+   "data files in any order, then triggers.sql.",
+   &opt_parallel, &opt_parallel, 0, GET_UINT, REQUIRED_ARG, 0, 0, 256, 0, 0,
+   0},
+  {"parallel-dir", 0, "Directory for --parallel data files.",
+   &opt_parallel_dir, &opt_parallel_dir, 0, GET_STR, REQUIRED_ARG, 0, 0, 0, 0,
+   0, 0},
   {"password", 'p',
    "Password to use when connecting to server. If password is not given it's solicited on the tty.",
    0, 0, 0, GET_PASSWORD, OPT_ARG, 0, 0, 0, 0, 0, 0},
@@ -571,6 +586,7 @@ static int init_dumping_tables(char *);
 static int init_dumping(char *, int init_func(char*));
 static int dump_databases(char **);
 static int dump_all_databases();
+static FILE *parallel_trigger_file_for(const char *db, FILE *main_file);
 static char *quote_name(const char *name, char *buff, my_bool force);
 char check_if_ignore_table(const char *table_name, char *table_type);
 static char *primary_key_fields(const char *table_name);
@@ -1021,6 +1037,15 @@ static int get_options(int *argc, char ***argv)
     fprintf(stderr, "%s: You can't use ..enclosed.. and ..optionally-enclosed.. at the same time.\n", my_progname);
     return(EX_USAGE);
   }
+  if (opt_parallel && (!opt_single_transaction || !opt_parallel_dir ||
+                       path || opt_xml))
+  {
+    fprintf(stderr,
+            "%s: --parallel requires --single-transaction and "
+            "--parallel-dir, and can't be used with --tab or --xml.\n",
+            my_progname);
+    return(EX_USAGE);
+  }
   if ((opt_databases || opt_alldbs) && path)
   {
     fprintf(stderr,
@@ -1506,80 +1531,73 @@ static void maybe_exit(int error)
 
 
 /*
-  db_connect -- connects to the host and selects DB.
+  connect_to_server -- connects con to the host and sets the session up
+  for dumping. Used for the main connection and --parallel connections.
 */
 
-static int connect_to_db(char *host, char *user,char *passwd)
+static MYSQL* connect_to_server(MYSQL *con, char *host, char *user,
+                                char *passwd)
 {
+  MYSQL *ret;
   char buff[20+FN_REFLEN];
-  DBUG_ENTER("connect_to_db");
+  DBUG_ENTER("connect_to_server");
 
-  verbose_msg("-- Connecting to %s...\n", host ? host : "localhost");
-  mysql_init(&mysql_connection);
+  mysql_init(con);
   if (opt_compress)
-    mysql_options(&mysql_connection,MYSQL_OPT_COMPRESS,NullS);
+    mysql_options(con,MYSQL_OPT_COMPRESS,NullS);
 #ifdef HAVE_OPENSSL
   if (opt_use_ssl)
   {
-    mysql_ssl_set(&mysql_connection, opt_ssl_key, opt_ssl_cert, opt_ssl_ca,
+    mysql_ssl_set(con, opt_ssl_key, opt_ssl_cert, opt_ssl_ca,
                   opt_ssl_capath, opt_ssl_cipher);
-    mysql_options(&mysql_connection, MYSQL_OPT_SSL_CRL, opt_ssl_crl);
-    mysql_options(&mysql_connection, MYSQL_OPT_SSL_CRLPATH, opt_ssl_crlpath);
+    mysql_options(con, MYSQL_OPT_SSL_CRL, opt_ssl_crl);
+    mysql_options(con, MYSQL_OPT_SSL_CRLPATH, opt_ssl_crlpath);
   }
-  mysql_options(&mysql_connection,MYSQL_OPT_SSL_VERIFY_SERVER_CERT,
+  mysql_options(con,MYSQL_OPT_SSL_VERIFY_SERVER_CERT,
                 (char*)&opt_ssl_verify_server_cert);
 #endif
   if (opt_protocol)
-    mysql_options(&mysql_connection,MYSQL_OPT_PROTOCOL,(char*)&opt_protocol);
+    mysql_options(con,MYSQL_OPT_PROTOCOL,(char*)&opt_protocol);
   if (opt_bind_addr)
-    mysql_options(&mysql_connection,MYSQL_OPT_BIND,opt_bind_addr);
+    mysql_options(con,MYSQL_OPT_BIND,opt_bind_addr);
   if (!opt_secure_auth)
-    mysql_options(&mysql_connection,MYSQL_SECURE_AUTH,(char*)&opt_secure_auth);
+    mysql_options(con,MYSQL_SECURE_AUTH,(char*)&opt_secure_auth);
 #ifdef HAVE_SMEM
   if (shared_memory_base_name)
-    mysql_options(&mysql_connection,MYSQL_SHARED_MEMORY_BASE_NAME,shared_memory_base_name);
+    mysql_options(con,MYSQL_SHARED_MEMORY_BASE_NAME,shared_memory_base_name);
 #endif
-  mysql_options(&mysql_connection, MYSQL_SET_CHARSET_NAME, default_charset);
+  mysql_options(con, MYSQL_SET_CHARSET_NAME, default_charset);
 
   if (opt_plugin_dir && *opt_plugin_dir)
-    mysql_options(&mysql_connection, MYSQL_PLUGIN_DIR, opt_plugin_dir);
+    mysql_options(con, MYSQL_PLUGIN_DIR, opt_plugin_dir);
 
   if (opt_default_auth && *opt_default_auth)
-    mysql_options(&mysql_connection, MYSQL_DEFAULT_AUTH, opt_default_auth);
+    mysql_options(con, MYSQL_DEFAULT_AUTH, opt_default_auth);
 
   if (using_opt_enable_cleartext_plugin)
-    mysql_options(&mysql_connection, MYSQL_ENABLE_CLEARTEXT_PLUGIN,
+    mysql_options(con, MYSQL_ENABLE_CLEARTEXT_PLUGIN,
                   (char *) &opt_enable_cleartext_plugin);
 
-  mysql_options(&mysql_connection, MYSQL_OPT_CONNECT_ATTR_RESET, 0);
-  mysql_options4(&mysql_connection, MYSQL_OPT_CONNECT_ATTR_ADD,
+  mysql_options(con, MYSQL_OPT_CONNECT_ATTR_RESET, 0);
+  mysql_options4(con, MYSQL_OPT_CONNECT_ATTR_ADD,
                  "program_name", "mysqldump");
-  if (!(mysql= mysql_connect_ssl_check(&mysql_connection, host, user,
-                                       passwd, NULL, opt_mysql_port,
-                                       opt_mysql_unix_port, 0,
-                                       opt_ssl_mode == SSL_MODE_REQUIRED)))
+  if (!(ret= mysql_connect_ssl_check(con, host, user,
+                                     passwd, NULL, opt_mysql_port,
+                                     opt_mysql_unix_port, 0,
+                                     opt_ssl_mode == SSL_MODE_REQUIRED)))
   {
-    DB_error(&mysql_connection, "when trying to connect");
-    DBUG_RETURN(1);
+    DB_error(con, "when trying to connect");
+    DBUG_RETURN(0);
   }
-  if ((mysql_get_server_version(&mysql_connection) < 40100) ||
-      (opt_compatible_mode & 3))
-  {
-    /* Don't dump SET NAMES with a pre-4.1 server (bug#7997).  */
-    opt_set_charset= 0;
-
-    /* Don't switch charsets for 4.1 and earlier.  (bug#34192). */
-    server_supports_switching_charsets= FALSE;
-  } 
   /*
     As we're going to set SQL_MODE, it would be lost on reconnect, so we
     cannot reconnect.
   */
-  mysql->reconnect= 0;
+  ret->reconnect= 0;
   my_snprintf(buff, sizeof(buff), "/*!40100 SET @@SQL_MODE='%s' */",
               compatible_mode_normal_str);
-  if (mysql_query_with_error_report(mysql, 0, buff))
-    DBUG_RETURN(1);
+  if (mysql_query_with_error_report(ret, 0, buff))
+    DBUG_RETURN(0);
   /*
     set time_zone to UTC to allow dumping date types between servers with
     different time zone settings
@@ -1587,9 +1605,33 @@ static int connect_to_db(char *host, char *user,char *passwd)
   if (opt_tz_utc)
   {
     my_snprintf(buff, sizeof(buff), "/*!40103 SET TIME_ZONE='+00:00' */");
-    if (mysql_query_with_error_report(mysql, 0, buff))
-      DBUG_RETURN(1);
+    if (mysql_query_with_error_report(ret, 0, buff))
+      DBUG_RETURN(0);
   }
+  DBUG_RETURN(ret);
+} /* connect_to_server */
+
+
+/*
+  db_connect -- connects to the host and selects DB.
+*/
+
+static int connect_to_db(char *host, char *user,char *passwd)
+{
+  DBUG_ENTER("connect_to_db");
+
+  verbose_msg("-- Connecting to %s...\n", host ? host : "localhost");
+  if (!(mysql= connect_to_server(&mysql_connection, host, user, passwd)))
+    DBUG_RETURN(1);
+  if ((mysql_get_server_version(&mysql_connection) < 40100) ||
+      (opt_compatible_mode & 3))
+  {
+    /* Don't dump SET NAMES with a pre-4.1 server (bug#7997).  */
+    opt_set_charset= 0;
+
+    /* Don't switch charsets for 4.1 and earlier.  (bug#34192). */
+    server_supports_switching_charsets= FALSE;
+  } 
   DBUG_RETURN(0);
 } /* connect_to_db */
 
@@ -3252,6 +3294,10 @@ static int dump_triggers_for_table(char *table_name, char *db_name)
                                                   O_WRONLY | O_APPEND)))
     DBUG_RETURN(1);
 
+  /* with --parallel triggers are created after the data is loaded */
+  if (opt_parallel)
+    sql_file= parallel_trigger_file_for(db_name, sql_file);
+
   /* Do not use ANSI_QUOTES on triggers in dump */
   opt_compatible_mode&= ~MASK_ANSI_QUOTES;
 
@@ -3414,6 +3460,666 @@ static char *alloc_query_str(ulong size)
 }
 
 
+/*
+  dump_table_rows()
+
+  Sends the SELECT query for table and writes the rows it returns to
+  sql_file, as statements made from ins_pat. The main connection uses the
+  global buffers, --parallel workers their own connection and buffers.
+*/
+
+static void dump_table_rows(MYSQL *mysql_con, FILE *sql_file,
+                            const char *query, const char *table,
+                            const char *result_table,
+                            const char *opt_quoted_table, uint num_fields,
+                            DYNAMIC_STRING *ins_pat, DYNAMIC_STRING *ext_row)
+{
+  char buf[200];
+  int error= 0;
+  ulong         rownr, row_break, total_length, init_length;
+  MYSQL_RES     *res;
+  MYSQL_FIELD   *field;
+  MYSQL_ROW     row;
+  DBUG_ENTER("dump_table_rows");
+
+  if (mysql_query_with_error_report(mysql_con, 0, query))
+  {
+    DB_error(mysql_con, "when retrieving data from server");
+    goto err;
+  }
+  if (quick)
+    res=mysql_use_result(mysql_con);
+  else
+    res=mysql_store_result(mysql_con);
+  if (!res)
+  {
+    DB_error(mysql_con, "when retrieving data from server");
+    goto err;
+  }
+
+  verbose_msg("-- Retrieving rows...\n");
+  if (mysql_num_fields(res) != num_fields)
+  {
+    fprintf(stderr,"%s: Error in field count for table: %s !  Aborting.\n",
+            my_progname, result_table);
+    error= EX_CONSCHECK;
+    goto err;
+  }
+
+  if (opt_lock)
+  {
+    fprintf(sql_file,"LOCK TABLES %s WRITE;\n", opt_quoted_table);
+    check_io(sql_file);
+  }
+  /* Moved disable keys to after lock per bug 15977 */
+  if (opt_disable_keys)
+  {
+    fprintf(sql_file, "/*!40000 ALTER TABLE %s DISABLE KEYS */;\n",
+	      opt_quoted_table);
+    check_io(sql_file);
+  }
+
+  total_length= opt_net_buffer_length;                /* Force row break */
+  row_break=0;
+  rownr=0;
+  init_length=(uint) ins_pat->length+4;
+  if (opt_xml)
+    print_xml_tag(sql_file, "\t", "\n", "table_data", "name=", table,
+            NullS);
+  if (opt_autocommit)
+  {
+    fprintf(sql_file, "set autocommit=0;\n");
+    check_io(sql_file);
+  }
+
+  while ((row= mysql_fetch_row(res)))
+  {
+    uint i;
+    ulong *lengths= mysql_fetch_lengths(res);
+    rownr++;
+    if (!extended_insert && !opt_xml)
+    {
+      fputs(ins_pat->str,sql_file);
+      check_io(sql_file);
+    }
+    mysql_field_seek(res,0);
+
+    if (opt_xml)
+    {
+      fputs("\t<row>\n", sql_file);
+      check_io(sql_file);
+    }
+
+    for (i= 0; i < mysql_num_fields(res); i++)
+    {
+      int is_blob;
+      ulong length= lengths[i];
+
+      if (!(field= mysql_fetch_field(res)))
+        die(EX_CONSCHECK,
+                    "Not enough fields from table %s! Aborting.\n",
+                    result_table);
+
+      /*
+         63 is my_charset_bin. If charsetnr is not 63,
+         we have not a BLOB but a TEXT column.
+         we'll dump in hex only BLOB columns.
+      */
+      is_blob= (opt_hex_blob && field->charsetnr == 63 &&
+                (field->type == MYSQL_TYPE_BIT ||
+                 field->type == MYSQL_TYPE_STRING ||
+                 field->type == MYSQL_TYPE_VAR_STRING ||
+                 field->type == MYSQL_TYPE_VARCHAR ||
+                 field->type == MYSQL_TYPE_BLOB ||
+                 field->type == MYSQL_TYPE_LONG_BLOB ||
+                 field->type == MYSQL_TYPE_MEDIUM_BLOB ||
+                 field->type == MYSQL_TYPE_TINY_BLOB ||
+                 field->type == MYSQL_TYPE_GEOMETRY)) ? 1 : 0;
+      if (extended_insert && !opt_xml)
+      {
+        if (i == 0)
+          dynstr_set_checked(ext_row,"(");
+        else
+          dynstr_append_checked(ext_row,",");
+
+        if (row[i])
+        {
+          if (length)
+          {
+            if (!(field->flags & NUM_FLAG))
+            {
+              /*
+                "length * 2 + 2" is OK for both HEX and non-HEX modes:
+                - In HEX mode we need exactly 2 bytes per character
+                plus 2 bytes for '0x' prefix.
+                - In non-HEX mode we need up to 2 bytes per character,
+                plus 2 bytes for leading and trailing '\'' characters.
+                Also we need to reserve 1 byte for terminating '\0'.
+              */
+              dynstr_realloc_checked(ext_row,length * 2 + 2 + 1);
+              if (opt_hex_blob && is_blob)
+              {
+                dynstr_append_checked(ext_row, "0x");
+                ext_row->length+= mysql_hex_string(ext_row->str +
+                                                   ext_row->length,
+                                                   row[i], length);
+                DBUG_ASSERT(ext_row->length+1 <= ext_row->max_length);
+                /* mysql_hex_string() already terminated string by '\0' */
+                DBUG_ASSERT(ext_row->str[ext_row->length] == '\0');
+              }
+              else
+              {
+                dynstr_append_checked(ext_row,"'");
+                ext_row->length +=
+                mysql_real_escape_string(mysql_con,
+                                         &ext_row->str[ext_row->length],
+                                         row[i],length);
+                ext_row->str[ext_row->length]='\0';
+                dynstr_append_checked(ext_row,"'");
+              }
+            }
+            else
+            {
+              /* change any strings ("inf", "-inf", "nan") into NULL */
+              char *ptr= row[i];
+              if (my_isalpha(charset_info, *ptr) || (*ptr == '-' &&
+                  my_isalpha(charset_info, ptr[1])))
+                dynstr_append_checked(ext_row, "NULL");
+              else
+              {
+                if (field->type == MYSQL_TYPE_DECIMAL)
+                {
+                  /* add " signs around */
+                  dynstr_append_checked(ext_row, "'");
+                  dynstr_append_checked(ext_row, ptr);
+                  dynstr_append_checked(ext_row, "'");
+                }
+                else
+                  dynstr_append_checked(ext_row, ptr);
+              }
+            }
+          }
+          else
+            dynstr_append_checked(ext_row,"''");
+        }
+        else
+          dynstr_append_checked(ext_row,"NULL");
+      }
+      else
+      {
+        if (i && !opt_xml)
+        {
+          fputc(',', sql_file);
+          check_io(sql_file);
+        }
+        if (row[i])
+        {
+          if (!(field->flags & NUM_FLAG))
+          {
+            if (opt_xml)
+            {
+              if (opt_hex_blob && is_blob && length)
+              {
+                /* Define xsi:type="xs:hexBinary" for hex encoded data */
+                print_xml_tag(sql_file, "\t\t", "", "field", "name=",
+                              field->name, "xsi:type=", "xs:hexBinary", NullS);
+                print_blob_as_hex(sql_file, row[i], length);
+              }
+              else
+              {
+                print_xml_tag(sql_file, "\t\t", "", "field", "name=", 
+                              field->name, NullS);
+                print_quoted_xml(sql_file, row[i], length, 0);
+              }
+              fputs("</field>\n", sql_file);
+            }
+            else if (opt_hex_blob && is_blob && length)
+            {
+              fputs("0x", sql_file);
+              print_blob_as_hex(sql_file, row[i], length);
+            }
+            else
+              unescape(sql_file, row[i], length);
+          }
+          else
+          {
+            /* change any strings ("inf", "-inf", "nan") into NULL */
+            char *ptr= row[i];
+            if (opt_xml)
+            {
+              print_xml_tag(sql_file, "\t\t", "", "field", "name=",
+                      field->name, NullS);
+              fputs(!my_isalpha(charset_info, *ptr) ? ptr: "NULL",
+                    sql_file);
+              fputs("</field>\n", sql_file);
+            }
+            else if (my_isalpha(charset_info, *ptr) ||
+                     (*ptr == '-' && my_isalpha(charset_info, ptr[1])))
+              fputs("NULL", sql_file);
+            else if (field->type == MYSQL_TYPE_DECIMAL)
+            {
+              /* add " signs around */
+              fputc('\'', sql_file);
+              fputs(ptr, sql_file);
+              fputc('\'', sql_file);
+            }
+            else
+              fputs(ptr, sql_file);
+          }
+        }
+        else
+        {
+          /* The field value is NULL */
+          if (!opt_xml)
+            fputs("NULL", sql_file);
+          else
+            print_xml_null_tag(sql_file, "\t\t", "field name=",
+                               field->name, "\n");
+        }
+        check_io(sql_file);
+      }
+    }
+
+    if (opt_xml)
+    {
+      fputs("\t</row>\n", sql_file);
+      check_io(sql_file);
+    }
+
+    if (extended_insert)
+    {
+      ulong row_length;
+      dynstr_append_checked(ext_row,")");
+      row_length= 2 + ext_row->length;
+      if (total_length + row_length < opt_net_buffer_length)
+      {
+        total_length+= row_length;
+        fputc(',',sql_file);            /* Always row break */
+        fputs(ext_row->str,sql_file);
+      }
+      else
+      {
+        if (row_break)
+          fputs(";\n", sql_file);
+        row_break=1;                          /* This is first row */
+
+        fputs(ins_pat->str,sql_file);
+        fputs(ext_row->str,sql_file);
+        total_length= row_length+init_length;
+      }
+      check_io(sql_file);
+    }
+    else if (!opt_xml)
+    {
+      fputs(");\n", sql_file);
+      check_io(sql_file);
+    }
+  }
+
+  /* XML - close table tag and supress regular output */
+  if (opt_xml)
+      fputs("\t</table_data>\n", sql_file);
+  else if (extended_insert && row_break)
+    fputs(";\n", sql_file);             /* If not empty table */
+  fflush(sql_file);
+  check_io(sql_file);
+  if (mysql_errno(mysql_con))
+  {
+    my_snprintf(buf, sizeof(buf),
+                "%s: Error %d: %s when dumping table %s at row: %ld\n",
+                my_progname,
+                mysql_errno(mysql_con),
+                mysql_error(mysql_con),
+                result_table,
+                rownr);
+    fputs(buf,stderr);
+    error= EX_CONSCHECK;
+    goto err;
+  }
+
+  /* Moved enable keys to before unlock per bug 15977 */
+  if (opt_disable_keys)
+  {
+    fprintf(sql_file,"/*!40000 ALTER TABLE %s ENABLE KEYS */;\n",
+            opt_quoted_table);
+    check_io(sql_file);
+  }
+  if (opt_lock)
+  {
+    fputs("UNLOCK TABLES;\n", sql_file);
+    check_io(sql_file);
+  }
+  if (opt_autocommit)
+  {
+    fprintf(sql_file, "commit;\n");
+    check_io(sql_file);
+  }
+  mysql_free_result(res);
+  DBUG_VOID_RETURN;
+
+err:
+  maybe_exit(error);
+  DBUG_VOID_RETURN;
+} /* dump_table_rows */
+
+
+/*
+  --parallel dump
+
+  The main connection takes FLUSH TABLES WITH READ LOCK. Then it starts
+  its own and opt_parallel worker transactions WITH CONSISTENT SNAPSHOT,
+  so that they all see the same data, and unlocks. The main thread dumps
+  everything but table data as usual and queues a job for the data of
+  every table. A free worker writes that data to a file of its own in
+  opt_parallel_dir. Data of the mysql database stays in the main dump,
+  so that privileges are in place when it is loaded. Triggers of the
+  tables dumped by workers go to triggers.sql in opt_parallel_dir, they
+  must not fire while the data is loaded.
+
+  The main dump must be loaded first. The data files can then be loaded
+  in any order and concurrently, triggers.sql after all of them.
+*/
+
+typedef struct st_parallel_job
+{
+  struct st_parallel_job *next;
+  char *db;
+  char *table;
+  char *result_table;
+  char *opt_quoted_table;
+  char *query;
+  char *ins_pat;
+  uint num_fields;
+  char file[FN_REFLEN];
+} PARALLEL_JOB;
+
+static MYSQL         *parallel_con= 0;
+static pthread_t     *parallel_threads= 0;
+static uint          parallel_threads_running= 0;
+static uint          parallel_files= 0;
+static PARALLEL_JOB  *parallel_head= 0, **parallel_tail= &parallel_head;
+static my_bool       parallel_done= 0;
+static pthread_mutex_t parallel_lock;
+static pthread_cond_t  parallel_cond;
+static FILE          *parallel_trigger_file= 0;
+static char          parallel_trigger_db[NAME_LEN+1];
+
+
+/* Returns next job, or NULL when all are done. */
+
+static PARALLEL_JOB *parallel_get_job()
+{
+  PARALLEL_JOB *job;
+  pthread_mutex_lock(&parallel_lock);
+  while (!parallel_head && !parallel_done)
+    pthread_cond_wait(&parallel_cond, &parallel_lock);
+  if ((job= parallel_head))
+  {
+    if (!(parallel_head= job->next))
+      parallel_tail= &parallel_head;
+  }
+  pthread_mutex_unlock(&parallel_lock);
+  return job;
+}
+
+
+static void parallel_free_job(PARALLEL_JOB *job)
+{
+  my_free(job->db);
+  my_free(job->table);
+  my_free(job->result_table);
+  my_free(job->opt_quoted_table);
+  my_free(job->query);
+  my_free(job->ins_pat);
+  my_free(job);
+}
+
+
+/*
+  Queues dumping of table data for workers. Returns the name of the file
+  the data goes to.
+*/
+
+static const char *parallel_add_job(const char *db, const char *table,
+                                    const char *result_table,
+                                    const char *opt_quoted_table,
+                                    uint num_fields, const char *query)
+{
+  char name[32];
+  PARALLEL_JOB *job;
+
+  if (!(job= (PARALLEL_JOB*) my_malloc(sizeof(PARALLEL_JOB),
+                                       MYF(MY_WME | MY_ZEROFILL))) ||
+      !(job->db= my_strdup(db, MYF(MY_WME))) ||
+      !(job->table= my_strdup(table, MYF(MY_WME))) ||
+      !(job->result_table= my_strdup(result_table, MYF(MY_WME))) ||
+      !(job->opt_quoted_table= my_strdup(opt_quoted_table, MYF(MY_WME))) ||
+      !(job->query= my_strdup(query, MYF(MY_WME))) ||
+      !(job->ins_pat= my_strdup(insert_pat.str, MYF(MY_WME))))
+    die(EX_EOM, "Couldn't allocate memory");
+  job->num_fields= num_fields;
+
+  my_snprintf(name, sizeof(name), "data-%06u", ++parallel_files);
+  fn_format(job->file, name, opt_parallel_dir, ".sql",
+            MY_UNPACK_FILENAME | MY_REPLACE_EXT);
+
+  pthread_mutex_lock(&parallel_lock);
+  *parallel_tail= job;
+  parallel_tail= &job->next;
+  pthread_cond_signal(&parallel_cond);
+  pthread_mutex_unlock(&parallel_lock);
+
+  return job->file + dirname_length(job->file);
+}
+
+
+/*
+  Session settings for loading a data file on its own, like write_header()
+  and write_footer() do for the main dump. db may be NULL if the file
+  selects databases itself.
+*/
+
+static void write_parallel_header(FILE *sql_file, const char *db)
+{
+  char db_buff[NAME_LEN*2+3];
+
+  if (opt_set_charset)
+    fprintf(sql_file,
+"/*!40101 SET @OLD_CHARACTER_SET_CLIENT=@@CHARACTER_SET_CLIENT */;\n"
+"/*!40101 SET @OLD_CHARACTER_SET_RESULTS=@@CHARACTER_SET_RESULTS */;\n"
+"/*!40101 SET @OLD_COLLATION_CONNECTION=@@COLLATION_CONNECTION */;\n"
+"/*!40101 SET NAMES %s */;\n",default_charset);
+  if (opt_tz_utc)
+    fprintf(sql_file, "/*!40103 SET @OLD_TIME_ZONE=@@TIME_ZONE */;\n"
+                      "/*!40103 SET TIME_ZONE='+00:00' */;\n");
+  fprintf(sql_file,"\
+/*!40014 SET @OLD_UNIQUE_CHECKS=@@UNIQUE_CHECKS, UNIQUE_CHECKS=0 */;\n\
+/*!40014 SET @OLD_FOREIGN_KEY_CHECKS=@@FOREIGN_KEY_CHECKS, FOREIGN_KEY_CHECKS=0 */;\n\
+/*!40101 SET @OLD_SQL_MODE=@@SQL_MODE, SQL_MODE='NO_AUTO_VALUE_ON_ZERO%s%s' */;\n\
+/*!40111 SET @OLD_SQL_NOTES=@@SQL_NOTES, SQL_NOTES=0 */;\n",
+          compatible_mode_normal_str[0]==0?"":",",
+          compatible_mode_normal_str);
+  if (is_binlog_disabled)
+    fprintf(sql_file, "SET @@SESSION.SQL_LOG_BIN= 0;\n");
+  if (db)
+    fprintf(sql_file, "USE %s;\n\n", quote_name(db, db_buff, 1));
+  check_io(sql_file);
+}
+
+
+static void write_parallel_footer(FILE *sql_file)
+{
+  if (opt_tz_utc)
+    fprintf(sql_file,"/*!40103 SET TIME_ZONE=@OLD_TIME_ZONE */;\n");
+  fprintf(sql_file,"\
+/*!40101 SET SQL_MODE=@OLD_SQL_MODE */;\n\
+/*!40014 SET FOREIGN_KEY_CHECKS=@OLD_FOREIGN_KEY_CHECKS */;\n\
+/*!40014 SET UNIQUE_CHECKS=@OLD_UNIQUE_CHECKS */;\n");
+  if (opt_set_charset)
+    fprintf(sql_file,
+"/*!40101 SET CHARACTER_SET_CLIENT=@OLD_CHARACTER_SET_CLIENT */;\n"
+"/*!40101 SET CHARACTER_SET_RESULTS=@OLD_CHARACTER_SET_RESULTS */;\n"
+"/*!40101 SET COLLATION_CONNECTION=@OLD_COLLATION_CONNECTION */;\n");
+  fprintf(sql_file, "/*!40111 SET SQL_NOTES=@OLD_SQL_NOTES */;\n");
+  check_io(sql_file);
+}
+
+
+pthread_handler_t parallel_worker(void *arg)
+{
+  MYSQL *mysql_con= (MYSQL*) arg;
+  DYNAMIC_STRING ins_pat, ext_row;
+  PARALLEL_JOB *job;
+
+  if (mysql_thread_init())
+    die(EX_MYSQLERR, "Couldn't initialize worker thread");
+
+  init_dynamic_string_checked(&ins_pat, "", 1024, 1024);
+  init_dynamic_string_checked(&ext_row, "", 1024, 1024);
+
+  while ((job= parallel_get_job()))
+  {
+    FILE *sql_file;
+
+    verbose_msg("-- Dumping data of %s.%s to %s\n",
+                job->db, job->table, job->file);
+    if (mysql_select_db(mysql_con, job->db))
+      DB_error(mysql_con, "when selecting the database");
+    else if (!(sql_file= my_fopen(job->file, O_WRONLY, MYF(MY_WME))))
+      maybe_exit(EX_MYSQLERR);
+    else
+    {
+      dynstr_set_checked(&ins_pat, job->ins_pat);
+      write_parallel_header(sql_file, job->db);
+      dump_table_rows(mysql_con, sql_file, job->query, job->table,
+                      job->result_table, job->opt_quoted_table,
+                      job->num_fields, &ins_pat, &ext_row);
+      write_parallel_footer(sql_file);
+      my_fclose(sql_file, MYF(MY_WME));
+    }
+
+    /* release metadata lock, like dump_all_tables_in_db() */
+    if (mysql_get_server_version(mysql_con) >= 50500 &&
+        mysql_query_with_error_report(mysql_con, 0, "ROLLBACK TO SAVEPOINT sp"))
+      maybe_exit(EX_MYSQLERR);
+
+    parallel_free_job(job);
+  }
+
+  dynstr_free(&ins_pat);
+  dynstr_free(&ext_row);
+  mysql_thread_end();
+  return 0;
+}
+
+
+/*
+  Returns the file for the triggers of a table in db: triggers.sql if
+  the data of the table is dumped by a worker, main_file otherwise.
+*/
+
+static FILE *parallel_trigger_file_for(const char *db, FILE *main_file)
+{
+  char db_buff[NAME_LEN*2+3];
+
+  if (!parallel_trigger_file || !my_strcasecmp(charset_info, db, "mysql"))
+    return main_file;
+
+  if (strcmp(parallel_trigger_db, db))
+  {
+    fprintf(parallel_trigger_file, "\nUSE %s;\n\n",
+            quote_name(db, db_buff, 1));
+    check_io(parallel_trigger_file);
+    strmake(parallel_trigger_db, db, NAME_LEN);
+  }
+  return parallel_trigger_file;
+}
+
+
+/*
+  Connects workers and starts their transactions. Must be called with
+  FLUSH TABLES WITH READ LOCK held by the main connection.
+*/
+
+static int start_parallel_dump()
+{
+  uint i;
+  char file[FN_REFLEN];
+  DBUG_ENTER("start_parallel_dump");
+
+  fn_format(file, "triggers", opt_parallel_dir, ".sql",
+            MY_UNPACK_FILENAME | MY_REPLACE_EXT);
+  if (!(parallel_trigger_file= my_fopen(file, O_WRONLY, MYF(MY_WME))))
+    DBUG_RETURN(1);
+  write_parallel_header(parallel_trigger_file, NULL);
+
+  if (!(parallel_con= (MYSQL*) my_malloc(opt_parallel * sizeof(MYSQL),
+                                         MYF(MY_WME | MY_ZEROFILL))) ||
+      !(parallel_threads= (pthread_t*) my_malloc(opt_parallel *
+                                                 sizeof(pthread_t),
+                                                 MYF(MY_WME))))
+    DBUG_RETURN(1);
+
+  pthread_mutex_init(&parallel_lock, NULL);
+  pthread_cond_init(&parallel_cond, NULL);
+
+  for (i= 0; i < opt_parallel; i++)
+  {
+    verbose_msg("-- Connecting worker %u...\n", i);
+    if (!connect_to_server(&parallel_con[i], current_host, current_user,
+                           opt_password) ||
+        start_transaction(&parallel_con[i]) ||
+        (mysql_get_server_version(&parallel_con[i]) >= 50500 &&
+         mysql_query_with_error_report(&parallel_con[i], 0, "SAVEPOINT sp")))
+      DBUG_RETURN(1);
+  }
+
+  for (i= 0; i < opt_parallel; i++)
+  {
+    if (pthread_create(&parallel_threads[i], NULL, parallel_worker,
+                       &parallel_con[i]))
+    {
+      fprintf(stderr, "%s: Could not create thread\n", my_progname);
+      DBUG_RETURN(1);
+    }
+    parallel_threads_running++;
+  }
+  DBUG_RETURN(0);
+}
+
+
+/* Waits for workers to dump the queued tables and disconnects them. */
+
+static void end_parallel_dump()
+{
+  uint i;
+
+  if (!parallel_con)
+    return;
+
+  pthread_mutex_lock(&parallel_lock);
+  parallel_done= 1;
+  pthread_cond_broadcast(&parallel_cond);
+  pthread_mutex_unlock(&parallel_lock);
+
+  for (i= 0; i < parallel_threads_running; i++)
+    pthread_join(parallel_threads[i], NULL);
+  parallel_threads_running= 0;
+
+  for (i= 0; i < opt_parallel; i++)
+    mysql_close(&parallel_con[i]);
+  my_free(parallel_con);
+  my_free(parallel_threads);
+  parallel_con= 0;
+
+  write_parallel_footer(parallel_trigger_file);
+  my_fclose(parallel_trigger_file, MYF(MY_WME));
+  parallel_trigger_file= 0;
+  pthread_mutex_destroy(&parallel_lock);
+  pthread_cond_destroy(&parallel_cond);
+}
+
+
 /*
 
  SYNOPSIS
@@ -3433,16 +4139,11 @@ static char *alloc_query_str(ulong size)
 static void dump_table(char *table, char *db)
 {
   char ignore_flag;
-  char buf[200], table_buff[NAME_LEN+3];
+  char table_buff[NAME_LEN+3];
   DYNAMIC_STRING query_string;
   char table_type[NAME_LEN];
   char *result_table, table_buff2[NAME_LEN*2+3], *opt_quoted_table;
-  int error= 0;
-  ulong         rownr, row_break, total_length, init_length;
   uint num_fields;
-  MYSQL_RES     *res;
-  MYSQL_FIELD   *field;
-  MYSQL_ROW     row;
   DBUG_ENTER("dump_table");
 
   /*
@@ -3580,332 +4281,27 @@ static void dump_table(char *table, char *db)
       dynstr_append_checked(&query_string, order_by);
     }
 
-    if (!opt_xml && !opt_compact)
+    if (opt_parallel && my_strcasecmp(charset_info, db, "mysql"))
     {
-      fputs("\n", md_result_file);
-      check_io(md_result_file);
+      const char *file= parallel_add_job(db, table, result_table,
+                                         opt_quoted_table, num_fields,
+                                         query_string.str);
+      print_comment(md_result_file, 0, "-- Data is in %s\n", file);
     }
-    if (mysql_query_with_error_report(mysql, 0, query_string.str))
-    {
-      DB_error(mysql, "when retrieving data from server");
-      goto err;
-    }
-    if (quick)
-      res=mysql_use_result(mysql);
     else
-      res=mysql_store_result(mysql);
-    if (!res)
     {
-      DB_error(mysql, "when retrieving data from server");
-      goto err;
-    }
-
-    verbose_msg("-- Retrieving rows...\n");
-    if (mysql_num_fields(res) != num_fields)
-    {
-      fprintf(stderr,"%s: Error in field count for table: %s !  Aborting.\n",
-              my_progname, result_table);
-      error= EX_CONSCHECK;
-      goto err;
-    }
-
-    if (opt_lock)
-    {
-      fprintf(md_result_file,"LOCK TABLES %s WRITE;\n", opt_quoted_table);
-      check_io(md_result_file);
-    }
-    /* Moved disable keys to after lock per bug 15977 */
-    if (opt_disable_keys)
-    {
-      fprintf(md_result_file, "/*!40000 ALTER TABLE %s DISABLE KEYS */;\n",
-	      opt_quoted_table);
-      check_io(md_result_file);
-    }
-
-    total_length= opt_net_buffer_length;                /* Force row break */
-    row_break=0;
-    rownr=0;
-    init_length=(uint) insert_pat.length+4;
-    if (opt_xml)
-      print_xml_tag(md_result_file, "\t", "\n", "table_data", "name=", table,
-              NullS);
-    if (opt_autocommit)
-    {
-      fprintf(md_result_file, "set autocommit=0;\n");
-      check_io(md_result_file);
-    }
-
-    while ((row= mysql_fetch_row(res)))
-    {
-      uint i;
-      ulong *lengths= mysql_fetch_lengths(res);
-      rownr++;
-      if (!extended_insert && !opt_xml)
+      if (!opt_xml && !opt_compact)
       {
-        fputs(insert_pat.str,md_result_file);
+        fputs("\n", md_result_file);
         check_io(md_result_file);
       }
-      mysql_field_seek(res,0);
-
-      if (opt_xml)
-      {
-        fputs("\t<row>\n", md_result_file);
-        check_io(md_result_file);
-      }
-
-      for (i= 0; i < mysql_num_fields(res); i++)
-      {
-        int is_blob;
-        ulong length= lengths[i];
-
-        if (!(field= mysql_fetch_field(res)))
-          die(EX_CONSCHECK,
-                      "Not enough fields from table %s! Aborting.\n",
-                      result_table);
-
-        /*
-           63 is my_charset_bin. If charsetnr is not 63,
-           we have not a BLOB but a TEXT column.
-           we'll dump in hex only BLOB columns.
-        */
-        is_blob= (opt_hex_blob && field->charsetnr == 63 &&
-                  (field->type == MYSQL_TYPE_BIT ||
-                   field->type == MYSQL_TYPE_STRING ||
-                   field->type == MYSQL_TYPE_VAR_STRING ||
-                   field->type == MYSQL_TYPE_VARCHAR ||
-                   field->type == MYSQL_TYPE_BLOB ||
-                   field->type == MYSQL_TYPE_LONG_BLOB ||
-                   field->type == MYSQL_TYPE_MEDIUM_BLOB ||
-                   field->type == MYSQL_TYPE_TINY_BLOB ||
-                   field->type == MYSQL_TYPE_GEOMETRY)) ? 1 : 0;
-        if (extended_insert && !opt_xml)
-        {
-          if (i == 0)
-            dynstr_set_checked(&extended_row,"(");
-          else
-            dynstr_append_checked(&extended_row,",");
-
-          if (row[i])
-          {
-            if (length)
-            {
-              if (!(field->flags & NUM_FLAG))
-              {
-                /*
-                  "length * 2 + 2" is OK for both HEX and non-HEX modes:
-                  - In HEX mode we need exactly 2 bytes per character
-                  plus 2 bytes for '0x' prefix.
-                  - In non-HEX mode we need up to 2 bytes per character,
-                  plus 2 bytes for leading and trailing '\'' characters.
-                  Also we need to reserve 1 byte for terminating '\0'.
-                */
-                dynstr_realloc_checked(&extended_row,length * 2 + 2 + 1);
-                if (opt_hex_blob && is_blob)
-                {
-                  dynstr_append_checked(&extended_row, "0x");
-                  extended_row.length+= mysql_hex_string(extended_row.str +
-                                                         extended_row.length,
-                                                         row[i], length);
-                  DBUG_ASSERT(extended_row.length+1 <= extended_row.max_length);
-                  /* mysql_hex_string() already terminated string by '\0' */
-                  DBUG_ASSERT(extended_row.str[extended_row.length] == '\0');
-                }
-                else
-                {
-                  dynstr_append_checked(&extended_row,"'");
-                  extended_row.length +=
-                  mysql_real_escape_string(&mysql_connection,
-                                           &extended_row.str[extended_row.length],
-                                           row[i],length);
-                  extended_row.str[extended_row.length]='\0';
-                  dynstr_append_checked(&extended_row,"'");
-                }
-              }
-              else
-              {
-                /* change any strings ("inf", "-inf", "nan") into NULL */
-                char *ptr= row[i];
-                if (my_isalpha(charset_info, *ptr) || (*ptr == '-' &&
-                    my_isalpha(charset_info, ptr[1])))
-                  dynstr_append_checked(&extended_row, "NULL");
-                else
-                {
-                  if (field->type == MYSQL_TYPE_DECIMAL)
-                  {
-                    /* add " signs around */
-                    dynstr_append_checked(&extended_row, "'");
-                    dynstr_append_checked(&extended_row, ptr);
-                    dynstr_append_checked(&extended_row, "'");
-                  }
-                  else
-                    dynstr_append_checked(&extended_row, ptr);
-                }
-              }
-            }
-            else
-              dynstr_append_checked(&extended_row,"''");
-          }
-          else
-            dynstr_append_checked(&extended_row,"NULL");
-        }
-        else
-        {
-          if (i && !opt_xml)
-          {
-            fputc(',', md_result_file);
-            check_io(md_result_file);
-          }
-          if (row[i])
-          {
-            if (!(field->flags & NUM_FLAG))
-            {
-              if (opt_xml)
-              {
-                if (opt_hex_blob && is_blob && length)
-                {
-                  /* Define xsi:type="xs:hexBinary" for hex encoded data */
-                  print_xml_tag(md_result_file, "\t\t", "", "field", "name=",
-                                field->name, "xsi:type=", "xs:hexBinary", NullS);
-                  print_blob_as_hex(md_result_file, row[i], length);
-                }
-                else
-                {
-                  print_xml_tag(md_result_file, "\t\t", "", "field", "name=", 
-                                field->name, NullS);
-                  print_quoted_xml(md_result_file, row[i], length, 0);
-                }
-                fputs("</field>\n", md_result_file);
-              }
-              else if (opt_hex_blob && is_blob && length)
-              {
-                fputs("0x", md_result_file);
-                print_blob_as_hex(md_result_file, row[i], length);
-              }
-              else
-                unescape(md_result_file, row[i], length);
-            }
-            else
-            {
-              /* change any strings ("inf", "-inf", "nan") into NULL */
-              char *ptr= row[i];
-              if (opt_xml)
-              {
-                print_xml_tag(md_result_file, "\t\t", "", "field", "name=",
-                        field->name, NullS);
-                fputs(!my_isalpha(charset_info, *ptr) ? ptr: "NULL",
-                      md_result_file);
-                fputs("</field>\n", md_result_file);
-              }
-              else if (my_isalpha(charset_info, *ptr) ||
-                       (*ptr == '-' && my_isalpha(charset_info, ptr[1])))
-                fputs("NULL", md_result_file);
-              else if (field->type == MYSQL_TYPE_DECIMAL)
-              {
-                /* add " signs around */
-                fputc('\'', md_result_file);
-                fputs(ptr, md_result_file);
-                fputc('\'', md_result_file);
-              }
-              else
-                fputs(ptr, md_result_file);
-            }
-          }
-          else
-          {
-            /* The field value is NULL */
-            if (!opt_xml)
-              fputs("NULL", md_result_file);
-            else
-              print_xml_null_tag(md_result_file, "\t\t", "field name=",
-                                 field->name, "\n");
-          }
-          check_io(md_result_file);
-        }
-      }
-
-      if (opt_xml)
-      {
-        fputs("\t</row>\n", md_result_file);
-        check_io(md_result_file);
-      }
-
-      if (extended_insert)
-      {
-        ulong row_length;
-        dynstr_append_checked(&extended_row,")");
-        row_length= 2 + extended_row.length;
-        if (total_length + row_length < opt_net_buffer_length)
-        {
-          total_length+= row_length;
-          fputc(',',md_result_file);            /* Always row break */
-          fputs(extended_row.str,md_result_file);
-        }
-        else
-        {
-          if (row_break)
-            fputs(";\n", md_result_file);
-          row_break=1;                          /* This is first row */
-
-          fputs(insert_pat.str,md_result_file);
-          fputs(extended_row.str,md_result_file);
-          total_length= row_length+init_length;
-        }
-        check_io(md_result_file);
-      }
-      else if (!opt_xml)
-      {
-        fputs(");\n", md_result_file);
-        check_io(md_result_file);
-      }
-    }
-
-    /* XML - close table tag and supress regular output */
-    if (opt_xml)
-        fputs("\t</table_data>\n", md_result_file);
-    else if (extended_insert && row_break)
-      fputs(";\n", md_result_file);             /* If not empty table */
-    fflush(md_result_file);
-    check_io(md_result_file);
-    if (mysql_errno(mysql))
-    {
-      my_snprintf(buf, sizeof(buf),
-                  "%s: Error %d: %s when dumping table %s at row: %ld\n",
-                  my_progname,
-                  mysql_errno(mysql),
-                  mysql_error(mysql),
-                  result_table,
-                  rownr);
-      fputs(buf,stderr);
-      error= EX_CONSCHECK;
-      goto err;
-    }
-
-    /* Moved enable keys to before unlock per bug 15977 */
-    if (opt_disable_keys)
-    {
-      fprintf(md_result_file,"/*!40000 ALTER TABLE %s ENABLE KEYS */;\n",
-              opt_quoted_table);
-      check_io(md_result_file);
-    }
-    if (opt_lock)
-    {
-      fputs("UNLOCK TABLES;\n", md_result_file);
-      check_io(md_result_file);
+      dump_table_rows(mysql, md_result_file, query_string.str, table,
+                      result_table, opt_quoted_table, num_fields,
+                      &insert_pat, &extended_row);
     }
-    if (opt_autocommit)
-    {
-      fprintf(md_result_file, "commit;\n");
-      check_io(md_result_file);
-    }
-    mysql_free_result(res);
   }
   dynstr_free(&query_string);
   DBUG_VOID_RETURN;
-
-err:
-  dynstr_free(&query_string);
-  maybe_exit(error);
-  DBUG_VOID_RETURN;
 } /* dump_table */
 
 
@@ -5417,7 +5813,6 @@ static int replace(DYNAMIC_STRING *ds_str,
 
 static void set_session_binlog(my_bool flag)
 {
-  static my_bool is_binlog_disabled= FALSE;
 
   if (!flag && !is_binlog_disabled)
   {
@@ -5848,7 +6243,7 @@ int main(int argc, char **argv)
     goto err;
 
   if ((opt_lock_all_tables || opt_master_data ||
-       (opt_single_transaction && flush_logs)) &&
+       (opt_single_transaction && (flush_logs || opt_parallel))) &&
       do_flush_tables_read_lock(mysql))
     goto err;
 
@@ -5883,6 +6278,10 @@ int main(int argc, char **argv)
   if (opt_single_transaction && start_transaction(mysql))
     goto err;
 
+  /* workers must start their transactions before tables are unlocked */
+  if (opt_parallel && start_parallel_dump())
+    goto err;
+
   /* Add 'STOP SLAVE to beginning of dump */
   if (opt_slave_apply && add_stop_slave())
     goto err;
@@ -5941,6 +6340,8 @@ int main(int argc, char **argv)
     }
   }
 
+  end_parallel_dump();
+
   /* if --dump-slave , start the slave sql thread */
   if (opt_slave_data && do_start_slave_sql(mysql))
     goto err;
@@ -22,6 +22,10 @@ C_MODE_START
 
 uint32 murmur3_32(const uchar * key, size_t len, uint32 seed);
 
+#define MURMUR3_128_LEN 16
+
+void murmur3_128(const uchar * key, size_t len, uint32 seed, uchar * out);
+
 C_MODE_END
 
 #endif /* MY_MURMUR3_INCLUDED */
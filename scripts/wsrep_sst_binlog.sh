@@ -0,0 +1,65 @@
+#!/bin/bash -ue
+# Copyright (C) 2015 Codership Oy
+#
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; version 2 of the License.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program; see the file COPYING. If not, write to the
+# Free Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston
+# MA  02110-1301  USA.
+
+# This is a reference script for binlog-based state transfer: donor replays
+# the transactions that joiner is missing from its own binary log into the
+# running joiner. Server chooses the GTIDs and binary log files, and falls
+# back to wsrep_sst_mysqldump if binary log does not have them.
+
+. $(dirname $0)/wsrep_sst_common
+
+EINVAL=22
+
+if test -z "$WSREP_SST_OPT_HOST";  then wsrep_log_error "HOST cannot be nil";  exit $EINVAL; fi
+if test -z "$WSREP_SST_OPT_PORT";  then wsrep_log_error "PORT cannot be nil";  exit $EINVAL; fi
+if test -z "$WSREP_SST_OPT_LPORT"; then wsrep_log_error "LPORT cannot be nil"; exit $EINVAL; fi
+if test -z "$WSREP_SST_OPT_GTID";  then wsrep_log_error "GTID cannot be nil";  exit $EINVAL; fi
+if test -z "${WSREP_SST_OPT_GTID_SET:-}"; then wsrep_log_error "GTID_SET cannot be nil"; exit $EINVAL; fi
+if test -z "${WSREP_SST_OPT_BINLOG_FILES:-}"; then wsrep_log_error "BINLOG_FILES cannot be nil"; exit $EINVAL; fi
+if test -z "${WSREP_SST_OPT_BINLOG_STOP:-}"; then wsrep_log_error "BINLOG_STOP cannot be nil"; exit $EINVAL; fi
+
+if [ -x "$CLIENT_DIR/mysqlbinlog" ]; then
+    MYSQLBINLOG="$CLIENT_DIR/mysqlbinlog"
+else
+    MYSQLBINLOG=$(which mysqlbinlog)
+fi
+
+[ -n "$WSREP_SST_OPT_USER" ] && AUTH="-u$WSREP_SST_OPT_USER" || AUTH=
+
+# See wsrep_sst_mysqldump for why password is passed in environment
+[ -n "$WSREP_SST_OPT_PSWD" ] && export MYSQL_PWD="$WSREP_SST_OPT_PSWD"
+
+STOP_WSREP="SET wsrep_on=OFF;"
+
+SET_START_POSITION="SET GLOBAL wsrep_start_position='$WSREP_SST_OPT_GTID';"
+
+# events keep their GTIDs, so joiner gtid_executed follows donor's.
+# --stop-position applies to the last file, which donor was writing.
+MYSQLBINLOG="$MYSQLBINLOG --include-gtids=$(echo $WSREP_SST_OPT_GTID_SET | tr -d ' ') \
+--stop-position=$WSREP_SST_OPT_BINLOG_STOP"
+
+MYSQL="$MYSQL_CLIENT --defaults-extra-file=$WSREP_SST_OPT_CONF "\
+"$AUTH -h${WSREP_SST_OPT_HOST_UNESCAPED:-$WSREP_SST_OPT_HOST} "\
+"-P$WSREP_SST_OPT_PORT --disable-reconnect --connect_timeout=10"
+
+wsrep_log_info "Sending $WSREP_SST_OPT_GTID_SET from $WSREP_SST_OPT_BINLOG_FILES"
+
+(echo $STOP_WSREP && $MYSQLBINLOG $WSREP_SST_OPT_BINLOG_FILES \
+    && echo $SET_START_POSITION \
+    || echo "SST failed to complete;") | $MYSQL
+
+#
@@ -103,6 +103,18 @@ case "$1" in
         WSREP_SST_OPT_BINLOG="$2"
         shift
         ;;
+    '--gtid-set')
+        readonly WSREP_SST_OPT_GTID_SET="$2"
+        shift
+        ;;
+    '--binlog-files')
+        readonly WSREP_SST_OPT_BINLOG_FILES="$2"
+        shift
+        ;;
+    '--binlog-stop')
+        readonly WSREP_SST_OPT_BINLOG_STOP="$2"
+        shift
+        ;;
     *) # must be command
        # usage
        # exit 1
@@ -123,6 +123,10 @@ RESTORE_SLOW_QUERY_LOG="SET GLOBAL SLOW_QUERY_LOG=$SLOW_LOG_OPT;"
 # reset master for 5.6 to clear GTID_EXECUTED
 RESET_MASTER="RESET MASTER;"
 
+# [sst] mysqldump-parallel=N: dump table data with N connections and load
+# it with N clients. Data is dumped from one snapshot, which needs RELOAD.
+PARALLEL=$(parse_cnf sst mysqldump-parallel 0)
+
 
 if [ $WSREP_SST_OPT_BYPASS -eq 0 ]
 then
@@ -131,10 +135,31 @@ then
     # and if joiner binlog is disabled, 'RESET MASTER' returns error
     # ERROR 1186 (HY000) at line 2: Binlog closed, cannot RESET MASTER
     (echo $STOP_WSREP && echo $RESET_MASTER) | $MYSQL || true
-    (echo $STOP_WSREP && $MYSQLDUMP \
-        && echo $RESTORE_GENERAL_LOG && echo $RESTORE_SLOW_QUERY_LOG \
-        && echo $SET_START_POSITION \
-        || echo "SST failed to complete;") | $MYSQL
+    if [ "$PARALLEL" -gt 0 ]
+    then
+        DATA_DIR=$(mktemp -d)
+        trap "rm -rf $DATA_DIR" EXIT
+
+        # schema and mysql database go first, then table data concurrently,
+        # then triggers
+        export MYSQL STOP_WSREP
+        (echo $STOP_WSREP && $MYSQLDUMP --single-transaction \
+            --parallel=$PARALLEL --parallel-dir=$DATA_DIR \
+            || echo "SST failed to complete;") | $MYSQL
+        wsrep_log_info "Loading table data with $PARALLEL clients"
+        (find $DATA_DIR -name 'data-*.sql' | \
+            xargs -r -n 1 -P $PARALLEL \
+            bash -c '(echo $STOP_WSREP && cat "$1") | $MYSQL' load >&2 \
+            && echo $STOP_WSREP && cat $DATA_DIR/triggers.sql \
+            && echo $RESTORE_GENERAL_LOG && echo $RESTORE_SLOW_QUERY_LOG \
+            && echo $SET_START_POSITION \
+            || echo "SST failed to complete;") | $MYSQL
+    else
+        (echo $STOP_WSREP && $MYSQLDUMP \
+            && echo $RESTORE_GENERAL_LOG && echo $RESTORE_SLOW_QUERY_LOG \
+            && echo $SET_START_POSITION \
+            || echo "SST failed to complete;") | $MYSQL
+    fi
 else
     wsrep_log_info "Bypassing state dump."
     echo $SET_START_POSITION | $MYSQL
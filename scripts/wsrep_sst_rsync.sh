@@ -79,6 +79,9 @@ check_pid_and_port()
 MAGIC_FILE="$WSREP_SST_OPT_DATA/rsync_sst_complete"
 rm -rf "$MAGIC_FILE"
 
+# Pages that InnoDB saved during the transfer, written back by the joiner
+SNAPSHOT_FILE="$WSREP_SST_OPT_DATA/ib_snapshot"
+
 BINLOG_TAR_FILE="$WSREP_SST_OPT_DATA/wsrep_sst_binlog.tar"
 BINLOG_N_FILES=1
 rm -f "$BINLOG_TAR_FILE" || :
@@ -133,7 +136,18 @@ then
         [ "$inv" = "wsrep_sst_rsync_wan" ] && WHOLE_FILE_OPT="" \
                                            || WHOLE_FILE_OPT="--whole-file"
 
-        echo "flush tables"
+        # [sst] snapshot=1: tables are locked only while files other than
+        # InnoDB ones are copied, InnoDB saves the pages that it overwrites
+        # while its files are copied.
+        SNAPSHOT=$(parse_cnf sst snapshot 0)
+        DIR_FILTER=(--exclude '*/ib_logfile*')
+
+        if [ "$SNAPSHOT" -ne 0 ]
+        then
+            echo "snapshot"
+        else
+            echo "flush tables"
+        fi
 
         # wait for tables flushed and state ID written to the file
         while [ ! -r "$FLUSHED" ] && ! grep -q ':' "$FLUSHED" >/dev/null 2>&1
@@ -164,8 +178,33 @@ then
             popd &> /dev/null
         fi
 
-        # first, the normal directories, so that we can detect incompatible protocol
         RC=0
+
+        if [ "$SNAPSHOT" -ne 0 ]
+        then
+            pushd "$WSREP_SST_OPT_DATA" >/dev/null
+
+            find . -maxdepth 1 -mindepth 1 -type d -not -name "lost+found" \
+                 -print0 | xargs -I{} -0 \
+                 rsync --owner --group --perms --links --specials \
+                 --ignore-times --inplace --recursive --delete --quiet \
+                 $WHOLE_FILE_OPT --exclude '*.ibd' --exclude '*/ib_logfile*' \
+                 "$WSREP_SST_OPT_DATA"/{}/ rsync://$WSREP_SST_OPT_ADDR/{} >&2 \
+                 || RC=$?
+
+            popd >/dev/null
+
+            if [ $RC -ne 0 ]; then
+                wsrep_log_error "find/rsync returned code $RC:"
+                exit 255 # unknown error
+            fi
+
+            echo "continue" # only InnoDB files are left to copy
+
+            DIR_FILTER=(-f '+ */' -f '+ *.ibd' -f '- *')
+        fi
+
+        # first, the normal directories, so that we can detect incompatible protocol
         rsync --owner --group --perms --links --specials \
               --ignore-times --inplace --dirs --delete --quiet \
               $WHOLE_FILE_OPT "${FILTER[@]}" "$WSREP_SST_OPT_DATA/" \
@@ -210,7 +249,7 @@ then
              -print0 | xargs -I{} -0 -P $count \
              rsync --owner --group --perms --links --specials \
              --ignore-times --inplace --recursive --delete --quiet \
-             $WHOLE_FILE_OPT --exclude '*/ib_logfile*' "$WSREP_SST_OPT_DATA"/{}/ \
+             $WHOLE_FILE_OPT "${DIR_FILTER[@]}" "$WSREP_SST_OPT_DATA"/{}/ \
              rsync://$WSREP_SST_OPT_ADDR/{} >&2 || RC=$?
 
         popd >/dev/null
@@ -220,6 +259,32 @@ then
             exit 255 # unknown error
         fi
 
+        if [ "$SNAPSHOT" -ne 0 ]
+        then
+            echo "snapshot end"
+
+            # server renames ib_snapshot.tmp to ib_snapshot.done when all
+            # pages were saved, and deletes it otherwise
+            while [ -e "$SNAPSHOT_FILE.tmp" ]
+            do
+                sleep 0.2
+            done
+
+            if [ ! -r "$SNAPSHOT_FILE.done" ]; then
+                wsrep_log_error "InnoDB snapshot failed"
+                exit 255 # unknown error
+            fi
+
+            rsync --archive --quiet --whole-file "$SNAPSHOT_FILE.done" \
+                  rsync://$WSREP_SST_OPT_ADDR/ib_snapshot >&2 || RC=$?
+            rm -f "$SNAPSHOT_FILE.done"
+
+            if [ $RC -ne 0 ]; then
+                wsrep_log_error "rsync ib_snapshot returned code $RC:"
+                exit 255 # unknown error
+            fi
+        fi
+
     else # BYPASS
         wsrep_log_info "Bypassing state dump."
         STATE="$WSREP_SST_OPT_GTID"
@@ -236,6 +301,9 @@ elif [ "$WSREP_SST_OPT_ROLE" = "joiner" ]
 then
     wsrep_check_programs lsof
 
+    # InnoDB applies it at startup, so it must come from this transfer
+    rm -f "$SNAPSHOT_FILE"
+
     touch $SST_PROGRESS_FILE
     MYSQLD_PID=$WSREP_SST_OPT_PARENT
 
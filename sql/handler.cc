@@ -1478,7 +1478,13 @@ end:
   }
   /* Free resources and perform other cleanup even for 'empty' transactions. */
   if (is_real_trans)
+  {
     thd->transaction.cleanup();
+#ifdef WITH_WSREP
+    /* Not done in wsrep_cleanup_transaction(): wsrep_on may be off by now */
+    wsrep_clear_row_keys(thd);
+#endif /* WITH_WSREP */
+  }
   DBUG_RETURN(error);
 }
 
@@ -1671,7 +1677,12 @@ int ha_rollback_trans(THD *thd, bool all)
 
   /* Always cleanup. Even if nht==0. There may be savepoints. */
   if (is_real_trans)
+  {
     thd->transaction.cleanup();
+#ifdef WITH_WSREP
+    wsrep_clear_row_keys(thd);
+#endif /* WITH_WSREP */
+  }
   if (all)
     thd->transaction_rollback_request= FALSE;
 
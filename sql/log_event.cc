@@ -1433,7 +1433,7 @@ err:
 Log_event* Log_event::read_log_event(const char* buf, uint event_len,
 				     const char **error,
                                      const Format_description_log_event *description_event,
-                                     my_bool crc_check)
+                                     my_bool crc_check, MEM_ROOT *mem_root)
 {
   Log_event* ev;
   uint8 alg;
@@ -1576,101 +1576,107 @@ Log_event* Log_event::read_log_event(const char* buf, uint event_len,
     
     switch(event_type) {
     case QUERY_EVENT:
-      ev  = new Query_log_event(buf, event_len, description_event, QUERY_EVENT);
+      ev  = new (mem_root) Query_log_event(buf, event_len, description_event, QUERY_EVENT);
       break;
     case LOAD_EVENT:
-      ev = new Load_log_event(buf, event_len, description_event);
+      ev = new (mem_root) Load_log_event(buf, event_len, description_event);
       break;
     case NEW_LOAD_EVENT:
-      ev = new Load_log_event(buf, event_len, description_event);
+      ev = new (mem_root) Load_log_event(buf, event_len, description_event);
       break;
     case ROTATE_EVENT:
-      ev = new Rotate_log_event(buf, event_len, description_event);
+      ev = new (mem_root) Rotate_log_event(buf, event_len, description_event);
       break;
     case CREATE_FILE_EVENT:
-      ev = new Create_file_log_event(buf, event_len, description_event);
+      ev = new (mem_root) Create_file_log_event(buf, event_len, description_event);
       break;
     case APPEND_BLOCK_EVENT:
-      ev = new Append_block_log_event(buf, event_len, description_event);
+      ev = new (mem_root) Append_block_log_event(buf, event_len, description_event);
       break;
     case DELETE_FILE_EVENT:
-      ev = new Delete_file_log_event(buf, event_len, description_event);
+      ev = new (mem_root) Delete_file_log_event(buf, event_len, description_event);
       break;
     case EXEC_LOAD_EVENT:
-      ev = new Execute_load_log_event(buf, event_len, description_event);
+      ev = new (mem_root) Execute_load_log_event(buf, event_len, description_event);
       break;
     case START_EVENT_V3: /* this is sent only by MySQL <=4.x */
-      ev = new Start_log_event_v3(buf, event_len, description_event);
+      ev = new (mem_root) Start_log_event_v3(buf, event_len, description_event);
       break;
     case STOP_EVENT:
-      ev = new Stop_log_event(buf, description_event);
+      ev = new (mem_root) Stop_log_event(buf, description_event);
       break;
     case INTVAR_EVENT:
-      ev = new Intvar_log_event(buf, description_event);
+      ev = new (mem_root) Intvar_log_event(buf, description_event);
       break;
     case XID_EVENT:
-      ev = new Xid_log_event(buf, description_event);
+      ev = new (mem_root) Xid_log_event(buf, description_event);
       break;
     case RAND_EVENT:
-      ev = new Rand_log_event(buf, description_event);
+      ev = new (mem_root) Rand_log_event(buf, description_event);
       break;
     case USER_VAR_EVENT:
-      ev = new User_var_log_event(buf, event_len, description_event);
+      ev = new (mem_root) User_var_log_event(buf, event_len, description_event);
       break;
     case FORMAT_DESCRIPTION_EVENT:
-      ev = new Format_description_log_event(buf, event_len, description_event);
+      ev = new (mem_root) Format_description_log_event(buf, event_len, description_event);
       break;
 #if defined(HAVE_REPLICATION) 
     case PRE_GA_WRITE_ROWS_EVENT:
-      ev = new Write_rows_log_event_old(buf, event_len, description_event);
+      ev = new (mem_root) Write_rows_log_event_old(buf, event_len, description_event);
       break;
     case PRE_GA_UPDATE_ROWS_EVENT:
-      ev = new Update_rows_log_event_old(buf, event_len, description_event);
+      ev = new (mem_root) Update_rows_log_event_old(buf, event_len, description_event);
       break;
     case PRE_GA_DELETE_ROWS_EVENT:
-      ev = new Delete_rows_log_event_old(buf, event_len, description_event);
+      ev = new (mem_root) Delete_rows_log_event_old(buf, event_len, description_event);
       break;
     case WRITE_ROWS_EVENT_V1:
-      ev = new Write_rows_log_event(buf, event_len, description_event);
+      ev = new (mem_root) Write_rows_log_event(buf, event_len, description_event,
+                                               mem_root);
       break;
     case UPDATE_ROWS_EVENT_V1:
-      ev = new Update_rows_log_event(buf, event_len, description_event);
+      ev = new (mem_root) Update_rows_log_event(buf, event_len, description_event,
+                                                mem_root);
       break;
     case DELETE_ROWS_EVENT_V1:
-      ev = new Delete_rows_log_event(buf, event_len, description_event);
+      ev = new (mem_root) Delete_rows_log_event(buf, event_len, description_event,
+                                                mem_root);
       break;
     case TABLE_MAP_EVENT:
-      ev = new Table_map_log_event(buf, event_len, description_event);
+      ev = new (mem_root) Table_map_log_event(buf, event_len, description_event);
       break;
 #endif
     case BEGIN_LOAD_QUERY_EVENT:
-      ev = new Begin_load_query_log_event(buf, event_len, description_event);
+      ev = new (mem_root) Begin_load_query_log_event(buf, event_len, description_event);
       break;
     case EXECUTE_LOAD_QUERY_EVENT:
-      ev= new Execute_load_query_log_event(buf, event_len, description_event);
+      ev= new (mem_root) Execute_load_query_log_event(buf, event_len, description_event);
       break;
     case INCIDENT_EVENT:
-      ev = new Incident_log_event(buf, event_len, description_event);
+      ev = new (mem_root) Incident_log_event(buf, event_len, description_event);
       break;
     case ROWS_QUERY_LOG_EVENT:
-      ev= new Rows_query_log_event(buf, event_len, description_event);
+      ev= new (mem_root) Rows_query_log_event(buf, event_len, description_event);
       break;
     case GTID_LOG_EVENT:
     case ANONYMOUS_GTID_LOG_EVENT:
-      ev= new Gtid_log_event(buf, event_len, description_event);
+      ev= new (mem_root) Gtid_log_event(buf, event_len, description_event);
       break;
     case PREVIOUS_GTIDS_LOG_EVENT:
-      ev= new Previous_gtids_log_event(buf, event_len, description_event);
+      ev= new (mem_root) Previous_gtids_log_event(buf, event_len, description_event);
       break;
 #if defined(HAVE_REPLICATION)
     case WRITE_ROWS_EVENT:
-      ev = new Write_rows_log_event(buf, event_len, description_event);
+      ev = new (mem_root) Write_rows_log_event(buf, event_len, description_event,
+                                               mem_root);
       break;
     case UPDATE_ROWS_EVENT:
-      ev = new Update_rows_log_event(buf, event_len, description_event);
+      ev = new (mem_root) Update_rows_log_event(buf, event_len, description_event,
+                                                mem_root);
       break;
     case DELETE_ROWS_EVENT:
-      ev = new Delete_rows_log_event(buf, event_len, description_event);
+      ev = new (mem_root) Delete_rows_log_event(buf, event_len, description_event,
+                                                mem_root);
       break;
 #endif
     default:
@@ -1680,7 +1686,7 @@ Log_event* Log_event::read_log_event(const char* buf, uint event_len,
       */
       if (uint2korr(buf + FLAGS_OFFSET) & LOG_EVENT_IGNORABLE_F)
       {
-        ev= new Ignorable_log_event(buf, description_event);
+        ev= new (mem_root) Ignorable_log_event(buf, description_event);
       }
       else
       {
@@ -1719,7 +1725,10 @@ Log_event* Log_event::read_log_event(const char* buf, uint event_len,
   {
     DBUG_PRINT("error",("Found invalid event in binary log"));
 
-    delete ev;
+    if (mem_root && ev)
+      ev->~Log_event();
+    else
+      delete ev;
 #ifdef MYSQL_CLIENT
     if (!force_opt) /* then mysqlbinlog dies */
     {
@@ -3579,9 +3588,10 @@ Query_log_event::Query_log_event(THD* thd_arg, const char* query_arg,
 #ifdef WITH_WSREP
   /*
     If Query_log_event will contain non trans keyword (not BEGIN, COMMIT,
-    SAVEPOINT or ROLLBACK) we disable PA for this transaction.
+    SAVEPOINT or ROLLBACK) we disable PA for this transaction, unless the
+    tables of the statement can be covered with table keys.
    */
-  if (!is_trans_keyword())
+  if (!is_trans_keyword() && !wsrep_stmt_table_keys(thd))
     thd->wsrep_PA_safe= false;
 #endif /* WITH_WSREP */
   memset(&user, 0, sizeof(user));
@@ -9379,7 +9389,8 @@ Rows_log_event::Rows_log_event(THD *thd_arg, TABLE *tbl_arg, const Table_id& tid
     m_table(tbl_arg),
     m_table_id(tid),
     m_width(tbl_arg ? tbl_arg->s->fields : 1),
-    m_rows_buf(0), m_rows_cur(0), m_rows_end(0), m_flags(0),
+    m_rows_buf(0), m_rows_cur(0), m_rows_end(0), m_rows_buf_in_root(false),
+    m_flags(0),
     m_type(event_type), m_extra_row_data(0)
 #ifdef HAVE_REPLICATION
     , m_curr_row(NULL), m_curr_row_end(NULL), m_key(NULL), m_key_info(NULL),
@@ -9436,14 +9447,15 @@ Rows_log_event::Rows_log_event(THD *thd_arg, TABLE *tbl_arg, const Table_id& tid
 
 Rows_log_event::Rows_log_event(const char *buf, uint event_len,
                                const Format_description_log_event
-                               *description_event)
+                               *description_event,
+                               MEM_ROOT *mem_root)
   : Log_event(buf, description_event),
     m_row_count(0),
 #ifndef MYSQL_CLIENT
     m_table(NULL),
 #endif
     m_table_id(0), m_rows_buf(0), m_rows_cur(0), m_rows_end(0),
-    m_extra_row_data(0)
+    m_rows_buf_in_root(mem_root != NULL), m_extra_row_data(0)
 #if !defined(MYSQL_CLIENT) && defined(HAVE_REPLICATION)
     , m_curr_row(NULL), m_curr_row_end(NULL), m_key(NULL), m_key_info(NULL),
     m_distinct_keys(Key_compare(&m_key_info)), m_distinct_key_spare_buf(NULL)
@@ -9585,7 +9597,14 @@ Rows_log_event::Rows_log_event(const char *buf, uint event_len,
   DBUG_PRINT("info",("m_table_id: %llu  m_flags: %d  m_width: %lu  data_size: %lu",
                      m_table_id.id(), m_flags, m_width, (ulong) data_size));
 
-  m_rows_buf= (uchar*) my_malloc(data_size, MYF(MY_WME));
+  /*
+    With a MEM_ROOT the rows are released together with the event, e.g.
+    when the applier resets its arena at write set commit.
+  */
+  if (mem_root)
+    m_rows_buf= (uchar*) alloc_root(mem_root, data_size);
+  else
+    m_rows_buf= (uchar*) my_malloc(data_size, MYF(MY_WME));
   if (likely((bool)m_rows_buf))
   {
 #if !defined(MYSQL_CLIENT) && defined(HAVE_REPLICATION)
@@ -9606,7 +9625,8 @@ Rows_log_event::~Rows_log_event()
   if (m_cols.bitmap == m_bitbuf) // no my_malloc happened
     m_cols.bitmap= 0; // so no my_free in bitmap_free
   bitmap_free(&m_cols); // To pair with bitmap_init().
-  my_free(m_rows_buf);
+  if (!m_rows_buf_in_root)
+    my_free(m_rows_buf);
   my_free(m_extra_row_data);
 }
 
@@ -9712,6 +9732,7 @@ int Rows_log_event::do_add_row_data(uchar *row_data, size_t length)
     ulong const new_alloc= 
         block_size * ((cur_size + length + block_size - 1) / block_size);
 
+    DBUG_ASSERT(!m_rows_buf_in_root);
     uchar* const new_buf=
       (uchar*)my_realloc((uchar*)m_rows_buf, (uint) new_alloc,
                          MYF(MY_ALLOW_ZERO_PTR|MY_WME));
@@ -12554,8 +12575,9 @@ Write_rows_log_event::Write_rows_log_event(THD *thd_arg, TABLE *tbl_arg,
 #ifdef HAVE_REPLICATION
 Write_rows_log_event::Write_rows_log_event(const char *buf, uint event_len,
                                            const Format_description_log_event
-                                           *description_event)
-: Rows_log_event(buf, event_len, description_event)
+                                           *description_event,
+                                           MEM_ROOT *mem_root)
+: Rows_log_event(buf, event_len, description_event, mem_root)
 {
 }
 #endif
@@ -13083,8 +13105,9 @@ Delete_rows_log_event::Delete_rows_log_event(THD *thd_arg, TABLE *tbl_arg,
 #ifdef HAVE_REPLICATION
 Delete_rows_log_event::Delete_rows_log_event(const char *buf, uint event_len,
                                              const Format_description_log_event
-                                             *description_event)
-  : Rows_log_event(buf, event_len, description_event)
+                                             *description_event,
+                                             MEM_ROOT *mem_root)
+  : Rows_log_event(buf, event_len, description_event, mem_root)
 {
 }
 #endif
@@ -13203,8 +13226,9 @@ Update_rows_log_event::~Update_rows_log_event()
 Update_rows_log_event::Update_rows_log_event(const char *buf, uint event_len,
                                              const
                                              Format_description_log_event
-                                             *description_event)
-  : Rows_log_event(buf, event_len, description_event)
+                                             *description_event,
+                                             MEM_ROOT *mem_root)
+  : Rows_log_event(buf, event_len, description_event, mem_root)
 {
 }
 #endif
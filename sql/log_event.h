@@ -1297,6 +1297,19 @@ public:
   /* Placement version of the above operators */
   static void *operator new(size_t, void* ptr) { return ptr; }
   static void operator delete(void*, void*) { }
+
+  /*
+    Arena version of the above operators, falls back to my_malloc() when
+    mem_root is NULL. An event allocated in a MEM_ROOT must be destroyed
+    by calling the destructor explicitly, not by delete.
+  */
+  static void *operator new(size_t size, MEM_ROOT *mem_root) throw ()
+  {
+    if (mem_root)
+      return alloc_root(mem_root, size);
+    return (void*) my_malloc((uint)size, MYF(MY_WME|MY_FAE));
+  }
+  static void operator delete(void*, MEM_ROOT*) { }
   bool wrapper_my_b_safe_write(IO_CACHE* file, const uchar* buf, ulong data_length);
 
 #ifdef MYSQL_SERVER
@@ -1368,7 +1381,8 @@ public:
   static Log_event* read_log_event(const char* buf, uint event_len,
 				   const char **error,
                                    const Format_description_log_event
-                                   *description_event, my_bool crc_check);
+                                   *description_event, my_bool crc_check,
+                                   MEM_ROOT *mem_root= NULL);
   /**
     Returns the human readable name of the given event type.
   */
@@ -4178,7 +4192,8 @@ protected:
                  const uchar* extra_row_info);
 #endif
   Rows_log_event(const char *row_data, uint event_len, 
-		 const Format_description_log_event *description_event);
+		 const Format_description_log_event *description_event,
+                 MEM_ROOT *mem_root= NULL);
 
 #ifdef MYSQL_CLIENT
   void print_helper(FILE *, PRINT_EVENT_INFO *, char const *const name);
@@ -4225,6 +4240,7 @@ protected:
   uchar    *m_rows_buf;		/* The rows in packed format */
   uchar    *m_rows_cur;		/* One-after the end of the data */
   uchar    *m_rows_end;		/* One-after the end of the allocated space */
+  bool      m_rows_buf_in_root; /* m_rows_buf belongs to a MEM_ROOT */
 
   flag_set m_flags;		/* Flags for row-level events */
 
@@ -4516,7 +4532,8 @@ public:
 #endif
 #ifdef HAVE_REPLICATION
   Write_rows_log_event(const char *buf, uint event_len, 
-                       const Format_description_log_event *description_event);
+                       const Format_description_log_event *description_event,
+                       MEM_ROOT *mem_root= NULL);
 #endif
 #if defined(MYSQL_SERVER) 
   static bool binlog_row_logging_function(THD *thd, TABLE *table,
@@ -4587,7 +4604,8 @@ public:
 
 #ifdef HAVE_REPLICATION
   Update_rows_log_event(const char *buf, uint event_len, 
-			const Format_description_log_event *description_event);
+			const Format_description_log_event *description_event,
+                        MEM_ROOT *mem_root= NULL);
 #endif
 
 #ifdef MYSQL_SERVER
@@ -4655,7 +4673,8 @@ public:
 #endif
 #ifdef HAVE_REPLICATION
   Delete_rows_log_event(const char *buf, uint event_len, 
-			const Format_description_log_event *description_event);
+			const Format_description_log_event *description_event,
+                        MEM_ROOT *mem_root= NULL);
 #endif
 #ifdef MYSQL_SERVER
   static bool binlog_row_logging_function(THD *thd, TABLE *table,
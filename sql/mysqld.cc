@@ -77,6 +77,9 @@
 #include "wsrep_var.h"
 #include "wsrep_thd.h"
 #include "wsrep_sst.h"
+#include "wsrep_binlog.h"
+#include "wsrep_applier.h"
+#include "wsrep_notify.h"
 #endif
 #include "sql_callback.h"
 #include "opt_trace_context.h"
@@ -773,13 +776,14 @@ mysql_mutex_t LOCK_wsrep_sst;
 mysql_cond_t  COND_wsrep_sst;
 mysql_mutex_t LOCK_wsrep_sst_init;
 mysql_cond_t  COND_wsrep_sst_init;
-mysql_mutex_t LOCK_wsrep_rollback;
-mysql_cond_t  COND_wsrep_rollback;
-wsrep_aborting_thd_t wsrep_aborting_thd= NULL;
 mysql_mutex_t LOCK_wsrep_replaying;
 mysql_cond_t  COND_wsrep_replaying;
 mysql_mutex_t LOCK_wsrep_slave_threads;
 mysql_mutex_t LOCK_wsrep_desync;
+mysql_mutex_t LOCK_wsrep_nbo;
+mysql_cond_t  COND_wsrep_nbo;
+mysql_mutex_t LOCK_wsrep_sync_wait;
+mysql_cond_t  COND_wsrep_sync_wait;
 int wsrep_replaying= 0;
 static void wsrep_close_threads(THD* thd);
 #endif /* WITH_WSREP */
@@ -2128,12 +2132,16 @@ static void clean_up_mutexes()
   (void) mysql_cond_destroy(&COND_wsrep_sst);
   (void) mysql_mutex_destroy(&LOCK_wsrep_sst_init);
   (void) mysql_cond_destroy(&COND_wsrep_sst_init);
-  (void) mysql_mutex_destroy(&LOCK_wsrep_rollback);
-  (void) mysql_cond_destroy(&COND_wsrep_rollback);
+  wsrep_rollbacker_deinit();
+  wsrep_notify_deinit();
   (void) mysql_mutex_destroy(&LOCK_wsrep_replaying);
   (void) mysql_cond_destroy(&COND_wsrep_replaying);
   (void) mysql_mutex_destroy(&LOCK_wsrep_slave_threads);
   (void) mysql_mutex_destroy(&LOCK_wsrep_desync);
+  (void) mysql_mutex_destroy(&LOCK_wsrep_nbo);
+  (void) mysql_cond_destroy(&COND_wsrep_nbo);
+  (void) mysql_mutex_destroy(&LOCK_wsrep_sync_wait);
+  (void) mysql_cond_destroy(&COND_wsrep_sync_wait);
 #endif
   mysql_cond_destroy(&COND_connection_count);
 }
@@ -4436,9 +4444,8 @@ static int init_thread_environment()
   mysql_mutex_init(key_LOCK_wsrep_sst_init,
                    &LOCK_wsrep_sst_init, MY_MUTEX_INIT_FAST);
   mysql_cond_init(key_COND_wsrep_sst_init, &COND_wsrep_sst_init, NULL);
-  mysql_mutex_init(key_LOCK_wsrep_rollback,
-                   &LOCK_wsrep_rollback, MY_MUTEX_INIT_FAST);
-  mysql_cond_init(key_COND_wsrep_rollback, &COND_wsrep_rollback, NULL);
+  wsrep_rollbacker_init();
+  wsrep_notify_init();
   mysql_mutex_init(key_LOCK_wsrep_replaying,
                    &LOCK_wsrep_replaying, MY_MUTEX_INIT_FAST);
   mysql_cond_init(key_COND_wsrep_replaying, &COND_wsrep_replaying, NULL);
@@ -4446,6 +4453,11 @@ static int init_thread_environment()
                    &LOCK_wsrep_slave_threads, MY_MUTEX_INIT_FAST);
   mysql_mutex_init(key_LOCK_wsrep_desync,
                    &LOCK_wsrep_desync, MY_MUTEX_INIT_FAST);
+  mysql_mutex_init(key_LOCK_wsrep_nbo, &LOCK_wsrep_nbo, MY_MUTEX_INIT_FAST);
+  mysql_cond_init(key_COND_wsrep_nbo, &COND_wsrep_nbo, NULL);
+  mysql_mutex_init(key_LOCK_wsrep_sync_wait,
+                   &LOCK_wsrep_sync_wait, MY_MUTEX_INIT_FAST);
+  mysql_cond_init(key_COND_wsrep_sync_wait, &COND_wsrep_sync_wait, NULL);
 #endif
   return 0;
 }
@@ -5733,16 +5745,14 @@ void wsrep_wait_appliers_close(THD *thd)
 {
   /* Wait for wsrep appliers to gracefully exit */
   mysql_mutex_lock(&LOCK_thread_count);
-  while (have_wsrep_appliers(thd) > 1)
-  // 1 is for rollbacker thread which needs to be killed explicitly.
-  // This gotta be fixed in a more elegant manner if we gonna have arbitrary
-  // number of non-applier wsrep threads.
+  while (have_wsrep_appliers(thd) > (int)wsrep_rollbacker_threads)
+  // rollbacker threads need to be killed explicitly.
   {
     mysql_cond_wait(&COND_thread_count,&LOCK_thread_count);
     DBUG_PRINT("quit",("One applier died (count=%u)", get_thread_count()));
   }
   mysql_mutex_unlock(&LOCK_thread_count);
-  /* Now kill remaining wsrep threads: rollbacker */
+  /* Now kill remaining wsrep threads: rollbackers */
   wsrep_close_threads (thd);
   /* and wait for them to die */
   mysql_mutex_lock(&LOCK_thread_count);
@@ -8808,6 +8818,15 @@ SHOW_VAR status_vars[]= {
   {"wsrep_cluster_size",       (char*) &wsrep_cluster_size,      SHOW_LONG_NOFLUSH},
   {"wsrep_local_index",        (char*) &wsrep_local_index,       SHOW_LONG_NOFLUSH},
   {"wsrep_local_bf_aborts",    (char*) &wsrep_show_bf_aborts,    SHOW_FUNC},
+  {"wsrep_zero_copy_bytes",    (char*) &wsrep_show_zero_copy_bytes, SHOW_FUNC},
+  {"wsrep_cache_chunks_appended", (char*) &wsrep_show_cache_chunks, SHOW_FUNC},
+  {"wsrep_hash_keys_bytes_saved", (char*) &wsrep_show_hash_keys_bytes_saved, SHOW_FUNC},
+  {"wsrep_rollbacker",         (char*) &wsrep_show_rollbacker_status, SHOW_FUNC},
+  {"wsrep_sync_wait",          (char*) &wsrep_show_sync_wait_status, SHOW_FUNC},
+  {"wsrep_pa",                 (char*) &wsrep_show_pa_status,    SHOW_FUNC},
+  {"wsrep_applier_decode_time",(char*) &wsrep_show_applier_decode_time, SHOW_FUNC},
+  {"wsrep_applier_apply_time", (char*) &wsrep_show_applier_apply_time, SHOW_FUNC},
+  {"wsrep_replay_snapshots",   (char*) &wsrep_show_replay_snapshots, SHOW_FUNC},
   {"wsrep_provider_name",      (char*) &wsrep_provider_name,     SHOW_CHAR_PTR},
   {"wsrep_provider_version",   (char*) &wsrep_provider_version,  SHOW_CHAR_PTR},
   {"wsrep_provider_vendor",    (char*) &wsrep_provider_vendor,   SHOW_CHAR_PTR},
@@ -10458,10 +10477,13 @@ PSI_mutex_key
   key_LOCK_error_messages, key_LOG_INFO_lock, key_LOCK_thread_count,
   key_LOCK_log_throttle_qni;
 #ifdef WITH_WSREP
-PSI_mutex_key key_LOCK_wsrep_rollback, key_LOCK_wsrep_thd, 
+PSI_mutex_key key_LOCK_wsrep_rollbacker, key_LOCK_wsrep_applier_decoder,
+  key_LOCK_wsrep_thd, 
   key_LOCK_wsrep_replaying, key_LOCK_wsrep_ready, key_LOCK_wsrep_sst, 
   key_LOCK_wsrep_sst_thread, key_LOCK_wsrep_sst_init, 
-  key_LOCK_wsrep_slave_threads, key_LOCK_wsrep_desync;
+  key_LOCK_wsrep_slave_threads, key_LOCK_wsrep_desync, key_LOCK_wsrep_nbo,
+  key_LOCK_wsrep_sync_wait, key_LOCK_wsrep_conflict_stats,
+  key_LOCK_wsrep_notify;
 #endif
 PSI_mutex_key key_LOCK_thd_remove;
 PSI_mutex_key key_RELAYLOG_LOCK_commit;
@@ -10555,11 +10577,16 @@ static PSI_mutex_info all_server_mutexes[]=
   { &key_LOCK_wsrep_sst_thread, "wsrep_sst_thread", 0},
   { &key_LOCK_wsrep_sst_init, "LOCK_wsrep_sst_init", PSI_FLAG_GLOBAL},
   { &key_LOCK_wsrep_sst, "LOCK_wsrep_sst", PSI_FLAG_GLOBAL},
-  { &key_LOCK_wsrep_rollback, "LOCK_wsrep_rollback", PSI_FLAG_GLOBAL},
+  { &key_LOCK_wsrep_rollbacker, "wsrep_rollbacker::LOCK", 0},
+  { &key_LOCK_wsrep_applier_decoder, "Wsrep_event_decoder::lock", 0},
   { &key_LOCK_wsrep_thd, "THD::LOCK_wsrep_thd", 0},
   { &key_LOCK_wsrep_replaying, "LOCK_wsrep_replaying", PSI_FLAG_GLOBAL},
   { &key_LOCK_wsrep_slave_threads, "LOCK_wsrep_slave_threads", PSI_FLAG_GLOBAL},
   { &key_LOCK_wsrep_desync, "LOCK_wsrep_desync", PSI_FLAG_GLOBAL},
+  { &key_LOCK_wsrep_nbo, "LOCK_wsrep_nbo", PSI_FLAG_GLOBAL},
+  { &key_LOCK_wsrep_sync_wait, "LOCK_wsrep_sync_wait", PSI_FLAG_GLOBAL},
+  { &key_LOCK_wsrep_conflict_stats, "LOCK_wsrep_conflict_stats", 0},
+  { &key_LOCK_wsrep_notify, "LOCK_wsrep_notify", PSI_FLAG_GLOBAL},
 #endif
   { &key_LOCK_thd_remove, "LOCK_thd_remove", PSI_FLAG_GLOBAL},
   { &key_LOCK_log_throttle_qni, "LOCK_log_throttle_qni", PSI_FLAG_GLOBAL},
@@ -10618,9 +10645,11 @@ PSI_cond_key key_BINLOG_update_cond,
   key_COND_thread_count, key_COND_thread_cache, key_COND_flush_thread_cache,
   key_COND_connection_count;
 #ifdef WITH_WSREP
-PSI_cond_key key_COND_wsrep_rollback, key_COND_wsrep_thd, 
+PSI_cond_key key_COND_wsrep_rollbacker, key_COND_wsrep_applier_decoder,
+  key_COND_wsrep_thd, 
   key_COND_wsrep_replaying, key_COND_wsrep_ready, key_COND_wsrep_sst,
-  key_COND_wsrep_sst_init, key_COND_wsrep_sst_thread;
+  key_COND_wsrep_sst_init, key_COND_wsrep_sst_thread, key_COND_wsrep_nbo,
+  key_COND_wsrep_sync_wait, key_COND_wsrep_notify;
 
 #endif /* WITH_WSREP */
 PSI_cond_key key_RELAYLOG_update_cond;
@@ -10672,9 +10701,13 @@ static PSI_cond_info all_server_conds[]=
   { &key_COND_wsrep_sst, "COND_wsrep_sst", PSI_FLAG_GLOBAL},
   { &key_COND_wsrep_sst_init, "COND_wsrep_sst_init", PSI_FLAG_GLOBAL},
   { &key_COND_wsrep_sst_thread, "wsrep_sst_thread", 0},
-  { &key_COND_wsrep_rollback, "COND_wsrep_rollback", PSI_FLAG_GLOBAL},
+  { &key_COND_wsrep_rollbacker, "wsrep_rollbacker::COND", 0},
+  { &key_COND_wsrep_applier_decoder, "Wsrep_event_decoder::cond", 0},
   { &key_COND_wsrep_thd, "THD::COND_wsrep_thd", 0},
   { &key_COND_wsrep_replaying, "COND_wsrep_replaying", PSI_FLAG_GLOBAL},
+  { &key_COND_wsrep_nbo, "COND_wsrep_nbo", PSI_FLAG_GLOBAL},
+  { &key_COND_wsrep_sync_wait, "COND_wsrep_sync_wait", PSI_FLAG_GLOBAL},
+  { &key_COND_wsrep_notify, "COND_wsrep_notify", PSI_FLAG_GLOBAL},
 #endif
   { &key_COND_flush_thread_cache, "COND_flush_thread_cache", PSI_FLAG_GLOBAL},
   { &key_gtid_ensure_index_cond, "Gtid_state", PSI_FLAG_GLOBAL},
@@ -60,6 +60,7 @@
 #ifdef WITH_WSREP
 #include "wsrep_mysqld.h"
 #include "wsrep_thd.h"
+#include "wsrep_applier.h"
 #endif
 #include "lock.h"
 #include "global_threads.h"
@@ -1110,6 +1111,10 @@ THD::THD(bool enable_plugins)
    wsrep_po_cnt(0),
    wsrep_po_in_trans(FALSE),
    wsrep_apply_format(0),
+   wsrep_applier_ctx(0),
+   wsrep_key_buffer(0),
+   wsrep_cache_chunk_pos(0),
+   wsrep_nbo(0),
    wsrep_apply_toi(false),
 #endif
    m_parser_state(NULL),
@@ -1220,6 +1225,10 @@ THD::THD(bool enable_plugins)
   wsrep_TOI_pre_query_len = 0;
   wsrep_sync_wait_gtid    = WSREP_GTID_UNDEFINED;
   wsrep_affected_rows     = 0;
+  wsrep_conflict_key_len  = 0;
+  wsrep_conflict_start    = 0;
+  wsrep_ws_deps           = 0;
+  wsrep_hash_keys_saved   = 0;
   wsrep_replicate_GTID    = false;
   wsrep_skip_wsrep_GTID   = false;
 #endif
@@ -1639,6 +1648,10 @@ void THD::init(void)
   wsrep_TOI_pre_query_len = 0;
   wsrep_sync_wait_gtid    = WSREP_GTID_UNDEFINED;
   wsrep_affected_rows     = 0;
+  wsrep_conflict_key_len  = 0;
+  wsrep_conflict_start    = 0;
+  wsrep_ws_deps           = 0;
+  wsrep_hash_keys_saved   = 0;
   wsrep_replicate_GTID    = false;
   wsrep_skip_wsrep_GTID   = false;
 #endif
@@ -1848,7 +1861,9 @@ void THD::release_resources()
     delete wsrep_rli;
     wsrep_rli = NULL;
   }
+  wsrep_applier_ctx_release(this);
   wsrep_free_status(this);
+  wsrep_free_row_keys(this);
 #endif
 }
 
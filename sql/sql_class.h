@@ -3239,11 +3239,26 @@ public:
   my_bool                   wsrep_po_in_trans;
   rpl_sid                   wsrep_po_sid;
   void*                     wsrep_apply_format;
+  void*                     wsrep_applier_ctx; /* applier decoding context */
+  void*                     wsrep_key_buffer; /* buffered row keys */
+  my_off_t                  wsrep_cache_chunk_pos; /* binlog cache appended
+                                                      to write set so far */
+  void*                     wsrep_nbo; /* non-blocking operation context */
   bool                      wsrep_apply_toi; /* applier processing in TOI */
   wsrep_gtid_t              wsrep_sync_wait_gtid;
   ulong                     wsrep_affected_rows;
+  /* table and index of the first row the transaction wrote, as
+     "db\0table\0index\0", and when, for conflict statistics */
+  char                      wsrep_conflict_key[3 * (NAME_LEN + 1)];
+  uint                      wsrep_conflict_key_len;
+  ulonglong                 wsrep_conflict_start;
+  uint                      wsrep_ws_deps; /* WSREP_DEPS_* of writeset */
+  ulonglong                 wsrep_hash_keys_saved; /* key bytes hashed away
+                                                      in writeset */
   bool                      wsrep_replicate_GTID;
   bool                      wsrep_skip_wsrep_GTID;
+  /* rollbacker queue node, used when BF aborted in idle state */
+  struct wsrep_aborting_thd wsrep_aborting_node;
 #endif /* WITH_WSREP */
   /**
     Internal parser state.
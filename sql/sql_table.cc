@@ -56,6 +56,9 @@
 #include "sql_resolver.h"              // setup_order, fix_inner_refs
 #include "table_cache.h"
 #include <mysql/psi/mysql_table.h>
+#ifdef WITH_WSREP
+#include "wsrep_nbo.h"
+#endif
 
 #ifdef __WIN__
 #include <io.h>
@@ -6765,6 +6768,10 @@ static bool mysql_inplace_alter_table(THD *thd,
     }
   }
 
+#ifdef WITH_WSREP
+  /* let cluster apply other write sets while table is being rebuilt */
+  wsrep_NBO_phase_one_end(thd);
+#endif /* WITH_WSREP */
   DEBUG_SYNC(thd, "alter_table_inplace_after_lock_downgrade");
   THD_STAGE_INFO(thd, stage_alter_inplace);
 
@@ -6774,6 +6781,12 @@ static bool mysql_inplace_alter_table(THD *thd,
     goto rollback;
   }
 
+#ifdef WITH_WSREP
+  /* swap table definitions in total order */
+  if (wsrep_NBO_phase_two_begin(thd))
+    goto rollback;
+#endif /* WITH_WSREP */
+
   // Upgrade to EXCLUSIVE before commit.
   if (wait_while_table_is_used(thd, table, HA_EXTRA_PREPARE_FOR_RENAME))
     goto rollback;
@@ -2159,6 +2159,10 @@ bool Table_triggers_list::process_triggers(THD *thd,
   if (sp_trigger == NULL)
     return FALSE;
 
+#ifdef WITH_WSREP
+  thd->wsrep_ws_deps|= WSREP_DEPS_TRIGGER;
+#endif /* WITH_WSREP */
+
   if (old_row_is_record1)
   {
     old_field= record1_field;
@@ -4251,6 +4251,7 @@ static Sys_var_tz Sys_time_zone(
 #ifdef WITH_WSREP
 #include "wsrep_var.h"
 #include "wsrep_sst.h"
+#include "wsrep_sst_native.h"
 #include "wsrep_binlog.h"
 
 static Sys_var_charptr Sys_wsrep_provider(
@@ -4322,6 +4323,21 @@ static Sys_var_ulong Sys_wsrep_slave_threads(
        ON_CHECK(NULL),
        ON_UPDATE(wsrep_slave_threads_update));
 
+static Sys_var_ulong Sys_wsrep_rollbacker_threads(
+       "wsrep_rollbacker_threads", "Number of threads rolling back "
+       "transactions aborted by replicated transactions while idle",
+       READ_ONLY GLOBAL_VAR(wsrep_rollbacker_threads), CMD_LINE(REQUIRED_ARG),
+       VALID_RANGE(1, WSREP_ROLLBACKER_THREADS_MAX), DEFAULT(1),
+       BLOCK_SIZE(1));
+
+static Sys_var_ulong Sys_wsrep_applier_lookahead(
+       "wsrep_applier_lookahead", "Maximum number of events a separate "
+       "decoder thread may decode ahead of each slave applier. "
+       "0 means appliers decode events themselves",
+       GLOBAL_VAR(wsrep_applier_lookahead), CMD_LINE(REQUIRED_ARG),
+       VALID_RANGE(0, WSREP_APPLIER_LOOKAHEAD_MAX), DEFAULT(0),
+       BLOCK_SIZE(1));
+
 static Sys_var_charptr Sys_wsrep_dbug_option(
        "wsrep_dbug_option", "DBUG options to provider library",
        GLOBAL_VAR(wsrep_dbug_option),CMD_LINE(REQUIRED_ARG),
@@ -4393,6 +4409,26 @@ static Sys_var_mybool Sys_wsrep_sst_donor_rejects_queries(
        GLOBAL_VAR(wsrep_sst_donor_rejects_queries), 
        CMD_LINE(OPT_ARG), DEFAULT(FALSE));
 
+static Sys_var_ulong Sys_wsrep_sst_native_threads(
+       "wsrep_sst_native_threads", "Number of parallel connections "
+       "used by donor to send data files with 'native' SST method",
+       GLOBAL_VAR(wsrep_sst_native_threads), CMD_LINE(REQUIRED_ARG),
+       VALID_RANGE(1, WSREP_SST_NATIVE_THREADS_MAX), DEFAULT(4),
+       BLOCK_SIZE(1));
+
+static Sys_var_mybool Sys_wsrep_sst_native_compress(
+       "wsrep_sst_native_compress", "Compress data files sent by donor "
+       "with 'native' SST method",
+       GLOBAL_VAR(wsrep_sst_native_compress),
+       CMD_LINE(OPT_ARG), DEFAULT(FALSE));
+
+static Sys_var_ulong Sys_wsrep_sst_native_timeout(
+       "wsrep_sst_native_timeout", "Seconds joiner waits for the donor "
+       "to connect or to send more data with 'native' SST method before "
+       "it fails the transfer",
+       GLOBAL_VAR(wsrep_sst_native_timeout), CMD_LINE(REQUIRED_ARG),
+       VALID_RANGE(1, 86400), DEFAULT(300), BLOCK_SIZE(1));
+
 static Sys_var_mybool Sys_wsrep_on (
        "wsrep_on", "To enable wsrep replication ",
        SESSION_VAR(wsrep_on), 
@@ -4416,6 +4452,22 @@ static Sys_var_ulong Sys_wsrep_max_ws_size (
        BLOCK_SIZE(1), NO_MUTEX_GUARD, NOT_IN_BINLOG, ON_CHECK(0),
        ON_UPDATE(wsrep_max_ws_size_update));
 
+static Sys_var_mybool Sys_wsrep_zero_copy_data_collection(
+       "wsrep_zero_copy_data_collection", "Append transaction binlog cache "
+       "to the write set in place, without reading it into an intermediate "
+       "buffer",
+       GLOBAL_VAR(wsrep_zero_copy_data_collection),
+       CMD_LINE(OPT_ARG), DEFAULT(FALSE));
+
+static Sys_var_ulong Sys_wsrep_append_cache_chunk_size(
+       "wsrep_append_cache_chunk_size", "Copy the transaction binlog cache "
+       "to the local write set in chunks of at least this many bytes as "
+       "statements of a multi statement transaction complete, instead of "
+       "all at once at commit. The write set is still replicated at "
+       "commit. 0 copies the cache at commit only",
+       GLOBAL_VAR(wsrep_append_cache_chunk_size), CMD_LINE(REQUIRED_ARG),
+       VALID_RANGE(0, WSREP_MAX_WS_SIZE), DEFAULT(0), BLOCK_SIZE(1));
+
 static Sys_var_ulong Sys_wsrep_max_ws_rows (
        "wsrep_max_ws_rows", "Max number of rows in write set",
        GLOBAL_VAR(wsrep_max_ws_rows), CMD_LINE(REQUIRED_ARG),
@@ -4431,6 +4483,31 @@ static Sys_var_mybool Sys_wsrep_certify_nonPK(
        GLOBAL_VAR(wsrep_certify_nonPK), 
        CMD_LINE(OPT_ARG), DEFAULT(TRUE));
 
+static Sys_var_mybool Sys_wsrep_hash_keys(
+       "wsrep_hash_keys", "Replicate 128-bit hashes of wide row key values "
+       "instead of the values themselves. Must be set the same on all nodes",
+       READ_ONLY GLOBAL_VAR(wsrep_hash_keys),
+       CMD_LINE(OPT_ARG), DEFAULT(FALSE));
+
+static Sys_var_mybool Sys_wsrep_pa_table_keys(
+       "wsrep_pa_table_keys", "Append table level keys for the tables of "
+       "statements replicated in statement format, so that such writesets "
+       "can be applied in parallel with writesets touching other tables. "
+       "The table keys are exclusive, so concurrent writes to the same "
+       "tables from other nodes fail certification against them. Row "
+       "writes to tables without keys get a shared table key",
+       GLOBAL_VAR(wsrep_pa_table_keys),
+       CMD_LINE(OPT_ARG), DEFAULT(FALSE));
+
+static Sys_var_ulong Sys_wsrep_key_batch_size(
+       "wsrep_key_batch_size", "Maximum number of distinct row keys a "
+       "transaction buffers before passing them to the provider. Keys are "
+       "also passed at the end of each statement. 0 means every row key "
+       "is passed as soon as it is appended",
+       GLOBAL_VAR(wsrep_key_batch_size), CMD_LINE(REQUIRED_ARG),
+       VALID_RANGE(0, WSREP_KEY_BATCH_SIZE_MAX), DEFAULT(0),
+       BLOCK_SIZE(1));
+
 static Sys_var_mybool Sys_wsrep_causal_reads(
        "wsrep_causal_reads", "(DEPRECATED) setting this variable is equivalent to setting wsrep_sync_wait READ flag",
        SESSION_VAR(wsrep_causal_reads), 
@@ -4448,7 +4525,16 @@ static Sys_var_uint Sys_wsrep_sync_wait(
        NO_MUTEX_GUARD, NOT_IN_BINLOG, ON_CHECK(0),
        ON_UPDATE(wsrep_sync_wait_update));
 
-static const char *wsrep_OSU_method_names[]= { "TOI", "RSU", NullS };
+static Sys_var_ulong Sys_wsrep_sync_wait_window(
+       "wsrep_sync_wait_window", "Time in microseconds a sync wait "
+       "delays its causal read so that sync waits of other sessions can "
+       "share it. Sync waits which arrive while a causal read is being "
+       "prepared share it regardless",
+       GLOBAL_VAR(wsrep_sync_wait_window), CMD_LINE(REQUIRED_ARG),
+       VALID_RANGE(0, WSREP_SYNC_WAIT_WINDOW_MAX), DEFAULT(0),
+       BLOCK_SIZE(1));
+
+static const char *wsrep_OSU_method_names[]= { "TOI", "RSU", "NBO", NullS };
 static Sys_var_enum Sys_wsrep_OSU_method(
        "wsrep_OSU_method", "Method for Online Schema Upgrade",
        SESSION_VAR(wsrep_OSU_method), CMD_LINE(OPT_ARG),
@@ -18,19 +18,161 @@
 #include "wsrep_priv.h"
 #include "wsrep_binlog.h" // wsrep_dump_rbr_buf()
 #include "wsrep_xid.h"
+#include "wsrep_nbo.h"
+#include "wsrep_thd.h"    // wsrep_thd_rli()
 
 #include "log_event.h" // class THD, EVENT_LEN_OFFSET, etc.
 #include "debug_sync.h"
+#include "my_rdtsc.h"   // my_timer_nanoseconds()
+
+/*
+  Format description event cache.
+
+  Write sets replicated by the same node carry identical format description
+  events, so instead of decoding and then deleting a new one for every write
+  set, the event decoded from an earlier write set is reused when the raw
+  event matches. Cached event may be referenced until the end of the write
+  set, so a different format description event met in the same write set
+  is not cached and stays owned by the applier.
+*/
+class Wsrep_format_cache
+{
+public:
+
+  Wsrep_format_cache() : fde_(NULL), raw_(NULL), raw_len_(0), in_use_(false)
+  { }
+
+  ~Wsrep_format_cache()
+  {
+    delete fde_;
+    my_free(raw_);
+  }
+
+  /* return cached event if it was decoded from an equivalent buffer */
+  Format_description_log_event* lookup(const char* buf, size_t len)
+  {
+    if (fde_ && raw_len_ == len && same_format(buf))
+    {
+      in_use_= true;
+      return fde_;
+    }
+    return NULL;
+  }
+
+  /* returns true if the cache took ownership of fde */
+  bool store(Format_description_log_event* fde, const char* buf, size_t len);
+
+  bool owns(const Log_event* ev) const { return ev == fde_; }
+
+  /* called at the end of write set */
+  void release() { in_use_= false; }
+
+private:
+
+  bool same_format(const char* buf) const;
+
+  Format_description_log_event* fde_;
+  char*  raw_;
+  size_t raw_len_;
+  bool   in_use_;
+};
+
+/*
+  Event header, creation timestamp and the trailing checksum differ between
+  otherwise identical format description events and do not affect decoding
+  of the following events. Without checksum the last bytes are the post
+  header lengths of the last event types, which are determined by the server
+  version compared before.
+*/
+bool Wsrep_format_cache::same_format(const char* buf) const
+{
+  const char* const body= buf + LOG_EVENT_MINIMAL_HEADER_LEN;
+  const char* const raw_body= raw_ + LOG_EVENT_MINIMAL_HEADER_LEN;
+  size_t const tail_len= raw_len_ - LOG_EVENT_MINIMAL_HEADER_LEN -
+                         ST_COMMON_HEADER_LEN_OFFSET - BINLOG_CHECKSUM_LEN;
+
+  return (!memcmp(body, raw_body, ST_CREATED_OFFSET) &&
+          !memcmp(body + ST_COMMON_HEADER_LEN_OFFSET,
+                  raw_body + ST_COMMON_HEADER_LEN_OFFSET, tail_len));
+}
+
+bool Wsrep_format_cache::store(Format_description_log_event* const fde,
+                               const char* const buf, size_t const len)
+{
+  if (in_use_ || len < LOG_EVENT_MINIMAL_HEADER_LEN +
+                       ST_COMMON_HEADER_LEN_OFFSET + BINLOG_CHECKSUM_LEN)
+    return false;
+
+  char* const raw= (char*)my_malloc(len, MYF(0));
+  if (!raw) return false;
+
+  memcpy(raw, buf, len);
+  delete fde_;
+  my_free(raw_);
+  fde_= fde;
+  raw_= raw;
+  raw_len_= len;
+  in_use_= true;
+
+  return true;
+}
+
+class Wsrep_event_decoder;
+
+/*
+  Events of a local write set decoded ahead of its replay.
+
+  Transaction BF aborted after certification is replayed by applying its
+  own write set when its turn comes. The events are decoded from the
+  binlog cache of the transaction as soon as the abort is known, while it
+  still waits for the preceding transactions, so that the replay itself
+  only applies them.
+*/
+struct Wsrep_replay_snapshot
+{
+  Log_event** events;
+  size_t      count;
+  size_t      next;      /* next event to apply */
+  size_t      buf_len;   /* size of the write set events were decoded from */
+};
+
+/*
+  Event decoding context of an applier thread, or of a client thread
+  between BF abort and replay of its transaction. Events other than format
+  description are constructed in the arena which is reset at write set
+  commit, so small write sets are decoded without any malloc() for the
+  event objects.
+*/
+struct Wsrep_applier_ctx
+{
+  Wsrep_applier_ctx() : decoder(NULL)
+  {
+    init_alloc_root(&mem_root, ARENA_BLOCK_SIZE, ARENA_BLOCK_SIZE);
+    memset(&replay, 0, sizeof(replay));
+  }
+
+  ~Wsrep_applier_ctx() { free_root(&mem_root, MYF(0)); }
+
+  static const size_t  ARENA_BLOCK_SIZE= 8192;
+
+  MEM_ROOT              mem_root;
+  Wsrep_format_cache    format_cache;
+  Wsrep_event_decoder*  decoder;
+  Wsrep_replay_snapshot replay;
+};
 
 /*
   read the first event from (*buf). The size of the (*buf) is (*buf_len).
   At the end (*buf) is shitfed to point to the following event or NULL and
   (*buf_len) will be changed to account just being read bytes of the 1st event.
+  With ctx the event is allocated in applier arena and must be released
+  with wsrep_free_log_event().
 */
 
 static Log_event* wsrep_read_log_event(
     char **arg_buf, size_t *arg_buf_len,
-    const Format_description_log_event *description_event)
+    const Format_description_log_event *description_event,
+    Wsrep_applier_ctx *ctx)
 {
   DBUG_ENTER("wsrep_read_log_event");
   char *head= (*arg_buf);
@@ -39,21 +181,347 @@ static Log_event* wsrep_read_log_event(
   char *buf= (*arg_buf);
   const char *error= 0;
   Log_event *res=  0;
+  MEM_ROOT *mem_root= ctx ? &ctx->mem_root : NULL;
+  bool const is_fde= (head[EVENT_TYPE_OFFSET] == FORMAT_DESCRIPTION_EVENT);
 
-  res= Log_event::read_log_event(buf, data_len, &error, description_event, 0);
+  if (is_fde)
+  {
+    /* format description event outlives the write set */
+    mem_root= NULL;
+    if (ctx) res= ctx->format_cache.lookup(buf, data_len);
+  }
 
   if (!res)
   {
-    DBUG_ASSERT(error != 0);
-    sql_print_error("Error in Log_event::read_log_event(): "
-                    "'%s', data_len: %d, event_type: %d",
-                    error,data_len,head[EVENT_TYPE_OFFSET]);
+    res= Log_event::read_log_event(buf, data_len, &error, description_event,
+                                   0, mem_root);
+
+    if (!res)
+    {
+      DBUG_ASSERT(error != 0);
+      sql_print_error("Error in Log_event::read_log_event(): "
+                      "'%s', data_len: %d, event_type: %d",
+                      error,data_len,head[EVENT_TYPE_OFFSET]);
+    }
+    else if (is_fde && ctx &&
+             res->get_type_code() == FORMAT_DESCRIPTION_EVENT)
+    {
+      ctx->format_cache.store((Format_description_log_event*)res,
+                              buf, data_len);
+    }
   }
   (*arg_buf)+= data_len;
   (*arg_buf_len)-= data_len;
   DBUG_RETURN(res);
 }
 
+/* release event returned by wsrep_read_log_event() */
+static void wsrep_free_log_event(Log_event *ev, Wsrep_applier_ctx *ctx)
+{
+  if (!ctx)
+    delete ev;
+  else if (ev->get_type_code() != FORMAT_DESCRIPTION_EVENT)
+    ev->~Log_event();                   /* memory is reclaimed at commit */
+  else if (!ctx->format_cache.owns(ev))
+    delete ev;
+}
+
+/* total time spent in event decoding and applying, nanoseconds */
+static int64 wsrep_applier_decode_ns= 0;
+static int64 wsrep_applier_apply_ns= 0;
+
+static inline Log_event* wsrep_decode_log_event(
+    char **arg_buf, size_t *arg_buf_len,
+    const Format_description_log_event *description_event,
+    Wsrep_applier_ctx *ctx)
+{
+  ulonglong const start= my_timer_nanoseconds();
+  Log_event* const res= wsrep_read_log_event(arg_buf, arg_buf_len,
+                                             description_event, ctx);
+  my_atomic_add64(&wsrep_applier_decode_ns, my_timer_nanoseconds() - start);
+  return res;
+}
+
+int wsrep_show_applier_decode_time(THD *thd, SHOW_VAR *var, char *buff)
+{
+  *(longlong *)buff= my_atomic_load64(&wsrep_applier_decode_ns) / 1000;
+  var->type = SHOW_LONGLONG;
+  var->value = buff;
+  return 0;
+}
+
+int wsrep_show_applier_apply_time(THD *thd, SHOW_VAR *var, char *buff)
+{
+  *(longlong *)buff= my_atomic_load64(&wsrep_applier_apply_ns) / 1000;
+  var->type = SHOW_LONGLONG;
+  var->value = buff;
+  return 0;
+}
+
+/*
+  Applier event decoder.
+
+  When wsrep_applier_lookahead is non-zero every applier thread gets a
+  companion decoder thread which parses the events of the write set being
+  applied ahead of the applier and passes them over through a bounded ring
+  of up to wsrep_applier_lookahead decoded events. Event parsing and row
+  image copying then overlap with the storage engine work of applying the
+  preceding events.
+
+  Decoder follows format description events on its own and never touches
+  the applier THD. It shares the applier context: decoding happens either
+  in the decoder or in the applier, never in both. Write set buffer is valid only for the duration of the
+  apply callback, so the applier must call finish() before returning: it
+  stops the decoder and discards the events which were not consumed.
+*/
+class Wsrep_event_decoder
+{
+public:
+
+  Wsrep_event_decoder(size_t lookahead, Wsrep_applier_ctx* ctx);
+  ~Wsrep_event_decoder();
+
+  bool   start_thread();
+  size_t lookahead() const { return size_; }
+
+  /* start decoding of a new write set */
+  void start(char* buf, size_t buf_len,
+             const Format_description_log_event* fde);
+
+  /*
+    Return next decoded event in write set order. NULL is returned at the
+    end of write set, *error is set if decoding failed.
+  */
+  Log_event* next(bool* error);
+
+  /* stop decoding current write set, discard events not consumed */
+  void finish();
+
+private:
+
+  static void* run(void* arg);
+  void decode();
+
+  mysql_mutex_t lock_;
+  mysql_cond_t  cond_;
+  pthread_t     thread_;
+  bool          thread_started_;
+  Wsrep_applier_ctx* const ctx_;
+
+  Log_event**   ring_;
+  size_t const  size_;
+  size_t        head_;     /* next event to consume */
+  size_t        tail_;     /* next slot to fill */
+
+  char*         buf_;      /* rest of the write set to decode */
+  size_t        buf_len_;
+  const Format_description_log_event* fde_;
+
+  bool          busy_;     /* decoder is working on a write set */
+  bool          error_;
+  bool          cancel_;
+  bool          shutdown_;
+};
+
+Wsrep_event_decoder::Wsrep_event_decoder(size_t const lookahead,
+                                         Wsrep_applier_ctx* const ctx)
+  :
+  thread_started_(false),
+  ctx_(ctx),
+  ring_((Log_event**)my_malloc(lookahead * sizeof(Log_event*), MYF(MY_WME))),
+  size_(lookahead),
+  head_(0),
+  tail_(0),
+  buf_(NULL),
+  buf_len_(0),
+  fde_(NULL),
+  busy_(false),
+  error_(false),
+  cancel_(false),
+  shutdown_(false)
+{
+  mysql_mutex_init(key_LOCK_wsrep_applier_decoder, &lock_, MY_MUTEX_INIT_FAST);
+  mysql_cond_init(key_COND_wsrep_applier_decoder, &cond_, NULL);
+}
+
+Wsrep_event_decoder::~Wsrep_event_decoder()
+{
+  if (thread_started_)
+  {
+    mysql_mutex_lock(&lock_);
+    shutdown_= true;
+    mysql_cond_broadcast(&cond_);
+    mysql_mutex_unlock(&lock_);
+    pthread_join(thread_, NULL);
+  }
+  DBUG_ASSERT(head_ == tail_);
+  my_free(ring_);
+  mysql_cond_destroy(&cond_);
+  mysql_mutex_destroy(&lock_);
+}
+
+bool Wsrep_event_decoder::start_thread()
+{
+  if (!ring_) return true;
+  thread_started_= !pthread_create(&thread_, NULL, run, this);
+  return !thread_started_;
+}
+
+void* Wsrep_event_decoder::run(void* arg)
+{
+  if (my_thread_init()) return NULL;
+  static_cast<Wsrep_event_decoder*>(arg)->decode();
+  my_thread_end();
+  return NULL;
+}
+
+void Wsrep_event_decoder::decode()
+{
+  mysql_mutex_lock(&lock_);
+
+  while (true)
+  {
+    while (!busy_ && !shutdown_) mysql_cond_wait(&cond_, &lock_);
+
+    if (shutdown_) break;
+
+    while (buf_len_ > 0 && !cancel_)
+    {
+      if (tail_ - head_ == size_)
+      {
+        mysql_cond_wait(&cond_, &lock_);
+        continue;
+      }
+
+      /* buf_, buf_len_ and fde_ are not touched by applier while busy_ */
+      char*  buf= buf_;
+      size_t buf_len= buf_len_;
+      mysql_mutex_unlock(&lock_);
+
+      Log_event* const ev= wsrep_decode_log_event(&buf, &buf_len, fde_, ctx_);
+
+      mysql_mutex_lock(&lock_);
+
+      if (!ev)
+      {
+        error_= true;
+        break;
+      }
+
+      if (ev->get_type_code() == FORMAT_DESCRIPTION_EVENT)
+        fde_= (Format_description_log_event*)ev;
+
+      buf_= buf;
+      buf_len_= buf_len;
+      ring_[tail_ % size_]= ev;
+      if (tail_++ == head_) mysql_cond_broadcast(&cond_);
+    }
+
+    busy_= false;
+    mysql_cond_broadcast(&cond_);
+  }
+
+  mysql_mutex_unlock(&lock_);
+}
+
+void Wsrep_event_decoder::start(char* const buf, size_t const buf_len,
+                                const Format_description_log_event* fde)
+{
+  mysql_mutex_lock(&lock_);
+  DBUG_ASSERT(!busy_ && head_ == tail_);
+  buf_= buf;
+  buf_len_= buf_len;
+  fde_= fde;
+  error_= false;
+  busy_= buf_len > 0;
+  mysql_cond_broadcast(&cond_);
+  mysql_mutex_unlock(&lock_);
+}
+
+Log_event* Wsrep_event_decoder::next(bool* const error)
+{
+  Log_event* ev= NULL;
+
+  mysql_mutex_lock(&lock_);
+
+  while (head_ == tail_ && busy_) mysql_cond_wait(&cond_, &lock_);
+
+  if (head_ != tail_)
+  {
+    ev= ring_[head_ % size_];
+    if (tail_ - head_++ == size_) mysql_cond_broadcast(&cond_);
+  }
+  else
+  {
+    *error= error_;
+  }
+
+  mysql_mutex_unlock(&lock_);
+
+  return ev;
+}
+
+void Wsrep_event_decoder::finish()
+{
+  mysql_mutex_lock(&lock_);
+
+  cancel_= true;
+  mysql_cond_broadcast(&cond_);
+  while (busy_) mysql_cond_wait(&cond_, &lock_);
+  cancel_= false;
+
+  for (; head_ != tail_; ++head_)
+    wsrep_free_log_event(ring_[head_ % size_], ctx_);
+
+  mysql_mutex_unlock(&lock_);
+}
+
+/*
+  Returns applier decoding context. Threads replaying local transactions,
+  which use the applier callbacks too, have it only if replay snapshot
+  was taken.
+*/
+static inline Wsrep_applier_ctx* wsrep_applier_ctx(THD* thd)
+{
+  if (!thd->wsrep_applier)
+    return static_cast<Wsrep_applier_ctx*>(thd->wsrep_applier_ctx);
+
+  if (!thd->wsrep_applier_ctx) thd->wsrep_applier_ctx= new Wsrep_applier_ctx;
+
+  return static_cast<Wsrep_applier_ctx*>(thd->wsrep_applier_ctx);
+}
+
+/*
+  Returns applier decoder, (re)creating it if wsrep_applier_lookahead has
+  changed. NULL means events are to be decoded by applier itself.
+*/
+static Wsrep_event_decoder* wsrep_applier_decoder(Wsrep_applier_ctx* ctx)
+{
+  size_t const lookahead= wsrep_applier_lookahead;
+
+  if (!ctx) return NULL;
+
+  if (ctx->decoder && ctx->decoder->lookahead() != lookahead)
+  {
+    delete ctx->decoder;
+    ctx->decoder= NULL;
+  }
+
+  if (!ctx->decoder && lookahead > 0)
+  {
+    ctx->decoder= new Wsrep_event_decoder(lookahead, ctx);
+    if (ctx->decoder->start_thread())
+    {
+      WSREP_WARN("Failed to start applier decoder thread, "
+                 "decoding events in applier");
+      delete ctx->decoder;
+      ctx->decoder= NULL;
+    }
+  }
+
+  return ctx->decoder;
+}
+
 #include "transaction.h" // trans_commit(), trans_rollback()
 #include "rpl_rli.h"     // class Relay_log_info;
 #include "sql_base.h"    // close_temporary_table()
@@ -63,11 +531,43 @@ wsrep_set_apply_format(THD* thd, Format_description_log_event* ev)
 {
   if (thd->wsrep_apply_format)
   {
-      delete (Format_description_log_event*)thd->wsrep_apply_format;
+    Wsrep_applier_ctx* const ctx=
+      static_cast<Wsrep_applier_ctx*>(thd->wsrep_applier_ctx);
+    Format_description_log_event* const fde=
+      (Format_description_log_event*)thd->wsrep_apply_format;
+
+    if (!ctx || !ctx->format_cache.owns(fde))
+      delete fde;
   }
   thd->wsrep_apply_format= ev;
 }
 
+/* release replay snapshot events which were not applied */
+static void wsrep_replay_discard(Wsrep_applier_ctx* ctx)
+{
+  Wsrep_replay_snapshot* const snap= &ctx->replay;
+
+  for (; snap->next < snap->count; ++snap->next)
+    wsrep_free_log_event(snap->events[snap->next], ctx);
+
+  memset(snap, 0, sizeof(*snap));
+}
+
+void wsrep_applier_ctx_release(THD* thd)
+{
+  Wsrep_applier_ctx* const ctx=
+    static_cast<Wsrep_applier_ctx*>(thd->wsrep_applier_ctx);
+
+  if (ctx)
+  {
+    wsrep_replay_discard(ctx);
+    wsrep_set_apply_format(thd, NULL);
+    delete ctx->decoder;
+    delete ctx;
+    thd->wsrep_applier_ctx= NULL;
+  }
+}
+
 static inline Format_description_log_event*
 wsrep_get_apply_format(THD* thd)
 {
@@ -76,6 +576,111 @@ wsrep_get_apply_format(THD* thd)
   return thd->wsrep_rli->get_rli_description_event();
 }
 
+/* number of replays which applied events decoded in advance */
+static int64 wsrep_replay_snapshots= 0;
+
+int wsrep_show_replay_snapshots(THD *thd, SHOW_VAR *var, char *buff)
+{
+  *(longlong *)buff= my_atomic_load64(&wsrep_replay_snapshots);
+  var->type = SHOW_LONGLONG;
+  var->value = buff;
+  return 0;
+}
+
+bool wsrep_replay_snapshot(THD* thd, IO_CACHE* cache)
+{
+  DBUG_ENTER("wsrep_replay_snapshot");
+
+  uchar* buf;
+  size_t buf_len;
+
+  DBUG_ASSERT(!thd->wsrep_applier);
+  wsrep_applier_ctx_release(thd); /* snapshot of an earlier transaction */
+
+  if (wsrep_write_cache_buf(cache, &buf, &buf_len) || !buf_len)
+  {
+    my_free(buf);
+    DBUG_RETURN(true);
+  }
+
+  Wsrep_applier_ctx* const ctx= new Wsrep_applier_ctx;
+  Wsrep_replay_snapshot* const snap= &ctx->replay;
+  const Format_description_log_event* fde=
+    wsrep_thd_rli(thd)->get_rli_description_event();
+  size_t allocated= 0;
+  char*  pos= (char*)buf;
+  size_t left= buf_len;
+  bool   error= false;
+
+  thd->wsrep_applier_ctx= ctx;
+
+  while (left > 0)
+  {
+    if (snap->count == allocated)
+    {
+      size_t const new_size(allocated ? 2 * allocated : 16);
+      Log_event** const events= (Log_event**)
+        alloc_root(&ctx->mem_root, new_size * sizeof(Log_event*));
+      if (!events)
+      {
+        error= true;
+        break;
+      }
+      if (snap->count)
+        memcpy(events, snap->events, snap->count * sizeof(Log_event*));
+      snap->events= events;
+      allocated= new_size;
+    }
+
+    Log_event* const ev= wsrep_decode_log_event(&pos, &left, fde, ctx);
+    if (!ev)
+    {
+      error= true;
+      break;
+    }
+
+    if (ev->get_type_code() == FORMAT_DESCRIPTION_EVENT)
+      fde= (Format_description_log_event*)ev;
+
+    snap->events[snap->count++]= ev;
+  }
+
+  my_free(buf);
+
+  if (error)
+  {
+    WSREP_DEBUG("could not decode write set for replay: %lu %lld",
+                thd->thread_id, (long long)wsrep_thd_trx_seqno(thd));
+    wsrep_applier_ctx_release(thd);
+    DBUG_RETURN(true);
+  }
+
+  snap->buf_len= buf_len;
+  DBUG_RETURN(false);
+}
+
+/*
+  Returns replay snapshot of thd if it was taken from the write set being
+  applied, NULL if events are to be decoded from the write set buffer.
+*/
+static Wsrep_replay_snapshot* wsrep_replay_snapshot_get(THD* thd,
+                                                        Wsrep_applier_ctx* ctx,
+                                                        size_t buf_len)
+{
+  if (!ctx || !ctx->replay.count) return NULL;
+
+  if (thd->wsrep_conflict_state != REPLAYING || ctx->replay.buf_len != buf_len)
+  {
+    WSREP_DEBUG("replay snapshot does not match write set: %zu, %zu",
+                ctx->replay.buf_len, buf_len);
+    wsrep_replay_discard(ctx);
+    return NULL;
+  }
+
+  my_atomic_add64(&wsrep_replay_snapshots, 1);
+  return &ctx->replay;
+}
+
 static wsrep_cb_status_t wsrep_apply_events(THD*        thd,
                                             const void* events_buf,
                                             size_t      buf_len)
@@ -83,6 +688,11 @@ static wsrep_cb_status_t wsrep_apply_events(THD*        thd,
   char *buf= (char *)events_buf;
   int rcode= 0;
   int event= 1;
+  Wsrep_applier_ctx* const ctx= wsrep_applier_ctx(thd);
+  Wsrep_event_decoder* decoder= NULL;
+  Wsrep_replay_snapshot* snapshot;
+  wsrep_NBO_apply_state nbo_state= { 0, WSREP_SEQNO_UNDEFINED, false,
+                                     WSREP_UUID_UNDEFINED };
 
   DBUG_ENTER("wsrep_apply_events");
 
@@ -103,11 +713,30 @@ static wsrep_cb_status_t wsrep_apply_events(THD*        thd,
   if (!buf_len) WSREP_DEBUG("empty rbr buffer to apply: %lld",
                             (long long) wsrep_thd_trx_seqno(thd));
 
-  while(buf_len)
+  if ((snapshot= wsrep_replay_snapshot_get(thd, ctx, buf_len)))
+    buf_len= 0;
+  else if (thd->wsrep_applier && (decoder= wsrep_applier_decoder(ctx)))
+    decoder->start(buf, buf_len, wsrep_get_apply_format(thd));
+
+  while(snapshot || decoder || buf_len)
   {
     int exec_res;
-    Log_event* ev= wsrep_read_log_event(&buf, &buf_len,
-                                        wsrep_get_apply_format(thd));
+    Log_event* ev;
+
+    if (snapshot)
+    {
+      if (snapshot->next == snapshot->count) break; /* end of write set */
+      ev= snapshot->events[snapshot->next++];
+    }
+    else if (decoder)
+    {
+      bool decode_error= false;
+      ev= decoder->next(&decode_error);
+      if (!ev && !decode_error) break; /* end of write set */
+    }
+    else
+      ev= wsrep_decode_log_event(&buf, &buf_len, wsrep_get_apply_format(thd),
+                                 ctx);
 
     if (!ev)
     {
@@ -127,7 +756,7 @@ static wsrep_cb_status_t wsrep_apply_events(THD*        thd,
       if (gev->get_gno() == 0)
       {
         /* Skip GTID log event to make binlog to generate LTID on commit */
-        delete ev;
+        wsrep_free_log_event(ev, ctx);
         continue;
       }
     }
@@ -135,6 +764,23 @@ static wsrep_cb_status_t wsrep_apply_events(THD*        thd,
       break;
     }
 
+    if (thd->wsrep_apply_toi && ev->get_type_code() == QUERY_EVENT)
+    {
+      /* non-blocking operation phases are not applied here */
+      int const nbo_res= wsrep_NBO_apply_event(thd, (Query_log_event*)ev,
+                                               &nbo_state);
+      if (nbo_res >= 0)
+      {
+        wsrep_free_log_event(ev, ctx);
+        if (nbo_res)
+        {
+          rcode= nbo_res;
+          goto error;
+        }
+        continue;
+      }
+    }
+
     thd->server_id = ev->server_id; // use the original server id for logging
     thd->set_time();                // time the query
     wsrep_xid_init(&thd->transaction.xid_state.xid,
@@ -144,7 +790,10 @@ static wsrep_cb_status_t wsrep_apply_events(THD*        thd,
     if (!ev->when.tv_sec)
       my_micro_time_to_timeval(my_micro_time(), &ev->when);
     ev->thd = thd;
+    ulonglong const apply_start= my_timer_nanoseconds();
     exec_res = ev->apply_event(thd->wsrep_rli);
+    my_atomic_add64(&wsrep_applier_apply_ns,
+                    my_timer_nanoseconds() - apply_start);
     DBUG_PRINT("info", ("exec_event result: %d", exec_res));
 
     if (exec_res)
@@ -154,7 +803,7 @@ static wsrep_cb_status_t wsrep_apply_events(THD*        thd,
                  (long long) wsrep_thd_trx_seqno(thd));
       rcode= exec_res;
       /* stop processing for the first error */
-      delete ev;
+      wsrep_free_log_event(ev, ctx);
       goto error;
     }
     event++;
@@ -172,13 +821,19 @@ static wsrep_cb_status_t wsrep_apply_events(THD*        thd,
       /* Release transactional metadata locks. */
       thd->mdl_context.release_transactional_locks();
       thd->wsrep_conflict_state= NO_CONFLICT;
+      wsrep_free_log_event(ev, ctx);
+      if (decoder) decoder->finish();
+      if (snapshot) wsrep_replay_discard(ctx);
       DBUG_RETURN(WSREP_CB_FAILURE);
     }
 
-    delete ev;
+    wsrep_free_log_event(ev, ctx);
   }
 
  error:
+  if (decoder) decoder->finish();
+  if (snapshot) wsrep_replay_discard(ctx);
+
   mysql_mutex_lock(&thd->LOCK_wsrep_thd);
   thd->wsrep_query_state= QUERY_IDLE;
   mysql_mutex_unlock(&thd->LOCK_wsrep_thd);
@@ -351,6 +1006,13 @@ wsrep_cb_status_t wsrep_commit_cb(void*         const     ctx,
     rcode = wsrep_rollback(thd);
 
   wsrep_set_apply_format(thd, NULL);
+  if (thd->wsrep_applier_ctx)
+  {
+    Wsrep_applier_ctx* const ctx=
+      static_cast<Wsrep_applier_ctx*>(thd->wsrep_applier_ctx);
+    ctx->format_cache.release();
+    free_root(&ctx->mem_root, MYF(MY_KEEP_PREALLOC));
+  }
   thd->mdl_context.release_transactional_locks();
   free_root(thd->mem_root,MYF(MY_KEEP_PREALLOC));
   thd->tx_isolation= (enum_tx_isolation) thd->variables.tx_isolation;
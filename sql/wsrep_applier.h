@@ -35,4 +35,26 @@ wsrep_cb_status_t wsrep_unordered_cb(void*       ctx,
                                      const void* data,
                                      size_t      size);
 
+class THD;
+struct st_mysql_show_var;
+struct st_io_cache;
+
+/* free applier decoding context and stop its decoder thread, if any */
+void wsrep_applier_ctx_release(THD* thd);
+
+/*
+  Decode events of local transaction from its binlog cache, to be applied
+  by the replay of the transaction instead of the replicated write set.
+  Returns true if no snapshot was taken. Snapshot is freed with
+  wsrep_applier_ctx_release().
+*/
+bool wsrep_replay_snapshot(THD* thd, struct st_io_cache* cache);
+
+int wsrep_show_applier_decode_time(THD* thd, struct st_mysql_show_var* var,
+                                   char* buff);
+int wsrep_show_applier_apply_time(THD* thd, struct st_mysql_show_var* var,
+                                  char* buff);
+int wsrep_show_replay_snapshots(THD* thd, struct st_mysql_show_var* var,
+                                char* buff);
+
 #endif /* WSREP_APPLIER_H */
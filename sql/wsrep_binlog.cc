@@ -137,11 +137,12 @@ wsrep_append_data(wsrep_t*           const wsrep,
 static int wsrep_write_cache_once(wsrep_t*  const wsrep,
                                   THD*      const thd,
                                   IO_CACHE* const cache,
+                                  my_off_t  const from,
                                   size_t*   const len)
 {
     my_off_t const saved_pos(my_b_tell(cache));
 
-    if (reinit_io_cache(cache, READ_CACHE, 0, 0, 0))
+    if (reinit_io_cache(cache, READ_CACHE, from, 0, 0))
     {
         WSREP_ERROR("failed to initialize io-cache");
         return ER_ERROR_ON_WRITE;
@@ -149,7 +150,7 @@ static int wsrep_write_cache_once(wsrep_t*  const wsrep,
 
     int err(WSREP_OK);
 
-    size_t total_length(0);
+    size_t total_length(from);
     uchar  stack_buf[STACK_SIZE]; /* to avoid dynamic allocations for few data*/
     uchar* heap_buf(NULL);
     uchar* buf(stack_buf);
@@ -176,9 +177,9 @@ static int wsrep_write_cache_once(wsrep_t*  const wsrep,
             goto cleanup;
         }
 
-        if (total_length > allocated)
+        if (used + length > allocated)
         {
-            size_t const new_size(heap_size(total_length));
+            size_t const new_size(heap_size(used + length));
             uchar* tmp = (uchar *)my_realloc(heap_buf, new_size, MYF(0));
             if (!tmp)
             {
@@ -200,7 +201,7 @@ static int wsrep_write_cache_once(wsrep_t*  const wsrep,
         }
 
         memcpy(buf + used, cache->read_pos, length);
-        used = total_length;
+        used += length;
         cache->read_pos = cache->read_end;
     } while ((cache->file >= 0) && (length = my_b_fill(cache)));
 
@@ -232,11 +233,12 @@ cleanup:
 static int wsrep_write_cache_inc(wsrep_t*  const wsrep,
                                  THD*      const thd,
                                  IO_CACHE* const cache,
+                                 my_off_t  const from,
                                  size_t*   const len)
 {
     my_off_t const saved_pos(my_b_tell(cache));
 
-    if (reinit_io_cache(cache, READ_CACHE, 0, 0, 0))
+    if (reinit_io_cache(cache, READ_CACHE, from, 0, 0))
     {
       WSREP_ERROR("failed to initialize io-cache");
       return WSREP_TRX_ERROR;
@@ -244,7 +246,7 @@ static int wsrep_write_cache_inc(wsrep_t*  const wsrep,
 
     int err(WSREP_OK);
 
-    size_t total_length(0);
+    size_t total_length(from);
 
     uint length(my_b_bytes_in_cache(cache));
     if (unlikely(0 == length)) length = my_b_fill(cache);
@@ -282,6 +284,116 @@ cleanup:
     return err;
 }
 
+/* total number of bytes passed to provider without intermediate copy */
+long long wsrep_zero_copy_bytes= 0;
+
+int wsrep_show_zero_copy_bytes(THD *thd, SHOW_VAR *var, char *buff)
+{
+    *(long long *)buff= my_atomic_load64(&wsrep_zero_copy_bytes);
+    var->type = SHOW_LONGLONG;
+    var->value = buff;
+    return 0;
+}
+
+/*
+  Write the contents of a cache to wsrep provider.
+
+  This version does not read the cache at all: the part of the transaction
+  which was already spilled to the temporary file is mapped read-only and
+  the part which is still in the cache buffer is referenced in place. Both
+  segments are then appended to a writeset with a single append_data() call.
+
+  Cache buffer is reused by binlog write later in the commit and the file is
+  truncated when the cache is reset, so provider is still asked to take its
+  own copy of the data.
+
+  Returns -1 if the cache is not in the state which allows direct access,
+  caller should fall back to reading the cache then.
+ */
+static int wsrep_write_cache_zero_copy(wsrep_t*  const wsrep,
+                                       THD*      const thd,
+                                       IO_CACHE* const cache,
+                                       my_off_t  const from,
+                                       size_t*   const len)
+{
+    if (cache->type != WRITE_CACHE ||
+        (cache->pos_in_file > from && cache->file < 0))
+    {
+        return -1;
+    }
+
+    /* file segment [from, pos_in_file) is mapped from a page boundary */
+    size_t const map_offset(from < cache->pos_in_file ?
+                            from - from % my_getpagesize() : 0);
+    size_t const file_length(from < cache->pos_in_file ?
+                             cache->pos_in_file - from : 0);
+    size_t const map_length(file_length > 0 ?
+                            cache->pos_in_file - map_offset : 0);
+    size_t const buf_skip(from > cache->pos_in_file ?
+                          from - cache->pos_in_file : 0);
+    size_t const buf_length(cache->write_pos - cache->write_buffer - buf_skip);
+    size_t const total_length(from + file_length + buf_length);
+
+    if (unlikely(total_length > wsrep_max_ws_size))
+    {
+        WSREP_WARN("transaction size limit (%lu) exceeded: %zu",
+                   wsrep_max_ws_size, total_length);
+        return WSREP_TRX_SIZE_EXCEEDED;
+    }
+
+    struct wsrep_buf bufs[2];
+    size_t           bufs_num(0);
+    uchar*           map(NULL);
+    int              err(WSREP_OK);
+
+    if (file_length > 0)
+    {
+        map= (uchar*)my_mmap(0, map_length, PROT_READ, MAP_SHARED,
+                             cache->file, map_offset);
+        if (map == (uchar*)MAP_FAILED)
+        {
+            WSREP_DEBUG("failed to map binlog cache file: %d (%s), "
+                        "falling back to buffered read",
+                        errno, strerror(errno));
+            return -1;
+        }
+        bufs[bufs_num].ptr= map + (from - map_offset);
+        bufs[bufs_num].len= file_length;
+        bufs_num++;
+    }
+
+    if (buf_length > 0)
+    {
+        bufs[bufs_num].ptr= cache->write_buffer + buf_skip;
+        bufs[bufs_num].len= buf_length;
+        bufs_num++;
+    }
+
+    if (bufs_num > 0)
+    {
+        err= wsrep->append_data(wsrep, &thd->wsrep_ws_handle, bufs, bufs_num,
+                                WSREP_DATA_ORDERED, true);
+        if (err != WSREP_OK)
+        {
+            WSREP_WARN("append_data() returned %d", err);
+        }
+    }
+
+    if (map) my_munmap(map, map_length);
+
+    if (WSREP_OK == err)
+    {
+        *len= total_length;
+        my_atomic_add64(&wsrep_zero_copy_bytes, total_length - from);
+    }
+    else
+    {
+        wsrep_dump_rbr_direct(thd, cache);
+    }
+
+    return err;
+}
+
 /*
   Write the contents of a cache to wsrep provider.
 
@@ -293,14 +405,71 @@ int wsrep_write_cache(wsrep_t*  const wsrep,
                       IO_CACHE* const cache,
                       size_t*   const len)
 {
+    /* part of the cache may have been appended already */
+    my_off_t const from(thd->wsrep_cache_chunk_pos);
+
+    if (wsrep_zero_copy_data_collection) {
+        int const err(wsrep_write_cache_zero_copy(wsrep, thd, cache, from,
+                                                  len));
+        if (err != -1) return err;
+    }
+
     if (wsrep_incremental_data_collection) {
-        return wsrep_write_cache_inc(wsrep, thd, cache, len);
+        return wsrep_write_cache_inc(wsrep, thd, cache, from, len);
     }
     else {
-        return wsrep_write_cache_once(wsrep, thd, cache, len);
+        return wsrep_write_cache_once(wsrep, thd, cache, from, len);
     }
 }
 
+/* total number of binlog cache chunks appended before commit */
+long long wsrep_cache_chunks_appended= 0;
+
+int wsrep_show_cache_chunks(THD *thd, SHOW_VAR *var, char *buff)
+{
+    *(long long *)buff= my_atomic_load64(&wsrep_cache_chunks_appended);
+    var->type = SHOW_LONGLONG;
+    var->value = buff;
+    return 0;
+}
+
+/*
+  Append the part of the transaction cache written since the previous
+  chunk to the local writeset, once it has grown to
+  wsrep_append_cache_chunk_size.
+
+  Called at the end of a statement of a multi statement transaction, so
+  that the cache is read and copied to provider while the transaction is
+  still executing rather than all at once at commit. The writeset is
+  still replicated only at commit. Nothing is appended while the
+  transaction has savepoints, as rolling back to one could truncate the
+  cache below data already appended.
+ */
+int wsrep_append_cache_chunk(wsrep_t*  const wsrep,
+                             THD*      const thd,
+                             IO_CACHE* const cache)
+{
+    if (wsrep_append_cache_chunk_size == 0 || thd->transaction.savepoints ||
+        thd->wsrep_ws_handle.trx_id == WSREP_UNDEFINED_TRX_ID)
+        return WSREP_OK;
+
+    thd->binlog_flush_pending_rows_event(true);
+
+    my_off_t const pos(my_b_tell(cache));
+    if (pos < thd->wsrep_cache_chunk_pos + wsrep_append_cache_chunk_size)
+        return WSREP_OK;
+
+    size_t len(0);
+    int const err(wsrep_write_cache(wsrep, thd, cache, &len));
+    if (WSREP_OK == err)
+    {
+        DBUG_ASSERT(len == pos);
+        thd->wsrep_cache_chunk_pos= pos;
+        my_atomic_add64(&wsrep_cache_chunks_appended, 1);
+    }
+    return err;
+}
+
 void wsrep_dump_rbr_buf(THD *thd, const void* rbr_buf, size_t buf_len)
 {
   char filename[PATH_MAX]= {0};
@@ -43,6 +43,25 @@ int wsrep_write_cache (wsrep_t*  wsrep,
                        IO_CACHE* cache,
                        size_t*   len);
 
+/*
+  Append the part of a cache written since the previous chunk to the
+  local writeset, if it is at least wsrep_append_cache_chunk_size bytes.
+  Nothing is replicated before commit.
+
+  @return     wsrep error status
+ */
+int wsrep_append_cache_chunk(wsrep_t*  wsrep,
+                             THD*      thd,
+                             IO_CACHE* cache);
+
+/* Number of binlog cache chunks appended to writesets before commit */
+extern long long wsrep_cache_chunks_appended;
+int wsrep_show_cache_chunks(THD *thd, SHOW_VAR *var, char *buff);
+
+/* Number of bytes appended to writesets directly from binlog cache */
+extern long long wsrep_zero_copy_bytes;
+int wsrep_show_zero_copy_bytes(THD *thd, SHOW_VAR *var, char *buff);
+
 /* Dump replication buffer to disk */
 void wsrep_dump_rbr_buf(THD *thd, const void* rbr_buf, size_t buf_len);
 
@@ -313,25 +313,28 @@ check_opts (int const argc, const char* const argv[], struct opt opts[])
         rcode = EINVAL;
     }
 
-    if (!strcasecmp(opts[WSREP_SST_METHOD].value,"mysqldump"))
+    if (!strcasecmp(opts[WSREP_SST_METHOD].value,"mysqldump") ||
+        !strcasecmp(opts[WSREP_SST_METHOD].value,"binlog"))
     {
         if (!strcasecmp(opts[BIND_ADDRESS].value, "127.0.0.1") ||
             !strcasecmp(opts[BIND_ADDRESS].value, "localhost"))
         {
-            WSREP_ERROR ("wsrep_sst_method is set to 'mysqldump' yet "
+            WSREP_ERROR ("wsrep_sst_method is set to '%s' yet "
                          "mysqld bind_address is set to '%s', which makes it "
                          "impossible to receive state transfer from another "
                          "node, since mysqld won't accept such connections. "
-                         "If you wish to use mysqldump state transfer method, "
+                         "If you wish to use %s state transfer method, "
                          "set bind_address to allow mysql client connections "
                          "from other cluster members (e.g. 0.0.0.0).",
-                         opts[BIND_ADDRESS].value);
+                         opts[WSREP_SST_METHOD].value,
+                         opts[BIND_ADDRESS].value,
+                         opts[WSREP_SST_METHOD].value);
             rcode = EINVAL;
         }
     }
     else
     {
-        // non-mysqldump SST requires wsrep_cluster_address on startup
+        // other SST methods require wsrep_cluster_address on startup
         if (strlen(opts[WSREP_CLUSTER_ADDRESS].value) == 0)
         {
             WSREP_ERROR ("%s SST method requires wsrep_cluster_address to be "
@@ -0,0 +1,288 @@
+/* Copyright (C) 2013 Codership Oy <info@codership.com>
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA. */
+
+#include "wsrep_conflict_stats.h"
+#include "wsrep_mysqld.h"
+#include "sql_class.h"
+#include "sql_show.h"   // schema_table_store_record()
+#include "sql_table.h"  // filename_to_tablename()
+#include "sql_acl.h"    // PROCESS_ACL
+#include "sql_parse.h"  // check_global_access()
+#include "my_murmur3.h"
+#include <hash.h>
+
+#define WSREP_CONFLICT_STATS_SHARDS 16
+
+/* counters of one table and index, key is "db\0table\0index\0" */
+struct conflict_entry
+{
+  uchar*    key;
+  size_t    key_len;
+  ulonglong count[WSREP_CONFLICT_TYPES];
+  ulonglong usec[WSREP_CONFLICT_TYPES];
+};
+
+struct conflict_shard
+{
+  mysql_mutex_t lock;
+  HASH          entries;
+};
+
+static conflict_shard shards[WSREP_CONFLICT_STATS_SHARDS];
+static bool           stats_inited= false;
+
+static uchar* conflict_entry_key(const uchar* record, size_t* length,
+                                 my_bool not_used MY_ATTRIBUTE((unused)))
+{
+  const conflict_entry* e= (const conflict_entry*) record;
+  *length= e->key_len;
+  return e->key;
+}
+
+static void conflict_entry_free(void* record)
+{
+  my_free(record);
+}
+
+/* appends str (up to NAME_LEN bytes) and terminating '\0' to key */
+static size_t conflict_key_part(char* key, size_t len, const char* str,
+                                size_t str_len)
+{
+  str_len= MY_MIN(str_len, NAME_LEN);
+  memcpy(key + len, str, str_len);
+  key[len + str_len]= '\0';
+  return len + str_len + 1;
+}
+
+static void conflict_stats_add(const char* key, size_t key_len,
+                               enum wsrep_conflict_type type,
+                               ulonglong usec)
+{
+  if (!stats_inited || !key_len) return;
+
+  uint32 const    h= murmur3_32((const uchar*) key, key_len, 0);
+  conflict_shard* shard= &shards[h % WSREP_CONFLICT_STATS_SHARDS];
+
+  mysql_mutex_lock(&shard->lock);
+  conflict_entry* e= (conflict_entry*)
+    my_hash_search(&shard->entries, (const uchar*) key, key_len);
+  if (!e)
+  {
+    e= (conflict_entry*) my_malloc(sizeof(conflict_entry) + key_len,
+                                   MYF(MY_WME | MY_ZEROFILL));
+    if (!e)
+    {
+      mysql_mutex_unlock(&shard->lock);
+      return;
+    }
+    e->key=     (uchar*) (e + 1);
+    e->key_len= key_len;
+    memcpy(e->key, key, key_len);
+    if (my_hash_insert(&shard->entries, (uchar*) e))
+    {
+      my_free(e);
+      mysql_mutex_unlock(&shard->lock);
+      return;
+    }
+  }
+  e->count[type]++;
+  e->usec[type]+= usec;
+  mysql_mutex_unlock(&shard->lock);
+}
+
+void wsrep_conflict_stats_note(THD* thd, const TABLE_SHARE* share,
+                               const char* index)
+{
+  if (thd->wsrep_conflict_key_len) return;
+
+  /* BF aborter may read the key concurrently */
+  mysql_mutex_lock(&thd->LOCK_wsrep_thd);
+  size_t len= 0;
+  len= conflict_key_part(thd->wsrep_conflict_key, len,
+                         share->db.str, share->db.length);
+  len= conflict_key_part(thd->wsrep_conflict_key, len,
+                         share->table_name.str, share->table_name.length);
+  len= conflict_key_part(thd->wsrep_conflict_key, len,
+                         index, strlen(index));
+  thd->wsrep_conflict_key_len= len;
+  thd->wsrep_conflict_start=   my_micro_time();
+  mysql_mutex_unlock(&thd->LOCK_wsrep_thd);
+}
+
+static ulonglong conflict_elapsed(ulonglong since)
+{
+  ulonglong const now= my_micro_time();
+  return (now > since) ? now - since : 0;
+}
+
+void wsrep_conflict_stats_add(THD* thd, enum wsrep_conflict_type type,
+                              ulonglong since)
+{
+  uint const len= thd->wsrep_conflict_key_len;
+  if (!len) return;
+  conflict_stats_add(thd->wsrep_conflict_key, len, type,
+                     conflict_elapsed(since ? since :
+                                      thd->wsrep_conflict_start));
+}
+
+void wsrep_conflict_stats_bf_abort(THD* victim, const char* name,
+                                   const char* index)
+{
+  mysql_mutex_assert_owner(&victim->LOCK_wsrep_thd);
+
+  uint const      len= victim->wsrep_conflict_key_len;
+  ulonglong const usec= len ?
+    conflict_elapsed(victim->wsrep_conflict_start) : 0;
+  const char*     slash= name ? strchr(name, '/') : NULL;
+
+  if (!slash || !index)
+  {
+    if (len)
+      conflict_stats_add(victim->wsrep_conflict_key, len,
+                         WSREP_CONFLICT_BF_ABORT, usec);
+    return;
+  }
+
+  char   db_buf[FN_REFLEN];
+  char   table_buf[FN_REFLEN];
+  size_t db_len= MY_MIN((size_t) (slash - name), sizeof(db_buf) - 1);
+  memcpy(db_buf, name, db_len);
+  db_buf[db_len]= '\0';
+
+  char   key[3 * (NAME_LEN + 1)];
+  size_t key_len= 0;
+  uint   n= filename_to_tablename(db_buf, table_buf, sizeof(table_buf), true);
+  key_len= conflict_key_part(key, key_len, table_buf, n);
+  n= filename_to_tablename(slash + 1, table_buf, sizeof(table_buf), true);
+  key_len= conflict_key_part(key, key_len, table_buf, n);
+  key_len= conflict_key_part(key, key_len, index, strlen(index));
+
+  conflict_stats_add(key, key_len, WSREP_CONFLICT_BF_ABORT, usec);
+}
+
+/*
+  INFORMATION_SCHEMA.WSREP_CONFLICT_STATS
+*/
+
+static ST_FIELD_INFO conflict_stats_fields[]=
+{
+  {"TABLE_SCHEMA", NAME_CHAR_LEN, MYSQL_TYPE_STRING, 0, 0, 0,
+   SKIP_OPEN_TABLE},
+  {"TABLE_NAME", NAME_CHAR_LEN, MYSQL_TYPE_STRING, 0, 0, 0,
+   SKIP_OPEN_TABLE},
+  {"INDEX_NAME", NAME_CHAR_LEN, MYSQL_TYPE_STRING, 0, 0, 0,
+   SKIP_OPEN_TABLE},
+  {"CERT_FAILURES", MY_INT64_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONGLONG, 0,
+   MY_I_S_UNSIGNED, 0, SKIP_OPEN_TABLE},
+  {"CERT_FAILURES_USEC", MY_INT64_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONGLONG, 0,
+   MY_I_S_UNSIGNED, 0, SKIP_OPEN_TABLE},
+  {"BF_ABORTS", MY_INT64_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONGLONG, 0,
+   MY_I_S_UNSIGNED, 0, SKIP_OPEN_TABLE},
+  {"BF_ABORTS_USEC", MY_INT64_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONGLONG, 0,
+   MY_I_S_UNSIGNED, 0, SKIP_OPEN_TABLE},
+  {"REPLAYS", MY_INT64_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONGLONG, 0,
+   MY_I_S_UNSIGNED, 0, SKIP_OPEN_TABLE},
+  {"REPLAYS_USEC", MY_INT64_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONGLONG, 0,
+   MY_I_S_UNSIGNED, 0, SKIP_OPEN_TABLE},
+  {0, 0, MYSQL_TYPE_NULL, 0, 0, 0, SKIP_OPEN_TABLE}
+};
+
+static int conflict_stats_fill(THD* thd, TABLE_LIST* tables, Item* cond)
+{
+  DBUG_ENTER("conflict_stats_fill");
+
+  /* deny access to non-superusers */
+  if (check_global_access(thd, PROCESS_ACL)) DBUG_RETURN(0);
+
+  TABLE*         table= tables->table;
+  CHARSET_INFO*  cs= system_charset_info;
+  DYNAMIC_ARRAY  snapshot;
+  int            ret= 0;
+
+  if (my_init_dynamic_array(&snapshot, sizeof(conflict_entry), 64, 64))
+    DBUG_RETURN(1);
+
+  for (uint i= 0; i < WSREP_CONFLICT_STATS_SHARDS && !ret; ++i)
+  {
+    conflict_shard* shard= &shards[i];
+
+    /* copy counters out, so that conflicts don't wait for the client */
+    reset_dynamic(&snapshot);
+    mysql_mutex_lock(&shard->lock);
+    for (ulong j= 0; j < shard->entries.records; ++j)
+    {
+      if (insert_dynamic(&snapshot, my_hash_element(&shard->entries, j)))
+      {
+        ret= 1;
+        break;
+      }
+    }
+    mysql_mutex_unlock(&shard->lock);
+
+    for (uint j= 0; j < snapshot.elements && !ret; ++j)
+    {
+      /* entries are never freed before shutdown, key stays valid */
+      const conflict_entry* e= dynamic_element(&snapshot, j, conflict_entry*);
+      const char* db=    (const char*) e->key;
+      const char* name=  db + strlen(db) + 1;
+      const char* index= name + strlen(name) + 1;
+
+      table->field[0]->store(db, strlen(db), cs);
+      table->field[1]->store(name, strlen(name), cs);
+      table->field[2]->store(index, strlen(index), cs);
+      table->field[3]->store(e->count[WSREP_CONFLICT_CERT], true);
+      table->field[4]->store(e->usec[WSREP_CONFLICT_CERT], true);
+      table->field[5]->store(e->count[WSREP_CONFLICT_BF_ABORT], true);
+      table->field[6]->store(e->usec[WSREP_CONFLICT_BF_ABORT], true);
+      table->field[7]->store(e->count[WSREP_CONFLICT_REPLAY], true);
+      table->field[8]->store(e->usec[WSREP_CONFLICT_REPLAY], true);
+
+      if (schema_table_store_record(thd, table)) ret= 1;
+    }
+  }
+
+  delete_dynamic(&snapshot);
+  DBUG_RETURN(ret);
+}
+
+int wsrep_conflict_stats_init(void* p)
+{
+  ST_SCHEMA_TABLE* schema= (ST_SCHEMA_TABLE*) p;
+  schema->fields_info= conflict_stats_fields;
+  schema->fill_table=  conflict_stats_fill;
+
+  for (uint i= 0; i < WSREP_CONFLICT_STATS_SHARDS; ++i)
+  {
+    mysql_mutex_init(key_LOCK_wsrep_conflict_stats, &shards[i].lock,
+                     MY_MUTEX_INIT_FAST);
+    if (my_hash_init(&shards[i].entries, &my_charset_bin, 64, 0, 0,
+                     conflict_entry_key, conflict_entry_free, 0))
+      return 1;
+  }
+  stats_inited= true;
+  return 0;
+}
+
+int wsrep_conflict_stats_deinit(void* p)
+{
+  if (!stats_inited) return 0;
+  stats_inited= false;
+  for (uint i= 0; i < WSREP_CONFLICT_STATS_SHARDS; ++i)
+  {
+    my_hash_free(&shards[i].entries);
+    mysql_mutex_destroy(&shards[i].lock);
+  }
+  return 0;
+}
@@ -0,0 +1,73 @@
+/* Copyright (C) 2013 Codership Oy <info@codership.com>
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA. */
+
+#ifndef WSREP_CONFLICT_STATS_H
+#define WSREP_CONFLICT_STATS_H
+
+#include <my_global.h>
+
+/*
+  Per table and index counters of replication conflicts, shown in
+  INFORMATION_SCHEMA.WSREP_CONFLICT_STATS.
+
+  Local transaction remembers the table and index of the first row it
+  writes. Certification failures and replays are accounted to that table,
+  BF aborts to the index of the conflicting lock when it is known. Time
+  is the work lost by the victim: from the first write until the abort,
+  or the time spent replaying.
+
+  Counters live in a fixed number of shards, each with its own mutex and
+  hash, so that conflicts on different tables don't contend.
+*/
+
+class THD;
+struct TABLE_SHARE;
+
+enum wsrep_conflict_type
+{
+  WSREP_CONFLICT_CERT= 0,
+  WSREP_CONFLICT_BF_ABORT,
+  WSREP_CONFLICT_REPLAY,
+  WSREP_CONFLICT_TYPES
+};
+
+/* information schema plugin init and deinit */
+int wsrep_conflict_stats_init(void* p);
+int wsrep_conflict_stats_deinit(void* p);
+
+/*!
+  Remember table and index of the first row written by the current
+  transaction of thd. Cheap if already done for this transaction.
+*/
+void wsrep_conflict_stats_note(THD* thd, const TABLE_SHARE* share,
+                               const char* index);
+
+/*!
+  Account conflict of the given type to the table remembered for thd.
+  Time cost is from since (my_micro_time()) until now, or from the first
+  write of the transaction if since is 0.
+*/
+void wsrep_conflict_stats_add(THD* thd, enum wsrep_conflict_type type,
+                              ulonglong since);
+
+/*!
+  Account BF abort of victim to InnoDB table name ("db/table") and index,
+  or to the table remembered for victim if name is NULL. Must be called
+  under victim->LOCK_wsrep_thd.
+*/
+void wsrep_conflict_stats_bf_abort(THD* victim, const char* name,
+                                   const char* index);
+
+#endif /* WSREP_CONFLICT_STATS_H */
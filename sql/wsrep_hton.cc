@@ -20,7 +20,10 @@
 #include <sql_class.h>
 #include "wsrep_mysqld.h"
 #include "wsrep_binlog.h"
+#include "wsrep_applier.h"
 #include "wsrep_xid.h"
+#include "wsrep_conflict_stats.h"
+#include "wsrep_notify.h"
 #include <cstdio>
 #include <cstdlib>
 #include "debug_sync.h"
@@ -47,6 +50,11 @@ void wsrep_cleanup_transaction(THD *thd)
   thd->wsrep_exec_mode= LOCAL_STATE;
   thd->wsrep_affected_rows= 0;
   thd->wsrep_skip_wsrep_GTID= false;
+  thd->wsrep_conflict_key_len= 0;
+  thd->wsrep_ws_deps= 0;
+  thd->wsrep_hash_keys_saved= 0;
+  wsrep_clear_row_keys(thd);
+  thd->wsrep_cache_chunk_pos= 0;
   return;
 }
 
@@ -193,6 +201,19 @@ static int wsrep_prepare(handlerton *hton, THD *thd, bool all)
   {
     DBUG_RETURN (wsrep_run_wsrep_commit(thd, hton, all));
   }
+  /* end of statement in a multi statement transaction */
+  if (wsrep_flush_row_keys(thd))
+  {
+    WSREP_ERROR("appending buffered row keys failed: %s", WSREP_QUERY(thd));
+    DBUG_RETURN(WSREP_TRX_ERROR);
+  }
+  IO_CACHE* cache= get_trans_log(thd);
+  if (thd->variables.wsrep_on && cache &&
+      wsrep_append_cache_chunk(wsrep, thd, cache))
+  {
+    WSREP_ERROR("rbr chunk append fail: %s", WSREP_QUERY(thd));
+    DBUG_RETURN(WSREP_TRX_SIZE_EXCEEDED);
+  }
   DBUG_RETURN(0);
 }
 
@@ -420,6 +441,13 @@ wsrep_run_wsrep_commit(THD *thd, handlerton *hton, bool all)
   thd->wsrep_query_state = QUERY_COMMITTING;
   mysql_mutex_unlock(&thd->LOCK_wsrep_thd);
 
+  rcode = wsrep_flush_row_keys(thd);
+  if (WSREP_OK != rcode) {
+    WSREP_ERROR("appending buffered row keys failed: %s, %d",
+                WSREP_QUERY(thd), rcode);
+    DBUG_RETURN(WSREP_TRX_ERROR);
+  }
+
   cache = get_trans_log(thd);
   rcode = 0;
   if (cache) {
@@ -470,6 +498,8 @@ wsrep_run_wsrep_commit(THD *thd, handlerton *hton, bool all)
   }
   else if (!rcode)
   {
+    wsrep_ws_deps_commit(thd);
+    wsrep_hash_keys_commit(thd);
     if (WSREP_OK == rcode)
       rcode = wsrep->pre_commit(wsrep,
                                 (wsrep_conn_id_t)thd->thread_id,
@@ -491,6 +521,8 @@ wsrep_run_wsrep_commit(THD *thd, handlerton *hton, bool all)
       thd->wsrep_conflict_state = MUST_REPLAY;
       DBUG_ASSERT(wsrep_thd_trx_seqno(thd) > 0);
       mysql_mutex_unlock(&thd->LOCK_wsrep_thd);
+      /* decode the write set while waiting for the turn to replay */
+      (void)wsrep_replay_snapshot(thd, cache);
       mysql_mutex_lock(&LOCK_wsrep_replaying);
       wsrep_replaying++;
       WSREP_DEBUG("replaying increased: %d, thd: %lu",
@@ -559,6 +591,7 @@ wsrep_run_wsrep_commit(THD *thd, handlerton *hton, bool all)
       {
         thd->wsrep_conflict_state = CERT_FAILURE;
         WSREP_LOG_CONFLICT(NULL, thd, FALSE);
+        wsrep_conflict_stats_add(thd, WSREP_CONFLICT_CERT, 0);
       }
     }
     mysql_mutex_unlock(&thd->LOCK_wsrep_thd);
@@ -640,6 +673,12 @@ static int wsrep_hton_init(void *p)
 struct st_mysql_storage_engine wsrep_storage_engine=
 { MYSQL_HANDLERTON_INTERFACE_VERSION };
 
+struct st_mysql_information_schema wsrep_conflict_stats_info=
+{ MYSQL_INFORMATION_SCHEMA_INTERFACE_VERSION };
+
+struct st_mysql_information_schema wsrep_membership_events_info=
+{ MYSQL_INFORMATION_SCHEMA_INTERFACE_VERSION };
+
 
 mysql_declare_plugin(wsrep)
 {
@@ -657,5 +696,35 @@ mysql_declare_plugin(wsrep)
   NULL,                       /* system variables                */
   NULL,                       /* config options                  */
   0,                          /* flags                           */
+},
+{
+  MYSQL_INFORMATION_SCHEMA_PLUGIN,
+  &wsrep_conflict_stats_info,
+  "WSREP_CONFLICT_STATS",
+  "Codership Oy",
+  "Replication conflicts per table and index",
+  PLUGIN_LICENSE_GPL,
+  wsrep_conflict_stats_init,   /* Plugin Init */
+  wsrep_conflict_stats_deinit, /* Plugin Deinit */
+  0x0100 /* 1.0 */,
+  NULL,                       /* status variables                */
+  NULL,                       /* system variables                */
+  NULL,                       /* config options                  */
+  0,                          /* flags                           */
+},
+{
+  MYSQL_INFORMATION_SCHEMA_PLUGIN,
+  &wsrep_membership_events_info,
+  "WSREP_MEMBERSHIP_EVENTS",
+  "Codership Oy",
+  "Recent node status and membership changes",
+  PLUGIN_LICENSE_GPL,
+  wsrep_membership_events_init,   /* Plugin Init */
+  wsrep_membership_events_deinit, /* Plugin Deinit */
+  0x0100 /* 1.0 */,
+  NULL,                       /* status variables                */
+  NULL,                       /* system variables                */
+  NULL,                       /* config options                  */
+  0,                          /* flags                           */
 }
 mysql_declare_plugin_end;
@@ -0,0 +1,216 @@
+/* Copyright 2013 Codership Oy <http://www.codership.com>
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+
+#include "wsrep_key_buffer.h"
+#include "wsrep_mysqld.h"
+#include "sql_class.h"
+#include "my_murmur3.h"
+
+/* db, table and key value, see wsrep_prepare_key_for_innodb() */
+#define WSREP_KEY_PARTS_MAX 3
+
+Wsrep_key_buffer::Wsrep_key_buffer(size_t capacity)
+  : capacity_(capacity), count_(0), flushed_(0), mask_(0),
+    entries_(0), parts_(0), batch_(0), slots_(0)
+{
+  size_t slots= 2;
+  while (slots < 2 * capacity_) slots <<= 1;
+  mask_= slots - 1;
+
+  entries_= (entry*) my_malloc(capacity_ * sizeof(entry), MYF(MY_WME));
+  parts_=   (wsrep_buf_t*) my_malloc(capacity_ * WSREP_KEY_PARTS_MAX *
+                                     sizeof(wsrep_buf_t), MYF(MY_WME));
+  batch_=   (wsrep_key_t*) my_malloc(capacity_ * sizeof(wsrep_key_t),
+                                     MYF(MY_WME));
+  slots_=   (uint32*) my_malloc(slots * sizeof(uint32),
+                                MYF(MY_WME | MY_ZEROFILL));
+  if (!entries_ || !parts_ || !batch_ || !slots_)
+    capacity_= 0; /* every append goes straight to provider */
+
+  init_alloc_root(&mem_root_, 8192, 0);
+}
+
+Wsrep_key_buffer::~Wsrep_key_buffer()
+{
+  free_root(&mem_root_, MYF(0));
+  my_free(slots_);
+  my_free(batch_);
+  my_free(parts_);
+  my_free(entries_);
+}
+
+uint32 Wsrep_key_buffer::hash(const wsrep_key_t* key, bool shared)
+{
+  uint32 h= shared;
+  for (size_t i= 0; i < key->key_parts_num; ++i)
+  {
+    const wsrep_buf_t* part= &key->key_parts[i];
+    h= murmur3_32((const uchar*) part->ptr, part->len, h);
+  }
+  return h;
+}
+
+bool Wsrep_key_buffer::equal(const wsrep_key_t* a, const wsrep_key_t* b)
+{
+  if (a->key_parts_num != b->key_parts_num) return false;
+  for (size_t i= 0; i < a->key_parts_num; ++i)
+  {
+    const wsrep_buf_t* pa= &a->key_parts[i];
+    const wsrep_buf_t* pb= &b->key_parts[i];
+    if (pa->len != pb->len || memcmp(pa->ptr, pb->ptr, pa->len))
+      return false;
+  }
+  return true;
+}
+
+bool Wsrep_key_buffer::store(const wsrep_key_t* key, bool shared,
+                             uint32 hash, size_t slot)
+{
+  size_t key_len= 0;
+  for (size_t i= 0; i < key->key_parts_num; ++i)
+    key_len+= key->key_parts[i].len;
+
+  uchar* buf= (uchar*) alloc_root(&mem_root_, key_len ? key_len : 1);
+  if (!buf) return true;
+
+  entry*       e= &entries_[count_];
+  wsrep_buf_t* parts= &parts_[count_ * WSREP_KEY_PARTS_MAX];
+  for (size_t i= 0; i < key->key_parts_num; ++i)
+  {
+    memcpy(buf, key->key_parts[i].ptr, key->key_parts[i].len);
+    parts[i].ptr= buf;
+    parts[i].len= key->key_parts[i].len;
+    buf+= parts[i].len;
+  }
+  e->key.key_parts=     parts;
+  e->key.key_parts_num= key->key_parts_num;
+  e->hash=              hash;
+  e->shared=            shared;
+
+  slots_[slot]= ++count_;
+  return false;
+}
+
+wsrep_status_t
+Wsrep_key_buffer::append(THD* thd, const wsrep_key_t* key, bool shared)
+{
+  if (key->key_parts_num > WSREP_KEY_PARTS_MAX || capacity_ == 0)
+  {
+    return wsrep->append_key(wsrep, &thd->wsrep_ws_handle, key, 1,
+                             shared ? WSREP_KEY_SHARED : WSREP_KEY_EXCLUSIVE,
+                             true);
+  }
+
+  uint32 const h= hash(key, shared);
+  size_t       slot= h & mask_;
+
+  for (; slots_[slot]; slot= (slot + 1) & mask_)
+  {
+    const entry* e= &entries_[slots_[slot] - 1];
+    if (e->hash == h && e->shared == shared && equal(&e->key, key))
+      return WSREP_OK;
+  }
+
+  if (count_ == capacity_)
+  {
+    wsrep_status_t rcode= flush(thd);
+    if (rcode != WSREP_OK) return rcode;
+    clear();
+    slot= h & mask_;
+  }
+
+  if (store(key, shared, h, slot))
+  {
+    /* out of memory, let provider keep its own copy */
+    return wsrep->append_key(wsrep, &thd->wsrep_ws_handle, key, 1,
+                             shared ? WSREP_KEY_SHARED : WSREP_KEY_EXCLUSIVE,
+                             true);
+  }
+  return WSREP_OK;
+}
+
+wsrep_status_t Wsrep_key_buffer::flush(THD* thd)
+{
+  for (int shared= 0; shared <= 1; ++shared)
+  {
+    size_t n= 0;
+    for (size_t i= flushed_; i < count_; ++i)
+    {
+      if (entries_[i].shared == (bool) shared)
+        batch_[n++]= entries_[i].key;
+    }
+    if (n == 0) continue;
+
+    wsrep_status_t rcode=
+      wsrep->append_key(wsrep, &thd->wsrep_ws_handle, batch_, n,
+                        shared ? WSREP_KEY_SHARED : WSREP_KEY_EXCLUSIVE,
+                        true);
+    if (rcode != WSREP_OK) return rcode;
+  }
+  flushed_= count_;
+  return WSREP_OK;
+}
+
+void Wsrep_key_buffer::clear()
+{
+  if (count_ == 0) return;
+  for (size_t i= 0; i <= mask_; ++i) slots_[i]= 0;
+  count_= flushed_= 0;
+  free_root(&mem_root_, MYF(MY_KEEP_PREALLOC));
+}
+
+int wsrep_append_row_key(THD* thd, const wsrep_key_t* key, bool shared)
+{
+  Wsrep_key_buffer* buffer= (Wsrep_key_buffer*) thd->wsrep_key_buffer;
+  size_t const capacity= wsrep_key_batch_size;
+
+  /* resize only between transactions */
+  if (buffer && buffer->empty() && buffer->capacity() != capacity)
+  {
+    delete buffer;
+    thd->wsrep_key_buffer= buffer= NULL;
+  }
+
+  if (!buffer)
+  {
+    if (capacity == 0)
+    {
+      return wsrep->append_key(wsrep, &thd->wsrep_ws_handle, key, 1,
+                               shared ? WSREP_KEY_SHARED : WSREP_KEY_EXCLUSIVE,
+                               true);
+    }
+    thd->wsrep_key_buffer= buffer= new Wsrep_key_buffer(capacity);
+  }
+
+  return buffer->append(thd, key, shared);
+}
+
+int wsrep_flush_row_keys(THD* thd)
+{
+  Wsrep_key_buffer* buffer= (Wsrep_key_buffer*) thd->wsrep_key_buffer;
+  return buffer ? buffer->flush(thd) : WSREP_OK;
+}
+
+void wsrep_clear_row_keys(THD* thd)
+{
+  Wsrep_key_buffer* buffer= (Wsrep_key_buffer*) thd->wsrep_key_buffer;
+  if (buffer) buffer->clear();
+}
+
+void wsrep_free_row_keys(THD* thd)
+{
+  delete (Wsrep_key_buffer*) thd->wsrep_key_buffer;
+  thd->wsrep_key_buffer= NULL;
+}
@@ -0,0 +1,81 @@
+/* Copyright 2013 Codership Oy <http://www.codership.com>
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+
+#ifndef WSREP_KEY_BUFFER_H
+#define WSREP_KEY_BUFFER_H
+
+#include "my_global.h"
+#include "my_sys.h"
+#include "../wsrep/wsrep_api.h"
+
+class THD;
+
+/*
+  Certification keys appended by a local transaction, collected so that
+  they can be passed to the provider in one append_key() call per key
+  type instead of one call per row.
+
+  Keys are deduplicated on the way in with a small open addressing hash
+  table. Flushed keys stay in the table until the buffer fills up, so
+  that rows touched by several statements of a transaction are only
+  appended once.
+*/
+class Wsrep_key_buffer
+{
+public:
+  explicit Wsrep_key_buffer(size_t capacity);
+  ~Wsrep_key_buffer();
+
+  size_t capacity() const { return capacity_; }
+  bool   empty()    const { return count_ == 0; }
+
+  /* buffer a copy of key, flushing first if the buffer is full */
+  wsrep_status_t append(THD* thd, const wsrep_key_t* key, bool shared);
+
+  /* pass keys appended since the previous flush to the provider */
+  wsrep_status_t flush(THD* thd);
+
+  /* forget all keys, flushed or not */
+  void clear();
+
+private:
+  struct entry
+  {
+    wsrep_key_t key;
+    uint32      hash;
+    bool        shared;
+  };
+
+  static uint32 hash(const wsrep_key_t* key, bool shared);
+  static bool   equal(const wsrep_key_t* a, const wsrep_key_t* b);
+
+  bool          store(const wsrep_key_t* key, bool shared, uint32 hash,
+                      size_t slot);
+
+  size_t        capacity_;
+  size_t        count_;   /* keys buffered */
+  size_t        flushed_; /* keys already passed to provider */
+  size_t        mask_;    /* slots_ size - 1 */
+  entry*        entries_;
+  wsrep_buf_t*  parts_;   /* WSREP_KEY_PARTS_MAX per entry */
+  wsrep_key_t*  batch_;   /* append_key() argument */
+  uint32*       slots_;   /* entry index + 1, 0 if free */
+  MEM_ROOT      mem_root_;
+
+  Wsrep_key_buffer(const Wsrep_key_buffer&);
+  Wsrep_key_buffer& operator=(const Wsrep_key_buffer&);
+};
+
+#endif /* WSREP_KEY_BUFFER_H */
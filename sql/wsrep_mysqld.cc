@@ -26,6 +26,7 @@
 #include "wsrep_binlog.h"
 #include "wsrep_applier.h"
 #include "wsrep_xid.h"
+#include "wsrep_nbo.h"
 #include <cstdio>
 #include <cstdlib>
 #include "log_event.h"
@@ -52,6 +53,8 @@ ulong   wsrep_retry_autocommit         = 5; // retry aborted autocommit trx
 my_bool wsrep_auto_increment_control   = 1; // control auto increment variables
 my_bool wsrep_drupal_282555_workaround = 1; // retry autoinc insert after dupkey
 my_bool wsrep_incremental_data_collection = 0; // incremental data collection
+my_bool wsrep_zero_copy_data_collection = 0; // append binlog cache in place
+ulong   wsrep_append_cache_chunk_size  = 0; // append binlog cache in chunks
 ulong   wsrep_max_ws_size              = 1073741824UL;//max ws (RBR buffer) size
 ulong   wsrep_max_ws_rows              = 65536; // max number of rows in ws
 int     wsrep_to_isolation             = 0; // # of active TO isolation threads
@@ -71,6 +74,12 @@ my_bool wsrep_restart_slave_activated  = 0; // node has dropped, and slave
                                             // restart will be needed
 my_bool wsrep_slave_UK_checks          = 0; // slave thread does UK checks
 my_bool wsrep_slave_FK_checks          = 0; // slave thread does FK checks
+ulong   wsrep_rollbacker_threads       = 1; // # of BF abort rollbackers
+ulong   wsrep_applier_lookahead        = 0; // events decoded ahead of apply
+my_bool wsrep_hash_keys                = 0; // hash wide certification keys
+ulong   wsrep_key_batch_size           = 0; // row keys buffered per append
+ulong   wsrep_sync_wait_window         = 0; // usec to gather causal reads
+my_bool wsrep_pa_table_keys            = 0; // table keys for stmt events
 /*
  * End configuration options
  */
@@ -99,6 +108,7 @@ const char* wsrep_cluster_status = cluster_status_str[WSREP_VIEW_DISCONNECTED];
 long        wsrep_cluster_size       = 0;
 long        wsrep_local_index        = -1;
 long long   wsrep_local_bf_aborts    = 0;
+long long   wsrep_hash_keys_bytes_saved = 0;
 const char* wsrep_provider_name      = provider_name;
 const char* wsrep_provider_version   = provider_version;
 const char* wsrep_provider_vendor    = provider_vendor;
@@ -205,6 +215,8 @@ wsrep_view_handler_cb (void*                    app_ctx,
              (long long)wsrep_cluster_conf_id, wsrep_cluster_status,
              wsrep_cluster_size, wsrep_local_index, view->proto_ver);
 
+  wsrep_NBO_view_change(view);
+
   /* Proceed further only if view is PRIMARY */
   if (WSREP_VIEW_PRIMARY != view->status) {
     wsrep_ready_set(FALSE);
@@ -371,6 +383,26 @@ int wsrep_show_ready(THD *thd, SHOW_VAR *var, char *buff)
   return 0;
 }
 
+int wsrep_show_hash_keys_bytes_saved(THD *thd, SHOW_VAR *var, char *buff)
+{
+  var->type= SHOW_LONGLONG;
+  var->value= buff;
+  *((long long *)buff)= my_atomic_load64(&wsrep_hash_keys_bytes_saved);
+  return 0;
+}
+
+void wsrep_hash_keys_add(THD *thd, ulonglong bytes_saved)
+{
+  thd->wsrep_hash_keys_saved+= bytes_saved;
+}
+
+void wsrep_hash_keys_commit(THD *thd)
+{
+  if (thd->wsrep_hash_keys_saved)
+    my_atomic_add64(&wsrep_hash_keys_bytes_saved,
+                    (long long) thd->wsrep_hash_keys_saved);
+}
+
 // Wait until wsrep has reached ready state
 void wsrep_ready_wait ()
 {
@@ -810,6 +842,129 @@ bool wsrep_must_sync_wait (THD* thd, uint mask)
     thd->wsrep_sync_wait_gtid.seqno == WSREP_SEQNO_UNDEFINED;
 }
 
+/*
+  Concurrent sync waits share causal read barriers, like group commit:
+  a barrier which has not been sent to provider yet can be joined by any
+  number of sessions, one of which sends it and hands the resulting GTID
+  to the others. A session arriving while a barrier is in flight cannot
+  use it, as the barrier could have been ordered before the session's
+  own causal dependencies, so it waits for the next one.
+*/
+static ulonglong      sync_wait_sent=     0; /* last barrier sent */
+static ulonglong      sync_wait_done=     0; /* last barrier completed */
+static bool           sync_wait_leader=   false;
+static wsrep_status_t sync_wait_ret=      WSREP_OK;
+static wsrep_gtid_t   sync_wait_gtid=     WSREP_GTID_UNDEFINED;
+
+static volatile int64 sync_wait_issued=    0;
+static volatile int64 sync_wait_coalesced= 0;
+
+/* latency histogram bucket upper bounds, microseconds */
+static const ulonglong sync_wait_buckets[]=
+  { 100, 1000, 10000, 100000, 1000000 };
+#define SYNC_WAIT_BUCKETS (array_elements(sync_wait_buckets) + 1)
+static volatile int64 sync_wait_latency[SYNC_WAIT_BUCKETS];
+
+static wsrep_status_t wsrep_causal_read(wsrep_gtid_t* gtid)
+{
+  ulonglong const start= my_micro_time();
+  bool leader= false;
+
+  mysql_mutex_lock(&LOCK_wsrep_sync_wait);
+  ulonglong const barrier= sync_wait_sent + 1;
+
+  while (sync_wait_done < barrier)
+  {
+    if (sync_wait_leader)
+    {
+      mysql_cond_wait(&COND_wsrep_sync_wait, &LOCK_wsrep_sync_wait);
+      continue;
+    }
+
+    sync_wait_leader= leader= true;
+    mysql_mutex_unlock(&LOCK_wsrep_sync_wait);
+
+    /* let more sessions join the barrier */
+    ulong const window= wsrep_sync_wait_window;
+    if (window) my_sleep(window);
+
+    mysql_mutex_lock(&LOCK_wsrep_sync_wait);
+    sync_wait_sent= barrier;
+    mysql_mutex_unlock(&LOCK_wsrep_sync_wait);
+
+    wsrep_gtid_t   res= WSREP_GTID_UNDEFINED;
+    wsrep_status_t ret= wsrep->causal_read(wsrep, &res);
+    my_atomic_add64(&sync_wait_issued, 1);
+
+    mysql_mutex_lock(&LOCK_wsrep_sync_wait);
+    sync_wait_ret=    ret;
+    sync_wait_gtid=   res;
+    sync_wait_done=   barrier;
+    sync_wait_leader= false;
+    mysql_cond_broadcast(&COND_wsrep_sync_wait);
+  }
+
+  /* later barrier is as good as ours */
+  wsrep_status_t const ret= sync_wait_ret;
+  *gtid= sync_wait_gtid;
+  mysql_mutex_unlock(&LOCK_wsrep_sync_wait);
+
+  if (!leader) my_atomic_add64(&sync_wait_coalesced, 1);
+
+  ulonglong const latency= my_micro_time() - start;
+  size_t bucket= 0;
+  while (bucket < array_elements(sync_wait_buckets) &&
+         latency > sync_wait_buckets[bucket])
+    ++bucket;
+  my_atomic_add64(&sync_wait_latency[bucket], 1);
+
+  return ret;
+}
+
+/*
+  Status variables of sync waits:
+  wsrep_sync_wait_issued - causal read barriers sent to provider,
+  wsrep_sync_wait_coalesced - sync waits served by a barrier of another
+  session, wsrep_sync_wait_latency_* - number of sync waits which took up
+  to the given time.
+*/
+#define WSREP_SYNC_WAIT_STATUS_LEN (2 + SYNC_WAIT_BUCKETS)
+static SHOW_VAR  wsrep_sync_wait_status[WSREP_SYNC_WAIT_STATUS_LEN + 1];
+static const char* const wsrep_sync_wait_status_names[]=
+{
+  "issued", "coalesced", "latency_100us", "latency_1ms", "latency_10ms",
+  "latency_100ms", "latency_1s", "latency_more"
+};
+static long long wsrep_sync_wait_status_values[WSREP_SYNC_WAIT_STATUS_LEN];
+
+int wsrep_show_sync_wait_status(THD *thd, SHOW_VAR *var, char *buff)
+{
+  compile_time_assert(array_elements(wsrep_sync_wait_status_names) ==
+                      WSREP_SYNC_WAIT_STATUS_LEN);
+  int n= 0;
+
+  wsrep_sync_wait_status_values[n++]= my_atomic_load64(&sync_wait_issued);
+  wsrep_sync_wait_status_values[n++]= my_atomic_load64(&sync_wait_coalesced);
+  for (size_t i= 0; i < SYNC_WAIT_BUCKETS; i++)
+    wsrep_sync_wait_status_values[n++]=
+      my_atomic_load64(&sync_wait_latency[i]);
+
+  for (int i= 0; i < n; i++)
+  {
+    wsrep_sync_wait_status[i].name= wsrep_sync_wait_status_names[i];
+    wsrep_sync_wait_status[i].value=
+      (char*)&wsrep_sync_wait_status_values[i];
+    wsrep_sync_wait_status[i].type= SHOW_LONGLONG;
+  }
+  wsrep_sync_wait_status[n].name= NullS;
+  wsrep_sync_wait_status[n].value= NullS;
+  wsrep_sync_wait_status[n].type= SHOW_LONG;
+
+  var->type= SHOW_ARRAY;
+  var->value= (char*)&wsrep_sync_wait_status;
+  return 0;
+}
+
 bool wsrep_sync_wait (THD* thd, uint mask)
 {
   if (wsrep_must_sync_wait(thd, mask))
@@ -818,7 +973,7 @@ bool wsrep_sync_wait (THD* thd, uint mask)
                 thd->variables.wsrep_sync_wait, mask);
     // This allows autocommit SELECTs and a first SELECT after SET AUTOCOMMIT=0
     // TODO: modify to check if thd has locked any rows.
-    wsrep_status_t ret= wsrep->causal_read (wsrep, &thd->wsrep_sync_wait_gtid);
+    wsrep_status_t ret= wsrep_causal_read (&thd->wsrep_sync_wait_gtid);
 
     if (unlikely(WSREP_OK != ret))
     {
@@ -854,10 +1009,7 @@ bool wsrep_sync_wait (THD* thd, uint mask)
 
 void wsrep_keys_free(wsrep_key_arr_t* key_arr)
 {
-    for (size_t i= 0; i < key_arr->keys_len; ++i)
-    {
-        my_free((void*)key_arr->keys[i].key_parts);
-    }
+    /* key parts are allocated together with keys */
     my_free(key_arr->keys);
     key_arr->keys= 0;
     key_arr->keys_len= 0;
@@ -916,35 +1068,47 @@ static bool wsrep_prepare_key_for_isolation(const char* db,
     return true;
 }
 
-/* Prepare key list from db/table and table_list */
+/*
+  Prepare key list from db/table and table_list.
+
+  Key parts point to db and table names of the statement, so all keys and
+  their parts are allocated in one block which lives until
+  wsrep_keys_free().
+*/
 bool wsrep_prepare_keys_for_isolation(THD*              thd,
                                       const char*       db,
                                       const char*       table,
                                       const TABLE_LIST* table_list,
                                       wsrep_key_arr_t*  ka)
 {
+  size_t const parts_per_key= 2;
+  size_t keys_max= (db || table) ? 1 : 0;
+  for (const TABLE_LIST* t= table_list; t; t= t->next_global) ++keys_max;
+
   ka->keys= 0;
   ka->keys_len= 0;
 
+  if (keys_max == 0) return 0;
+
+  if (!(ka->keys= (wsrep_key_t*)
+        my_malloc(keys_max * (sizeof(wsrep_key_t) +
+                              parts_per_key * sizeof(wsrep_buf_t)), MYF(0))))
+  {
+    WSREP_ERROR("Can't allocate memory for key_array");
+    return 1;
+  }
+
+  wsrep_buf_t* parts= (wsrep_buf_t*)(ka->keys + keys_max);
+
   if (db || table)
   {
-    if (!(ka->keys= (wsrep_key_t*)my_malloc(sizeof(wsrep_key_t), MYF(0))))
-    {
-      WSREP_ERROR("Can't allocate memory for key_array");
-      goto err;
-    }
-    ka->keys_len= 1;
-    if (!(ka->keys[0].key_parts= (wsrep_buf_t*)
-          my_malloc(sizeof(wsrep_buf_t)*2, MYF(0))))
-    {
-      WSREP_ERROR("Can't allocate memory for key_parts");
-      goto err;
-    }
-    ka->keys[0].key_parts_num= 2;
-    if (!wsrep_prepare_key_for_isolation(
-                                         db, table,
-                                         (wsrep_buf_t*)ka->keys[0].key_parts,
-                                         &ka->keys[0].key_parts_num))
+    wsrep_key_t* const key= &ka->keys[ka->keys_len++];
+    key->key_parts= parts;
+    key->key_parts_num= parts_per_key;
+    parts+= parts_per_key;
+    if (!wsrep_prepare_key_for_isolation(db, table,
+                                         (wsrep_buf_t*)key->key_parts,
+                                         &key->key_parts_num))
     {
       WSREP_ERROR("Preparing keys for isolation failed (1)");
       goto err;
@@ -953,27 +1117,13 @@ bool wsrep_prepare_keys_for_isolation(THD*              thd,
 
   for (const TABLE_LIST* table= table_list; table; table= table->next_global)
   {
-    wsrep_key_t* tmp;
-    tmp= (wsrep_key_t*)my_realloc(ka->keys,
-                                  (ka->keys_len + 1) * sizeof(wsrep_key_t),
-                                  MYF(0));
-    if (!tmp)
-    {
-      WSREP_ERROR("Can't allocate memory for key_array");
-      goto err;
-    }
-    ka->keys= tmp;
-    if (!(ka->keys[ka->keys_len].key_parts= (wsrep_buf_t*)
-          my_malloc(sizeof(wsrep_buf_t)*2, MYF(0))))
-    {
-      WSREP_ERROR("Can't allocate memory for key_parts");
-      goto err;
-    }
-    ka->keys[ka->keys_len].key_parts_num= 2;
-    ++ka->keys_len;
+    wsrep_key_t* const key= &ka->keys[ka->keys_len++];
+    key->key_parts= parts;
+    key->key_parts_num= parts_per_key;
+    parts+= parts_per_key;
     if (!wsrep_prepare_key_for_isolation(table->db, table->table_name,
-                                         (wsrep_buf_t*)ka->keys[ka->keys_len - 1].key_parts,
-                                         &ka->keys[ka->keys_len - 1].key_parts_num))
+                                         (wsrep_buf_t*)key->key_parts,
+                                         &key->key_parts_num))
     {
       WSREP_ERROR("Preparing keys for isolation failed (2)");
       goto err;
@@ -1030,6 +1180,165 @@ bool wsrep_prepare_key_for_innodb(const uchar* cache_key,
     return true;
 }
 
+/*
+  Writeset dependency summary.
+
+  Provider applies writesets in parallel unless their keys overlap or
+  they are flagged PA unsafe. Writesets with statement events used to be
+  always PA unsafe, as a statement may read or write rows which have no
+  key in the writeset. Instead, each table the statement opens gets an
+  exclusive table level key, which orders the writeset after and before
+  any other writeset touching the same table, but not others. Statements
+  whose effects can't be bounded by their table list (stored routines,
+  temporary tables, foreign keys) stay PA unsafe.
+
+  Exclusive table keys also take part in certification: a concurrent
+  write to the same table from another node fails certification against
+  them, as it would against TOI. Hence this is opt in, wsrep_pa_table_keys.
+  Row writes to tables without keys get a shared table key instead, which
+  orders them after statement writesets on the table but does not
+  conflict with other row writes.
+*/
+static volatile int64 pa_unsafe=     0;
+static volatile int64 pa_table_keys= 0;
+static volatile int64 pa_fk=         0;
+static volatile int64 pa_trigger=    0;
+static volatile int64 pa_nonpk=      0;
+
+void wsrep_ws_deps_add(THD* thd, uint deps)
+{
+  thd->wsrep_ws_deps|= deps;
+}
+
+int wsrep_append_table_key(THD* thd, const char* db, const char* table,
+                           bool shared)
+{
+  wsrep_buf_t parts[2];
+  wsrep_key_t key= { parts, 2 };
+
+  if (!wsrep_prepare_key_for_isolation(db, table, parts, &key.key_parts_num)
+      || key.key_parts_num != 2)
+    return 1;
+  return wsrep_append_row_key(thd, &key, shared);
+}
+
+bool wsrep_stmt_table_keys(THD* thd)
+{
+  thd->wsrep_ws_deps|= WSREP_DEPS_STMT;
+
+  if (!wsrep_pa_table_keys || !WSREP(thd)          ||
+      thd->wsrep_exec_mode != LOCAL_STATE          ||
+      thd->wsrep_ws_handle.trx_id == WSREP_UNDEFINED_TRX_ID)
+    return false;
+
+  LEX* const lex= thd->lex;
+  switch (lex->sql_command)
+  {
+  case SQLCOM_INSERT:
+  case SQLCOM_INSERT_SELECT:
+  case SQLCOM_REPLACE:
+  case SQLCOM_REPLACE_SELECT:
+  case SQLCOM_UPDATE:
+  case SQLCOM_UPDATE_MULTI:
+  case SQLCOM_DELETE:
+  case SQLCOM_DELETE_MULTI:
+    break;
+  default:
+    return false;
+  }
+
+  if (lex->uses_stored_routines() || thd->sp_runtime_ctx) return false;
+
+  bool appended= false;
+  for (TABLE_LIST* tl= lex->query_tables; tl; tl= tl->next_global)
+  {
+    /* underlying tables are in the list too */
+    if (tl->is_view_or_derived()) continue;
+
+    TABLE* const table= tl->table;
+    if (!table || table->s->tmp_table != NO_TMP_TABLE) return false;
+
+    if (table->triggers) thd->wsrep_ws_deps|= WSREP_DEPS_TRIGGER;
+
+    /* cascades and checks reach tables outside of the list */
+    if (!table->file->can_switch_engines())
+    {
+      thd->wsrep_ws_deps|= WSREP_DEPS_FK;
+      return false;
+    }
+
+    if (wsrep_append_table_key(thd, table->s->db.str,
+                               table->s->table_name.str, false))
+      return false;
+    appended= true;
+  }
+
+  if (appended) thd->wsrep_ws_deps|= WSREP_DEPS_TABLE_KEYS;
+  return appended;
+}
+
+void wsrep_ws_deps_commit(THD* thd)
+{
+  uint const deps= thd->wsrep_ws_deps;
+
+  if (!thd->wsrep_PA_safe)               my_atomic_add64(&pa_unsafe, 1);
+  else if (deps & WSREP_DEPS_TABLE_KEYS) my_atomic_add64(&pa_table_keys, 1);
+  if (deps & WSREP_DEPS_FK)              my_atomic_add64(&pa_fk, 1);
+  if (deps & WSREP_DEPS_TRIGGER)         my_atomic_add64(&pa_trigger, 1);
+  if (deps & WSREP_DEPS_NONPK)           my_atomic_add64(&pa_nonpk, 1);
+
+  WSREP_DEBUG("writeset deps: thd %lu, PA %s, stmt: %d, table keys: %d, "
+              "fk: %d, triggers: %d, non-PK: %d",
+              thd->thread_id, thd->wsrep_PA_safe ? "safe" : "unsafe",
+              MY_TEST(deps & WSREP_DEPS_STMT),
+              MY_TEST(deps & WSREP_DEPS_TABLE_KEYS),
+              MY_TEST(deps & WSREP_DEPS_FK),
+              MY_TEST(deps & WSREP_DEPS_TRIGGER),
+              MY_TEST(deps & WSREP_DEPS_NONPK));
+}
+
+/*
+  Status variables of writeset dependencies:
+  wsrep_pa_unsafe - writesets replicated PA unsafe,
+  wsrep_pa_table_keys - writesets with statement events replicated PA safe
+  thanks to table keys, wsrep_pa_fk, wsrep_pa_triggers, wsrep_pa_nonpk -
+  writesets involving foreign keys, triggers, tables without primary key.
+*/
+#define WSREP_PA_STATUS_LEN 5
+static SHOW_VAR  wsrep_pa_status[WSREP_PA_STATUS_LEN + 1];
+static const char* const wsrep_pa_status_names[]=
+{
+  "unsafe", "table_keys", "fk", "triggers", "nonpk"
+};
+static long long wsrep_pa_status_values[WSREP_PA_STATUS_LEN];
+
+int wsrep_show_pa_status(THD *thd, SHOW_VAR *var, char *buff)
+{
+  compile_time_assert(array_elements(wsrep_pa_status_names) ==
+                      WSREP_PA_STATUS_LEN);
+  int n= 0;
+
+  wsrep_pa_status_values[n++]= my_atomic_load64(&pa_unsafe);
+  wsrep_pa_status_values[n++]= my_atomic_load64(&pa_table_keys);
+  wsrep_pa_status_values[n++]= my_atomic_load64(&pa_fk);
+  wsrep_pa_status_values[n++]= my_atomic_load64(&pa_trigger);
+  wsrep_pa_status_values[n++]= my_atomic_load64(&pa_nonpk);
+
+  for (int i= 0; i < n; i++)
+  {
+    wsrep_pa_status[i].name= wsrep_pa_status_names[i];
+    wsrep_pa_status[i].value= (char*)&wsrep_pa_status_values[i];
+    wsrep_pa_status[i].type= SHOW_LONGLONG;
+  }
+  wsrep_pa_status[n].name= NullS;
+  wsrep_pa_status[n].value= NullS;
+  wsrep_pa_status[n].type= SHOW_LONG;
+
+  var->type= SHOW_ARRAY;
+  var->value= (char*)&wsrep_pa_status;
+  return 0;
+}
+
 
 /*
  * Construct Query_log_Event from thd query and serialize it
@@ -1290,6 +1599,8 @@ static bool wsrep_can_run_in_toi(THD *thd, const char *db, const char *table,
    1: TOI replication was skipped
   -1: TOI replication failed 
  */
+static void wsrep_TOI_end(THD *thd);
+
 static int wsrep_TOI_begin(THD *thd, char *db_, char *table_,
                            const TABLE_LIST* table_list)
 {
@@ -1349,6 +1660,19 @@ static int wsrep_TOI_begin(THD *thd, char *db_, char *table_,
     wsrep_keys_free(&key_arr);
     WSREP_DEBUG("TO BEGIN: %lld, %d",(long long)wsrep_thd_trx_seqno(thd),
                 thd->wsrep_exec_mode);
+
+    /*
+      A non-blocking operation on the table is checked only now that the
+      statement is ordered, appliers skip it at the same point.
+    */
+    if (wsrep_NBO_conflict(thd, db_, table_, table_list))
+    {
+      wsrep_TOI_end(thd);
+      wsrep_cleanup_transaction(thd);
+      my_error(ER_LOCK_DEADLOCK, MYF(0), "Non-blocking operation in progress "
+               "on the table, retry the query later.");
+      return -1;
+    }
   }
   else if (key_arr.keys_len > 0) {
     /* jump to error handler in mysql_execute_command() */
@@ -1479,7 +1803,17 @@ int wsrep_to_isolation_begin(THD *thd, char *db_, char *table_,
   /*
     No isolation for applier or replaying threads.
    */
-  if (thd->wsrep_exec_mode == REPL_RECV) return 0;
+  if (thd->wsrep_exec_mode == REPL_RECV)
+  {
+    /* skipped in total order, see wsrep_TOI_begin() */
+    if (thd->wsrep_apply_toi &&
+        wsrep_NBO_conflict(thd, db_, table_, table_list))
+    {
+      my_message(ER_SLAVE_IGNORED_TABLE, ER(ER_SLAVE_IGNORED_TABLE), MYF(0));
+      return -1;
+    }
+    return 0;
+  }
 
   int ret= 0;
   mysql_mutex_lock(&thd->LOCK_wsrep_thd);
@@ -1525,10 +1859,33 @@ int wsrep_to_isolation_begin(THD *thd, char *db_, char *table_,
   if (thd->variables.wsrep_on && thd->wsrep_exec_mode==LOCAL_STATE)
   {
     switch (thd->variables.wsrep_OSU_method) {
+    case WSREP_OSU_NBO:
+      if (wsrep_NBO_supported(thd, table_list))
+      {
+        if (wsrep_can_run_in_toi(thd, db_, table_, table_list) == false)
+        {
+          WSREP_DEBUG("No NBO for %s", WSREP_QUERY(thd));
+          ret= 1;
+        }
+        else
+        {
+          ret= wsrep_NBO_begin(thd, db_, table_, table_list);
+        }
+        break;
+      }
+      WSREP_DEBUG("NBO not supported, using TOI: %s", WSREP_QUERY(thd));
+      /* fall through */
     case WSREP_OSU_TOI:
       ret =  wsrep_TOI_begin(thd, db_, table_, table_list);
       break;
     case WSREP_OSU_RSU:
+      if (wsrep_NBO_conflict(thd, db_, table_, table_list))
+      {
+        my_error(ER_LOCK_DEADLOCK, MYF(0), "Non-blocking operation in "
+                 "progress on the table, retry the query later.");
+        ret= -1;
+        break;
+      }
       ret =  wsrep_RSU_begin(thd, db_, table_);
       break;
     default:
@@ -1553,10 +1910,17 @@ int wsrep_to_isolation_begin(THD *thd, char *db_, char *table_,
 
 void wsrep_to_isolation_end(THD *thd)
 {
+  if (thd->wsrep_nbo)
+  {
+    wsrep_NBO_end(thd);
+    return;
+  }
+
   if (thd->wsrep_exec_mode == TOTAL_ORDER)
   {
     switch(thd->variables.wsrep_OSU_method)
     {
+    case WSREP_OSU_NBO: /* fell back to TOI */
     case WSREP_OSU_TOI: wsrep_TOI_end(thd); break;
     case WSREP_OSU_RSU: wsrep_RSU_end(thd); break;
     default:
@@ -81,6 +81,9 @@ extern ulong       wsrep_retry_autocommit;
 extern my_bool     wsrep_auto_increment_control;
 extern my_bool     wsrep_drupal_282555_workaround;
 extern my_bool     wsrep_incremental_data_collection;
+extern my_bool     wsrep_zero_copy_data_collection;
+extern ulong       wsrep_append_cache_chunk_size;
+extern my_bool     wsrep_hash_keys;
 extern const char* wsrep_start_position;
 extern ulong       wsrep_max_ws_size;
 extern ulong       wsrep_max_ws_rows;
@@ -110,6 +113,7 @@ enum enum_wsrep_reject_types {
 enum enum_wsrep_OSU_method {
     WSREP_OSU_TOI,
     WSREP_OSU_RSU,
+    WSREP_OSU_NBO,
     WSREP_OSU_NONE,
 };
 
@@ -131,12 +135,18 @@ extern const char* wsrep_cluster_status;
 extern long        wsrep_cluster_size;
 extern long        wsrep_local_index;
 extern long long   wsrep_local_bf_aborts;
+/* certification key bytes not replicated thanks to wsrep_hash_keys */
+extern long long   wsrep_hash_keys_bytes_saved;
 extern const char* wsrep_provider_name;
 extern const char* wsrep_provider_version;
 extern const char* wsrep_provider_vendor;
 
 int  wsrep_show_status(THD *thd, SHOW_VAR *var, char *buff);
 int  wsrep_show_ready(THD *thd, SHOW_VAR *var, char *buff);
+int  wsrep_show_hash_keys_bytes_saved(THD *thd, SHOW_VAR *var, char *buff);
+/* count key bytes saved per transaction, added to the total when it commits */
+void wsrep_hash_keys_add(THD *thd, ulonglong bytes_saved);
+void wsrep_hash_keys_commit(THD *thd);
 void wsrep_free_status(THD *thd);
 
 /* Filters out --wsrep-new-cluster oprtion from argv[]
@@ -289,22 +299,54 @@ extern "C" bool wsrep_consistency_check(void *thd_ptr);
 typedef struct wsrep_aborting_thd {
   struct wsrep_aborting_thd *next;
   THD *aborting_thd;
+  ulonglong enqueued; /* my_micro_time() when victim was queued */
 } *wsrep_aborting_thd_t;
 
+#define WSREP_ROLLBACKER_THREADS_MAX 64
+extern ulong wsrep_rollbacker_threads;
+#define WSREP_APPLIER_LOOKAHEAD_MAX 1024
+extern ulong wsrep_applier_lookahead;
+#define WSREP_KEY_BATCH_SIZE_MAX 65536
+extern ulong wsrep_key_batch_size;
+#define WSREP_SYNC_WAIT_WINDOW_MAX 1000000
+extern ulong wsrep_sync_wait_window;
+int  wsrep_show_sync_wait_status(THD *thd, SHOW_VAR *var, char *buff);
+/* writeset dependency summary, THD::wsrep_ws_deps */
+#define WSREP_DEPS_STMT       (1 << 0) /* statement events */
+#define WSREP_DEPS_TABLE_KEYS (1 << 1) /* statement tables got table keys */
+#define WSREP_DEPS_FK         (1 << 2) /* foreign key checks or cascades */
+#define WSREP_DEPS_TRIGGER    (1 << 3) /* triggers fired */
+#define WSREP_DEPS_NONPK      (1 << 4) /* rows of tables without PK */
+extern my_bool wsrep_pa_table_keys;
+void wsrep_ws_deps_add(THD* thd, uint deps);
+void wsrep_ws_deps_commit(THD* thd);
+bool wsrep_stmt_table_keys(THD* thd);
+int  wsrep_append_table_key(THD* thd, const char* db, const char* table,
+                            bool shared);
+int  wsrep_show_pa_status(THD *thd, SHOW_VAR *var, char *buff);
+/* row key appends, buffered per transaction if wsrep_key_batch_size > 0 */
+int  wsrep_append_row_key(THD* thd, const wsrep_key_t* key, bool shared);
+int  wsrep_flush_row_keys(THD* thd);
+void wsrep_clear_row_keys(THD* thd);
+void wsrep_free_row_keys(THD* thd);
+/* hand BF abort victim over to rollbacker pool */
+extern "C" void wsrep_thd_enqueue_rollback(THD *thd);
+
 extern mysql_mutex_t LOCK_wsrep_ready;
 extern mysql_cond_t  COND_wsrep_ready;
 extern mysql_mutex_t LOCK_wsrep_sst;
 extern mysql_cond_t  COND_wsrep_sst;
 extern mysql_mutex_t LOCK_wsrep_sst_init;
 extern mysql_cond_t  COND_wsrep_sst_init;
-extern mysql_mutex_t LOCK_wsrep_rollback;
-extern mysql_cond_t  COND_wsrep_rollback;
 extern int wsrep_replaying;
 extern mysql_mutex_t LOCK_wsrep_replaying;
 extern mysql_cond_t  COND_wsrep_replaying;
 extern mysql_mutex_t LOCK_wsrep_slave_threads;
 extern mysql_mutex_t LOCK_wsrep_desync;
-extern wsrep_aborting_thd_t wsrep_aborting_thd;
+extern mysql_mutex_t LOCK_wsrep_nbo;
+extern mysql_cond_t  COND_wsrep_nbo;
+extern mysql_mutex_t LOCK_wsrep_sync_wait;
+extern mysql_cond_t  COND_wsrep_sync_wait;
 extern my_bool       wsrep_emulate_bin_log;
 extern int           wsrep_to_isolation;
 extern rpl_sidno     wsrep_sidno;
@@ -318,12 +360,21 @@ extern PSI_mutex_key key_LOCK_wsrep_sst_init;
 extern PSI_cond_key  key_COND_wsrep_sst_init;
 extern PSI_mutex_key key_LOCK_wsrep_sst_thread;
 extern PSI_cond_key  key_COND_wsrep_sst_thread;
-extern PSI_mutex_key key_LOCK_wsrep_rollback;
-extern PSI_cond_key  key_COND_wsrep_rollback;
+extern PSI_mutex_key key_LOCK_wsrep_rollbacker;
+extern PSI_cond_key  key_COND_wsrep_rollbacker;
+extern PSI_mutex_key key_LOCK_wsrep_applier_decoder;
+extern PSI_cond_key  key_COND_wsrep_applier_decoder;
 extern PSI_mutex_key key_LOCK_wsrep_replaying;
 extern PSI_cond_key  key_COND_wsrep_replaying;
 extern PSI_mutex_key key_LOCK_wsrep_slave_threads;
 extern PSI_mutex_key key_LOCK_wsrep_desync;
+extern PSI_mutex_key key_LOCK_wsrep_nbo;
+extern PSI_cond_key  key_COND_wsrep_nbo;
+extern PSI_mutex_key key_LOCK_wsrep_sync_wait;
+extern PSI_mutex_key key_LOCK_wsrep_conflict_stats;
+extern PSI_cond_key  key_COND_wsrep_sync_wait;
+extern PSI_mutex_key key_LOCK_wsrep_notify;
+extern PSI_cond_key  key_COND_wsrep_notify;
 #endif /* HAVE_PSI_INTERFACE */
 struct TABLE_LIST;
 int wsrep_to_isolation_begin(THD *thd, char *db_, char *table_,
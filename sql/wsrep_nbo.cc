@@ -0,0 +1,747 @@
+/* Copyright 2013 Codership Oy <http://www.codership.com>
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+
+#include "wsrep_mysqld.h"
+#include "wsrep_nbo.h"
+#include "wsrep_xid.h"   // wsrep_set_SE_checkpoint()
+#include "sql_class.h"
+#include "sql_parse.h"   // mysql_parse()
+#include "sql_alter.h"   // Alter_info
+#include "log_event.h"   // Query_log_event
+#include "mysqld.h"      // start_wsrep_THD()
+#include "rpl_slave.h"   // opt_log_slave_updates
+#include <algorithm>
+
+/*
+  Both phases are replicated as ordinary total order write sets, the
+  marker query event in front of the statement tells appliers which
+  phase it is. Begin marker carries the id of the originating node and
+  the name of the altered table, end marker carries the seqno of the
+  first phase and the outcome on the originating node.
+*/
+static const char nbo_begin_marker[]= "/* wsrep NBO begin ";
+static const char nbo_end_marker[]=   "/* wsrep NBO end ";
+
+enum wsrep_NBO_state
+{
+  NBO_STARTING, /* worker is opening the table                 */
+  NBO_RUNNING,  /* long running phase, appliers are not blocked */
+  NBO_COMMIT,   /* second phase arrived, operation is committed */
+  NBO_ROLLBACK, /* second phase arrived, operation is aborted   */
+  NBO_DONE      /* worker has finished                          */
+};
+
+struct Wsrep_NBO
+{
+  Wsrep_NBO*           next;
+  wsrep_seqno_t        seqno;  /* first phase seqno, identifies operation */
+  bool                 worker; /* runs on behalf of applier */
+  enum wsrep_NBO_state state;
+  uint                 error;
+  char                 db[NAME_LEN + 1];
+  char                 table[NAME_LEN + 1];
+  THD*                 thd;
+  wsrep_uuid_t         origin; /* node the operation comes from */
+  bool                 orphan; /* origin left, second phase won't come */
+
+  /* originating node */
+  char*                db_;
+  char*                table_;
+  const TABLE_LIST*    table_list;
+  bool                 phase_one;      /* first phase holds total order */
+  bool                 phase_two_sent;
+  bool                 phase_two_open; /* second phase holds total order */
+
+  /* applier, statement to run in worker */
+  char*                query;
+  size_t               query_len;
+  char*                query_db;
+  ulonglong            sql_mode;
+  bool                 sql_mode_inited;
+  char                 charset[6];
+  bool                 charset_inited;
+};
+
+/* operations running on this node, protected by LOCK_wsrep_nbo */
+static Wsrep_NBO* nbo_list= NULL;
+
+/* operation whose worker thread has not started yet, LOCK_wsrep_nbo */
+static Wsrep_NBO* nbo_pending= NULL;
+
+/* id of this node in the current view, LOCK_wsrep_nbo */
+static wsrep_uuid_t nbo_node_id= WSREP_UUID_UNDEFINED;
+
+static Wsrep_NBO* wsrep_NBO_alloc()
+{
+  return (Wsrep_NBO*) my_malloc(sizeof(Wsrep_NBO), MYF(MY_WME | MY_ZEROFILL));
+}
+
+static void wsrep_NBO_free(Wsrep_NBO* nbo)
+{
+  my_free(nbo->query);
+  my_free(nbo->query_db);
+  my_free(nbo);
+}
+
+static void wsrep_NBO_register(Wsrep_NBO* nbo)
+{
+  mysql_mutex_lock(&LOCK_wsrep_nbo);
+  nbo->next= nbo_list;
+  nbo_list= nbo;
+  mysql_mutex_unlock(&LOCK_wsrep_nbo);
+}
+
+/* must be called with LOCK_wsrep_nbo held */
+static void wsrep_NBO_unregister(Wsrep_NBO* nbo)
+{
+  mysql_mutex_assert_owner(&LOCK_wsrep_nbo);
+  for (Wsrep_NBO** p= &nbo_list; *p; p= &(*p)->next)
+  {
+    if (*p == nbo)
+    {
+      *p= nbo->next;
+      break;
+    }
+  }
+}
+
+bool wsrep_NBO_supported(THD* thd, const TABLE_LIST* table_list)
+{
+  /* changes InnoDB can build online from the row log */
+  static const uint nbo_flags= (Alter_info::ALTER_ADD_COLUMN            |
+                                Alter_info::ALTER_DROP_COLUMN           |
+                                Alter_info::ALTER_CHANGE_COLUMN         |
+                                Alter_info::ALTER_ADD_INDEX             |
+                                Alter_info::ALTER_DROP_INDEX            |
+                                Alter_info::ALTER_OPTIONS               |
+                                Alter_info::ALTER_CHANGE_COLUMN_DEFAULT |
+                                Alter_info::ALTER_RECREATE              |
+                                Alter_info::ALTER_COLUMN_ORDER);
+  const LEX*        lex= thd->lex;
+  const Alter_info* alter_info= &lex->alter_info;
+
+  return (lex->sql_command == SQLCOM_ALTER_TABLE                         &&
+          alter_info->requested_algorithm ==
+          Alter_info::ALTER_TABLE_ALGORITHM_INPLACE                      &&
+          (alter_info->requested_lock == Alter_info::ALTER_TABLE_LOCK_DEFAULT ||
+           alter_info->requested_lock == Alter_info::ALTER_TABLE_LOCK_NONE) &&
+          alter_info->flags && !(alter_info->flags & ~nbo_flags)         &&
+          !lex->name.str /* no rename */                                 &&
+          thd->locked_tables_mode == LTM_NONE                            &&
+          table_list && !table_list->next_local);
+}
+
+static bool wsrep_NBO_match(const Wsrep_NBO* nbo,
+                            const char* db, const char* table)
+{
+  return (db && table && !strcmp(nbo->db, db) && !strcmp(nbo->table, table));
+}
+
+/* must be called with LOCK_wsrep_nbo held */
+static const Wsrep_NBO* wsrep_NBO_find(THD* thd, const char* db,
+                                       const char* table,
+                                       const TABLE_LIST* table_list,
+                                       bool orphan)
+{
+  mysql_mutex_assert_owner(&LOCK_wsrep_nbo);
+  for (const Wsrep_NBO* nbo= nbo_list; nbo; nbo= nbo->next)
+  {
+    if (nbo->thd == thd || nbo->orphan != orphan) continue;
+
+    bool match= wsrep_NBO_match(nbo, db, table);
+    for (const TABLE_LIST* tl= table_list; tl && !match; tl= tl->next_global)
+      match= wsrep_NBO_match(nbo, tl->db, tl->table_name);
+    if (match) return nbo;
+  }
+  return NULL;
+}
+
+bool wsrep_NBO_conflict(THD* thd, const char* db, const char* table,
+                        const TABLE_LIST* table_list)
+{
+  mysql_mutex_lock(&LOCK_wsrep_nbo);
+
+  /*
+    Operations are registered and unregistered in total order, except
+    for orphans which unregister when their rollback is done. Waiting
+    for those keeps the outcome the same on every node.
+  */
+  while (wsrep_NBO_find(thd, db, table, table_list, true) &&
+         thd->killed == THD::NOT_KILLED)
+  {
+    struct timespec wtime;
+    set_timespec(wtime, 1);
+    mysql_cond_timedwait(&COND_wsrep_nbo, &LOCK_wsrep_nbo, &wtime);
+  }
+
+  const Wsrep_NBO* const nbo= wsrep_NBO_find(thd, db, table, table_list,
+                                             false);
+  if (nbo)
+  {
+    WSREP_WARN("NBO %lld in progress on %s.%s, skipping: %s",
+               (long long)nbo->seqno, nbo->db, nbo->table, WSREP_QUERY(thd));
+  }
+  mysql_mutex_unlock(&LOCK_wsrep_nbo);
+
+  return (nbo != NULL);
+}
+
+/*
+  Replicate one phase of the operation, marker is added in front of the
+  statement. Returns 0 on success, -1 on error.
+*/
+static int wsrep_NBO_replicate(THD* thd, Wsrep_NBO* nbo, const char* marker)
+{
+  wsrep_status_t ret(WSREP_WARNING);
+  uchar*  buf(0);
+  size_t  buf_len(0);
+
+  const char* const pre_query(thd->wsrep_TOI_pre_query);
+  size_t const pre_query_len(thd->wsrep_TOI_pre_query_len);
+  thd->wsrep_TOI_pre_query=     marker;
+  thd->wsrep_TOI_pre_query_len= strlen(marker);
+  int const buf_err= wsrep_to_buf_helper(thd, thd->query(),
+                                         thd->query_length(),
+                                         &buf, &buf_len);
+  thd->wsrep_TOI_pre_query=     pre_query;
+  thd->wsrep_TOI_pre_query_len= pre_query_len;
+
+  wsrep_key_arr_t key_arr= {0, 0};
+  struct wsrep_buf buff = { buf, buf_len };
+  if (!buf_err                                                      &&
+      !wsrep_prepare_keys_for_isolation(thd, nbo->db_, nbo->table_,
+                                        nbo->table_list, &key_arr)  &&
+      key_arr.keys_len > 0                                          &&
+      WSREP_OK == (ret = wsrep->to_execute_start(wsrep, thd->thread_id,
+                                                 key_arr.keys,
+                                                 key_arr.keys_len,
+                                                 &buff, 1,
+                                                 &thd->wsrep_trx_meta)))
+  {
+    WSREP_DEBUG("NBO %s%lld: %s", marker,
+                (long long)wsrep_thd_trx_seqno(thd), WSREP_QUERY(thd));
+  }
+  else
+  {
+    WSREP_WARN("NBO replication failed for: %d, schema: %s, sql: %s. Check "
+               "wsrep connection state and retry the query.",
+               ret, (thd->db ? thd->db : "(null)"), WSREP_QUERY(thd));
+    if (!thd->is_error())
+      my_error(ER_LOCK_DEADLOCK, MYF(0), "WSREP replication failed. Check "
+               "your wsrep connection state and retry the query.");
+    ret= WSREP_TRX_FAIL;
+  }
+
+  if (buf) my_free(buf);
+  wsrep_keys_free(&key_arr);
+  return (ret == WSREP_OK ? 0 : -1);
+}
+
+/* release total order held by the current phase */
+static void wsrep_NBO_release(THD* thd)
+{
+  wsrep_status_t ret;
+
+  wsrep_set_SE_checkpoint(thd->wsrep_trx_meta.gtid.uuid,
+                          thd->wsrep_trx_meta.gtid.seqno);
+
+  if (WSREP_OK != (ret = wsrep->to_execute_end(wsrep, thd->thread_id)))
+  {
+    WSREP_WARN("NBO isolation end failed for: %d, schema: %s, sql: %s",
+               ret, (thd->db ? thd->db : "(null)"), WSREP_QUERY(thd));
+  }
+  thd->wsrep_trx_meta.gtid= WSREP_GTID_UNDEFINED;
+}
+
+int wsrep_NBO_begin(THD* thd, char* db_, char* table_,
+                    const TABLE_LIST* table_list)
+{
+  Wsrep_NBO* nbo= wsrep_NBO_alloc();
+  if (!nbo) return -1;
+
+  nbo->db_=        db_;
+  nbo->table_=     table_;
+  nbo->table_list= table_list;
+  nbo->thd=        thd;
+
+  char node_id[WSREP_UUID_STR_LEN + 1];
+  mysql_mutex_lock(&LOCK_wsrep_nbo);
+  wsrep_uuid_print(&nbo_node_id, node_id, sizeof(node_id));
+  mysql_mutex_unlock(&LOCK_wsrep_nbo);
+
+  strmake(nbo->db, table_list->db, NAME_LEN);
+  strmake(nbo->table, table_list->table_name, NAME_LEN);
+
+  char marker[sizeof(nbo_begin_marker) + WSREP_UUID_STR_LEN + 2 * NAME_LEN +
+              32];
+  my_snprintf(marker, sizeof(marker), "%s%s %u %u %s.%s */",
+              nbo_begin_marker, node_id, (uint)strlen(nbo->db),
+              (uint)strlen(nbo->table), nbo->db, nbo->table);
+  if (wsrep_NBO_replicate(thd, nbo, marker))
+  {
+    wsrep_NBO_free(nbo);
+    return -1;
+  }
+
+  /* appliers do not start the operation either, see apply_begin */
+  if (wsrep_NBO_conflict(thd, db_, table_, table_list))
+  {
+    wsrep_NBO_release(thd);
+    wsrep_NBO_free(nbo);
+    my_error(ER_LOCK_DEADLOCK, MYF(0), "Non-blocking operation in progress "
+             "on the table, retry the query later.");
+    return -1;
+  }
+
+  nbo->seqno=     wsrep_thd_trx_seqno(thd);
+  nbo->phase_one= true;
+  wsrep_NBO_register(nbo);
+
+  thd->wsrep_nbo= nbo;
+  wsrep_to_isolation++;
+  return 0;
+}
+
+void wsrep_NBO_end(THD* thd)
+{
+  Wsrep_NBO* nbo= (Wsrep_NBO*) thd->wsrep_nbo;
+  if (!nbo || nbo->worker) return;
+
+  if (nbo->phase_one)
+  {
+    /* statement did not reach the long running phase */
+    wsrep_NBO_release(thd);
+    nbo->phase_one= false;
+  }
+
+  if (!nbo->phase_two_sent)
+  {
+    char marker[sizeof(nbo_end_marker) + 32];
+    my_snprintf(marker, sizeof(marker), "%s%lld %d */", nbo_end_marker,
+                (long long)nbo->seqno, thd->is_error() ? 0 : 1);
+    if (!wsrep_NBO_replicate(thd, nbo, marker))
+      nbo->phase_two_open= true;
+    else
+      WSREP_ERROR("NBO %lld could not replicate rollback, nodes may stay "
+                  "blocked on %s.%s", (long long)nbo->seqno,
+                  nbo->db, nbo->table);
+  }
+
+  /* statements ordered after the second phase must not see it */
+  mysql_mutex_lock(&LOCK_wsrep_nbo);
+  wsrep_NBO_unregister(nbo);
+  mysql_mutex_unlock(&LOCK_wsrep_nbo);
+
+  if (nbo->phase_two_open) wsrep_NBO_release(thd);
+  wsrep_NBO_free(nbo);
+
+  thd->wsrep_nbo= NULL;
+  wsrep_to_isolation--;
+  wsrep_cleanup_transaction(thd);
+}
+
+void wsrep_NBO_phase_one_end(THD* thd)
+{
+  Wsrep_NBO* nbo= (Wsrep_NBO*) thd->wsrep_nbo;
+  if (!nbo) return;
+
+  mysql_mutex_lock(&LOCK_wsrep_nbo);
+  if (nbo->worker && nbo->state == NBO_STARTING)
+  {
+    nbo->state= NBO_RUNNING;
+    mysql_cond_broadcast(&COND_wsrep_nbo);
+  }
+  mysql_mutex_unlock(&LOCK_wsrep_nbo);
+
+  if (nbo->phase_one)
+  {
+    WSREP_DEBUG("NBO %lld phase one end: %s", (long long)nbo->seqno,
+                WSREP_QUERY(thd));
+    wsrep_NBO_release(thd);
+    nbo->phase_one= false;
+  }
+}
+
+bool wsrep_NBO_phase_two_begin(THD* thd)
+{
+  Wsrep_NBO* nbo= (Wsrep_NBO*) thd->wsrep_nbo;
+  if (!nbo) return false;
+
+  if (nbo->worker)
+  {
+    /* wait for the second phase to arrive in total order */
+    mysql_mutex_lock(&LOCK_wsrep_nbo);
+    while (nbo->state == NBO_RUNNING && thd->killed == THD::NOT_KILLED)
+    {
+      struct timespec wtime;
+      set_timespec(wtime, 1);
+      mysql_cond_timedwait(&COND_wsrep_nbo, &LOCK_wsrep_nbo, &wtime);
+    }
+    bool const rollback= (nbo->state != NBO_COMMIT);
+    mysql_mutex_unlock(&LOCK_wsrep_nbo);
+
+    if (rollback) my_error(ER_QUERY_INTERRUPTED, MYF(0));
+    return rollback;
+  }
+
+  if (nbo->phase_one) return false;
+
+  char marker[sizeof(nbo_end_marker) + 32];
+  my_snprintf(marker, sizeof(marker), "%s%lld 1 */", nbo_end_marker,
+              (long long)nbo->seqno);
+  if (wsrep_NBO_replicate(thd, nbo, marker)) return true;
+
+  nbo->phase_two_sent= true;
+  nbo->phase_two_open= true;
+  return false;
+}
+
+/*
+  Worker thread running the statement of a replicated operation.
+*/
+static void wsrep_NBO_process(THD* thd)
+{
+  DBUG_ENTER("wsrep_NBO_process");
+
+  mysql_mutex_lock(&LOCK_wsrep_nbo);
+  Wsrep_NBO* const nbo= nbo_pending;
+  nbo_pending= NULL;
+  if (nbo) nbo->thd= thd;
+  mysql_mutex_unlock(&LOCK_wsrep_nbo);
+
+  if (!nbo)
+  {
+    WSREP_WARN("NBO worker found no operation to run");
+    DBUG_VOID_RETURN;
+  }
+
+  thd->wsrep_nbo=          nbo;
+  thd->wsrep_exec_mode=    TOTAL_ORDER;
+  thd->variables.wsrep_on= 0;
+  if (!opt_log_slave_updates)
+    thd->variables.option_bits&= ~OPTION_BIN_LOG;
+
+  if (nbo->query_db) thd->set_db(nbo->query_db, strlen(nbo->query_db));
+  if (nbo->sql_mode_inited)
+    thd->variables.sql_mode= (sql_mode_t) nbo->sql_mode;
+  if (nbo->charset_inited)
+  {
+    const CHARSET_INFO* client= get_charset(uint2korr(nbo->charset), MYF(0));
+    const CHARSET_INFO* conn= get_charset(uint2korr(nbo->charset + 2), MYF(0));
+    const CHARSET_INFO* server= get_charset(uint2korr(nbo->charset + 4),
+                                            MYF(0));
+    if (client && conn && server)
+    {
+      thd->variables.character_set_client= client;
+      thd->variables.collation_connection= conn;
+      thd->variables.collation_server=     server;
+      thd->update_charset();
+    }
+  }
+
+  char* query= (char*) thd->memdup_w_gap(nbo->query, nbo->query_len + 1,
+                                         thd->db_length + 1 +
+                                         QUERY_CACHE_FLAGS_SIZE);
+  size_t db_len= 0;
+  memcpy(query + nbo->query_len + 1, (char*) &db_len, sizeof(size_t));
+  thd->set_query_and_id(query, nbo->query_len, thd->charset(),
+                        next_query_id());
+  thd->set_time();
+
+  WSREP_DEBUG("NBO %lld worker: %s", (long long)nbo->seqno, WSREP_QUERY(thd));
+
+  Parser_state parser_state;
+  if (!parser_state.init(thd, thd->query(), thd->query_length()))
+    mysql_parse(thd, thd->query(), thd->query_length(), &parser_state);
+
+  /*
+    An error before the long running phase (table could not be opened,
+    statement was killed) leaves the operation in NBO_STARTING, setting
+    NBO_DONE below releases the applier waiting for it.
+  */
+  uint const error= thd->is_error() ? thd->get_stmt_da()->sql_errno() : 0;
+  if (error)
+    WSREP_WARN("NBO %lld failed: %u, schema: %s, sql: %s",
+               (long long)nbo->seqno, error,
+               (thd->db ? thd->db : "(null)"), WSREP_QUERY(thd));
+
+  thd->wsrep_nbo=       NULL;
+  thd->wsrep_exec_mode= LOCAL_STATE;
+
+  /* applier thread frees nbo after this, unless the origin has left */
+  mysql_mutex_lock(&LOCK_wsrep_nbo);
+  nbo->error= error;
+  nbo->state= NBO_DONE;
+  if (nbo->orphan)
+  {
+    wsrep_NBO_unregister(nbo);
+    wsrep_NBO_free(nbo);
+  }
+  mysql_cond_broadcast(&COND_wsrep_nbo);
+  mysql_mutex_unlock(&LOCK_wsrep_nbo);
+
+  DBUG_VOID_RETURN;
+}
+
+/*
+  start_wsrep_THD() does not call the processor if it fails to set up
+  the thread, and may leave with pthread_exit(). The cleanup handler then
+  fails the operation so that the applier does not wait for it forever.
+*/
+static void wsrep_NBO_start_cleanup(void* arg)
+{
+  mysql_mutex_lock(&LOCK_wsrep_nbo);
+  if (nbo_pending && nbo_pending == arg)
+  {
+    WSREP_WARN("NBO %lld worker thread failed to start",
+               (long long)nbo_pending->seqno);
+    nbo_pending->error= ER_OUT_OF_RESOURCES;
+    nbo_pending->state= NBO_DONE;
+    nbo_pending= NULL;
+    mysql_cond_broadcast(&COND_wsrep_nbo);
+  }
+  mysql_mutex_unlock(&LOCK_wsrep_nbo);
+}
+
+pthread_handler_t wsrep_NBO_start(void* arg)
+{
+  pthread_cleanup_push(wsrep_NBO_start_cleanup, arg);
+  start_wsrep_THD((void*)wsrep_NBO_process);
+  pthread_cleanup_pop(1);
+  return(NULL);
+}
+
+/* first phase: start worker and wait until it no longer blocks appliers */
+static int wsrep_NBO_apply_begin(THD* thd, Query_log_event* ev,
+                                 const wsrep_NBO_apply_state* state)
+{
+  wsrep_seqno_t const seqno= state->seqno;
+
+  /* originating node failed the statement at the same point */
+  if (wsrep_NBO_conflict(thd, state->db, state->table, NULL)) return 0;
+
+  Wsrep_NBO* nbo= wsrep_NBO_alloc();
+  if (!nbo) return -1;
+
+  nbo->seqno=           seqno;
+  nbo->origin=          state->origin;
+  nbo->worker=          true;
+  nbo->state=           NBO_STARTING;
+  nbo->query=           my_strndup(ev->query, ev->q_len, MYF(MY_WME));
+  nbo->query_len=       ev->q_len;
+  nbo->query_db=        (ev->db && ev->db[0]) ?
+                        my_strdup(ev->db, MYF(MY_WME)) : NULL;
+  nbo->sql_mode=        ev->sql_mode;
+  nbo->sql_mode_inited= ev->sql_mode_inited;
+  memcpy(nbo->charset, ev->charset, sizeof(nbo->charset));
+  nbo->charset_inited=  ev->charset_inited;
+  strmake(nbo->db, state->db, NAME_LEN);
+  strmake(nbo->table, state->table, NAME_LEN);
+
+  if (!nbo->query)
+  {
+    wsrep_NBO_free(nbo);
+    return -1;
+  }
+
+  mysql_mutex_lock(&LOCK_wsrep_nbo);
+  nbo->next= nbo_list;
+  nbo_list= nbo;
+  DBUG_ASSERT(!nbo_pending);
+  nbo_pending= nbo;
+  mysql_mutex_unlock(&LOCK_wsrep_nbo);
+
+  pthread_t hThread;
+  if (pthread_create(&hThread, &connection_attrib, wsrep_NBO_start, nbo))
+  {
+    WSREP_WARN("Can't create NBO worker thread, applying in total order");
+    mysql_mutex_lock(&LOCK_wsrep_nbo);
+    nbo_pending= NULL;
+    wsrep_NBO_unregister(nbo);
+    mysql_mutex_unlock(&LOCK_wsrep_nbo);
+    wsrep_NBO_free(nbo);
+    return -1;
+  }
+
+  /*
+    The worker moves the operation out of NBO_STARTING on all of its
+    paths, NBO_DONE here means it failed. The operation stays registered
+    so that the second phase reports the failure.
+  */
+  mysql_mutex_lock(&LOCK_wsrep_nbo);
+  while (nbo->state == NBO_STARTING)
+    mysql_cond_wait(&COND_wsrep_nbo, &LOCK_wsrep_nbo);
+  uint const error= (nbo->state == NBO_DONE ? nbo->error : 0);
+  mysql_mutex_unlock(&LOCK_wsrep_nbo);
+
+  if (error)
+  {
+    WSREP_DEBUG("NBO %lld failed to start: %u", (long long)seqno, error);
+  }
+  else
+  {
+    WSREP_DEBUG("NBO %lld started", (long long)seqno);
+  }
+  return 0;
+}
+
+/* second phase: let worker commit or roll back and wait for it */
+static int wsrep_NBO_apply_end(THD* thd, wsrep_seqno_t seqno, bool commit)
+{
+  mysql_mutex_lock(&LOCK_wsrep_nbo);
+  Wsrep_NBO* nbo;
+  for (nbo= nbo_list;
+       nbo && !(nbo->worker && !nbo->orphan && nbo->seqno == seqno);
+       nbo= nbo->next) {}
+
+  if (!nbo)
+  {
+    mysql_mutex_unlock(&LOCK_wsrep_nbo);
+    /* first phase was before the state this node received */
+    WSREP_DEBUG("NBO %lld not running, %s", (long long)seqno,
+                commit ? "applying in total order" : "skipping");
+    return (commit ? -1 : 0);
+  }
+
+  if (nbo->state == NBO_RUNNING)
+  {
+    nbo->state= (commit ? NBO_COMMIT : NBO_ROLLBACK);
+    mysql_cond_broadcast(&COND_wsrep_nbo);
+  }
+  while (nbo->state != NBO_DONE)
+    mysql_cond_wait(&COND_wsrep_nbo, &LOCK_wsrep_nbo);
+  wsrep_NBO_unregister(nbo);
+  mysql_mutex_unlock(&LOCK_wsrep_nbo);
+
+  uint const error= nbo->error;
+  wsrep_NBO_free(nbo);
+
+  if (commit && error)
+  {
+    WSREP_WARN("NBO %lld committed on originating node, failed here: %u",
+               (long long)seqno, error);
+    return 1;
+  }
+  return 0;
+}
+
+int wsrep_NBO_apply_event(THD* thd, Query_log_event* ev,
+                          wsrep_NBO_apply_state* state)
+{
+  if (ev->q_len > sizeof(nbo_begin_marker) - 1 &&
+      !memcmp(ev->query, nbo_begin_marker, sizeof(nbo_begin_marker) - 1))
+  {
+    const char* args= ev->query + sizeof(nbo_begin_marker) - 1;
+    size_t      args_len= ev->q_len - (sizeof(nbo_begin_marker) - 1);
+    int const   uuid_len= wsrep_uuid_scan(args, args_len, &state->origin);
+    char        lens[32];
+    uint        db_len, table_len;
+    int         names= 0;
+    if (uuid_len > 0)
+    {
+      args+=     uuid_len;
+      args_len-= uuid_len;
+      strmake(lens, args, std::min<size_t>(args_len, sizeof(lens) - 1));
+    }
+    if (uuid_len <= 0                                                  ||
+        sscanf(lens, " %u %u %n", &db_len, &table_len, &names) != 2    ||
+        !names || db_len > NAME_LEN || table_len > NAME_LEN            ||
+        args_len < (size_t)names + db_len + 1 + table_len              ||
+        args[names + db_len] != '.')
+    {
+      WSREP_ERROR("malformed NBO marker: %.*s", (int)ev->q_len, ev->query);
+      return 1;
+    }
+    strmake(state->db, args + names, db_len);
+    strmake(state->table, args + names + db_len + 1, table_len);
+    state->phase= 1;
+    state->seqno= wsrep_thd_trx_seqno(thd);
+    return 0;
+  }
+
+  if (ev->q_len > sizeof(nbo_end_marker) - 1 &&
+      !memcmp(ev->query, nbo_end_marker, sizeof(nbo_end_marker) - 1))
+  {
+    char      args[32];
+    long long seqno;
+    int       commit;
+    strmake(args, ev->query + sizeof(nbo_end_marker) - 1,
+            std::min<size_t>(ev->q_len - (sizeof(nbo_end_marker) - 1),
+                             sizeof(args) - 1));
+    if (sscanf(args, "%lld %d", &seqno, &commit) != 2)
+    {
+      WSREP_ERROR("malformed NBO marker: %.*s", (int)ev->q_len, ev->query);
+      return 1;
+    }
+    state->phase=  2;
+    state->seqno=  seqno;
+    state->commit= commit;
+    return 0;
+  }
+
+  int const phase= state->phase;
+  state->phase= 0;
+
+  switch (phase)
+  {
+  case 1:  return wsrep_NBO_apply_begin(thd, ev, state);
+  case 2:  return wsrep_NBO_apply_end(thd, state->seqno, state->commit);
+  default: return -1;
+  }
+}
+
+void wsrep_NBO_view_change(const wsrep_view_info_t* view)
+{
+  mysql_mutex_lock(&LOCK_wsrep_nbo);
+
+  if (view->my_idx >= 0) nbo_node_id= view->members[view->my_idx].id;
+
+  /*
+    Workers of operations whose originating node is not in the primary
+    component any more would wait for the second phase forever while
+    holding the table. Roll them back, if the second phase still arrives
+    it is applied in total order. A non-primary view says nothing about
+    the originating node, the workers keep waiting.
+  */
+  Wsrep_NBO** p= &nbo_list;
+  while (Wsrep_NBO* nbo= *p)
+  {
+    bool origin_left= (view->status == WSREP_VIEW_PRIMARY && nbo->worker &&
+                       !nbo->orphan &&
+                       (nbo->state == NBO_RUNNING || nbo->state == NBO_DONE));
+    for (int i= 0; origin_left && i < view->memb_num; i++)
+      origin_left= memcmp(&view->members[i].id, &nbo->origin,
+                          sizeof(wsrep_uuid_t));
+
+    if (origin_left)
+    {
+      WSREP_INFO("NBO %lld: originating node left the primary component, "
+                 "rolling back %s.%s", (long long)nbo->seqno,
+                 nbo->db, nbo->table);
+      if (nbo->state == NBO_DONE)
+      {
+        *p= nbo->next;
+        wsrep_NBO_free(nbo);
+        continue;
+      }
+      nbo->state=  NBO_ROLLBACK;
+      nbo->orphan= true;
+    }
+    p= &nbo->next;
+  }
+  mysql_cond_broadcast(&COND_wsrep_nbo);
+
+  mysql_mutex_unlock(&LOCK_wsrep_nbo);
+}
@@ -0,0 +1,92 @@
+/* Copyright 2013 Codership Oy <http://www.codership.com>
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+
+#ifndef WSREP_NBO_H
+#define WSREP_NBO_H
+
+#include "../wsrep/wsrep_api.h"
+
+/*
+  Non-blocking schema changes (wsrep_OSU_method=NBO).
+
+  An in-place ALTER TABLE is replicated in total order twice: once when it
+  starts, so that every node starts running it in a background worker,
+  and once when the originating node reaches the point of swapping table
+  definitions. Between the two the cluster keeps applying write sets while
+  each node builds the new table version from its online row log; the
+  swap itself happens at the same position of the total order everywhere.
+*/
+
+class THD;
+class Query_log_event;
+struct TABLE_LIST;
+
+/* true if the statement can run as a non-blocking operation */
+bool wsrep_NBO_supported(THD* thd, const TABLE_LIST* table_list);
+
+/*
+  true if a non-blocking operation on a table of the statement is running.
+  Called in total order, by local statements after they have been ordered
+  and by appliers, so every node skips the same statements. Operations
+  being rolled back because their origin left are waited for.
+*/
+bool wsrep_NBO_conflict(THD* thd, const char* db, const char* table,
+                        const TABLE_LIST* table_list);
+
+/*
+  Originating node: replicate the start of the operation.
+  Returns 0 on success, -1 on error.
+*/
+int  wsrep_NBO_begin(THD* thd, char* db, char* table,
+                     const TABLE_LIST* table_list);
+
+/* Originating node: complete the operation at the end of the statement */
+void wsrep_NBO_end(THD* thd);
+
+/*
+  Called by in-place ALTER TABLE when the long running phase starts and
+  before it upgrades the metadata lock to swap table definitions.
+  wsrep_NBO_phase_two_begin() returns true if the operation must be
+  rolled back.
+*/
+void wsrep_NBO_phase_one_end(THD* thd);
+bool wsrep_NBO_phase_two_begin(THD* thd);
+
+/* applier state between marker and statement events of an NBO write set */
+struct wsrep_NBO_apply_state
+{
+  int           phase;
+  wsrep_seqno_t seqno;
+  bool          commit;
+  wsrep_uuid_t  origin;
+  char          db[NAME_LEN + 1];
+  char          table[NAME_LEN + 1];
+};
+
+/*
+  Applier: handle a query event of a total order write set.
+  Returns -1 if the event must be applied as usual, 0 if it was consumed
+  and 1 on error.
+*/
+int  wsrep_NBO_apply_event(THD* thd, Query_log_event* ev,
+                           wsrep_NBO_apply_state* state);
+
+/*
+  Called on every new view: rolls back operations of nodes that are not
+  members of a primary view, their second phase will not be replicated.
+*/
+void wsrep_NBO_view_change(const wsrep_view_info_t* view);
+
+#endif /* WSREP_NBO_H */
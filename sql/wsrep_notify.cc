@@ -16,9 +16,39 @@
 #include <mysqld.h>
 #include "wsrep_priv.h"
 #include "wsrep_utils.h"
+#include "wsrep_notify.h"
+#include "sql_class.h"
+#include "sql_show.h"   // schema_table_store_record()
+#include "sql_acl.h"    // PROCESS_ACL
+#include "sql_parse.h"  // check_global_access()
+#include "tztime.h"     // Time_zone
 
 const char* wsrep_notify_cmd="";
 
+#define WSREP_NOTIFY_HISTORY   128
+#define WSREP_NOTIFY_LISTENERS 8
+
+struct notify_listener
+{
+  wsrep_notify_listener_t fn;
+  void*                   ctx;
+};
+
+static mysql_mutex_t LOCK_wsrep_notify;
+static mysql_cond_t  COND_wsrep_notify;
+static bool          notify_inited= false;
+static bool          notify_shutdown= false;
+static bool          notifier_started= false;
+static bool          notifier_delivering= false;
+static pthread_t     notifier_thread;
+
+/* event with id N is in events[N % WSREP_NOTIFY_HISTORY] */
+static wsrep_notify_event events[WSREP_NOTIFY_HISTORY];
+static ulonglong          events_next= 1;      /* id of the next event */
+static ulonglong          events_delivered= 0; /* last id taken by notifier */
+
+static notify_listener    listeners[WSREP_NOTIFY_LISTENERS];
+
 static const char* _status_str(wsrep_member_status_t status)
 {
   switch (status)
@@ -32,8 +62,42 @@ static const char* _status_str(wsrep_member_status_t status)
   }
 }
 
-void wsrep_notify_status (wsrep_member_status_t    status,
-                          const wsrep_view_info_t* view)
+static bool _status_is_error(int status)
+{
+  return (status < WSREP_MEMBER_UNDEFINED || status >= WSREP_MEMBER_ERROR);
+}
+
+/* "uuid/name/incoming,..." of view members, NULL if there are none */
+static char* _members_str(const wsrep_view_info_t* view)
+{
+  size_t len= 0;
+
+  for (int i = 0; i < view->memb_num; i++)
+  {
+    len+= WSREP_UUID_STR_LEN + 1 + strlen(view->members[i].name) + 1 +
+          strlen(view->members[i].incoming) + 1;
+  }
+
+  if (!len) return NULL;
+
+  char* const str= (char*)my_malloc(len, MYF(0));
+  if (!str) return NULL;
+
+  size_t off= 0;
+  for (int i = 0; i < view->memb_num; i++)
+  {
+    char uuid_str[40];
+
+    wsrep_uuid_print (&view->members[i].id, uuid_str, sizeof(uuid_str));
+    off+= snprintf (str + off, len - off, "%s%s/%s/%s", i > 0 ? "," : "",
+                    uuid_str, view->members[i].name,
+                    view->members[i].incoming);
+  }
+
+  return str;
+}
+
+static void wsrep_notify_run_cmd(const wsrep_notify_event* ev)
 {
   if (!wsrep_notify_cmd || 0 == strlen(wsrep_notify_cmd))
   {
@@ -49,48 +113,37 @@ void wsrep_notify_status (wsrep_member_status_t    status,
   cmd_off += snprintf (cmd_ptr + cmd_off, cmd_len - cmd_off, "%s",
                        wsrep_notify_cmd);
 
-  if (status >= WSREP_MEMBER_UNDEFINED && status < WSREP_MEMBER_ERROR)
+  if (!_status_is_error(ev->status))
   {
     cmd_off += snprintf (cmd_ptr + cmd_off, cmd_len - cmd_off, " --status %s",
-                         _status_str(status));
+                         _status_str((wsrep_member_status_t)ev->status));
   }
   else
   {
     /* here we preserve provider error codes */
     cmd_off += snprintf (cmd_ptr + cmd_off, cmd_len - cmd_off,
-                         " --status 'Error(%d)'", status);
+                         " --status 'Error(%d)'", ev->status);
   }
 
-  if (0 != view)
+  if (ev->has_view)
   {
-    char uuid_str[40];
-
-    wsrep_uuid_print (&view->state_id.uuid, uuid_str, sizeof(uuid_str));
     cmd_off += snprintf (cmd_ptr + cmd_off, cmd_len - cmd_off,
-                         " --uuid %s", uuid_str);
+                         " --uuid %s", ev->uuid);
 
     cmd_off += snprintf (cmd_ptr + cmd_off, cmd_len - cmd_off,
-                         " --primary %s", view->view >= 0 ? "yes" : "no");
+                         " --primary %s", ev->view_id >= 0 ? "yes" : "no");
 
     cmd_off += snprintf (cmd_ptr + cmd_off, cmd_len - cmd_off,
-                         " --index %d", view->my_idx);
+                         " --index %d", ev->index);
 
-    if (view->memb_num)
+    if (ev->members)
     {
-        cmd_off += snprintf (cmd_ptr + cmd_off, cmd_len - cmd_off, " --members");
-        
-        for (int i = 0; i < view->memb_num; i++)
-        {
-            wsrep_uuid_print (&view->members[i].id, uuid_str, sizeof(uuid_str));
-            cmd_off += snprintf (cmd_ptr + cmd_off, cmd_len - cmd_off,
-                                 "%c%s/%s/%s", i > 0 ? ',' : ' ',
-                                 uuid_str, view->members[i].name,
-                                 view->members[i].incoming);
-        }
+        cmd_off += snprintf (cmd_ptr + cmd_off, cmd_len - cmd_off,
+                             " --members %s", ev->members);
     }
   }
 
-  if (cmd_off == cmd_len)
+  if (cmd_off >= cmd_len)
   {
     WSREP_ERROR("Notification buffer too short (%ld). Aborting notification.",
                cmd_len);
@@ -109,3 +162,272 @@ void wsrep_notify_status (wsrep_member_status_t    status,
   }
 }
 
+static void* wsrep_notifier(void* arg)
+{
+  if (my_thread_init()) return NULL;
+
+  mysql_mutex_lock(&LOCK_wsrep_notify);
+
+  while (true)
+  {
+    while (events_delivered + 1 == events_next && !notify_shutdown)
+      mysql_cond_wait(&COND_wsrep_notify, &LOCK_wsrep_notify);
+
+    /* pending events are delivered before exit */
+    if (events_delivered + 1 == events_next) break;
+
+    ulonglong const oldest= events_next > WSREP_NOTIFY_HISTORY ?
+                            events_next - WSREP_NOTIFY_HISTORY : 1;
+    if (events_delivered + 1 < oldest)
+    {
+      WSREP_WARN("Notifier is behind, %llu node status notifications lost",
+                 oldest - events_delivered - 1);
+      events_delivered= oldest - 1;
+    }
+
+    wsrep_notify_event ev(events[++events_delivered % WSREP_NOTIFY_HISTORY]);
+    if (ev.members) ev.members= my_strdup(ev.members, MYF(0));
+
+    notify_listener to_call[WSREP_NOTIFY_LISTENERS];
+    memcpy(to_call, listeners, sizeof(to_call));
+    notifier_delivering= true;
+    mysql_mutex_unlock(&LOCK_wsrep_notify);
+
+    for (int i= 0; i < WSREP_NOTIFY_LISTENERS; ++i)
+    {
+      if (to_call[i].fn) to_call[i].fn(&ev, to_call[i].ctx);
+    }
+    wsrep_notify_run_cmd(&ev);
+    my_free(ev.members);
+
+    mysql_mutex_lock(&LOCK_wsrep_notify);
+    notifier_delivering= false;
+    mysql_cond_broadcast(&COND_wsrep_notify);
+  }
+
+  mysql_mutex_unlock(&LOCK_wsrep_notify);
+  my_thread_end();
+  return NULL;
+}
+
+void wsrep_notify_status (wsrep_member_status_t    status,
+                          const wsrep_view_info_t* view)
+{
+  if (!notify_inited) return;
+
+  char* const members= (view ? _members_str(view) : NULL);
+
+  mysql_mutex_lock(&LOCK_wsrep_notify);
+
+  if (!notifier_started && !notify_shutdown)
+  {
+    notifier_started= !pthread_create(&notifier_thread, NULL, wsrep_notifier,
+                                      NULL);
+    if (!notifier_started)
+      WSREP_WARN("Failed to start notifier thread: %d (%s)",
+                 errno, strerror(errno));
+  }
+
+  wsrep_notify_event* const ev(&events[events_next % WSREP_NOTIFY_HISTORY]);
+
+  my_free(ev->members);
+  memset(ev, 0, sizeof(*ev));
+  ev->id=     events_next++;
+  ev->time=   my_micro_time();
+  ev->status= status;
+
+  if (0 != view)
+  {
+    ev->has_view=    true;
+    wsrep_uuid_print (&view->state_id.uuid, ev->uuid, sizeof(ev->uuid));
+    ev->view_id=     view->view;
+    ev->index=       view->my_idx;
+    ev->members_num= view->memb_num;
+    ev->members=     members;
+  }
+
+  mysql_cond_broadcast(&COND_wsrep_notify);
+  mysql_mutex_unlock(&LOCK_wsrep_notify);
+}
+
+int wsrep_notify_register(wsrep_notify_listener_t listener, void* ctx)
+{
+  int ret= 1;
+
+  mysql_mutex_lock(&LOCK_wsrep_notify);
+  for (int i= 0; i < WSREP_NOTIFY_LISTENERS; ++i)
+  {
+    if (!listeners[i].fn)
+    {
+      listeners[i].fn=  listener;
+      listeners[i].ctx= ctx;
+      ret= 0;
+      break;
+    }
+  }
+  mysql_mutex_unlock(&LOCK_wsrep_notify);
+
+  return ret;
+}
+
+void wsrep_notify_unregister(wsrep_notify_listener_t listener, void* ctx)
+{
+  mysql_mutex_lock(&LOCK_wsrep_notify);
+  for (int i= 0; i < WSREP_NOTIFY_LISTENERS; ++i)
+  {
+    if (listeners[i].fn == listener && listeners[i].ctx == ctx)
+    {
+      listeners[i].fn=  NULL;
+      listeners[i].ctx= NULL;
+    }
+  }
+  /* notifier may still be calling the listener with an earlier copy */
+  while (notifier_delivering && !pthread_equal(pthread_self(), notifier_thread))
+    mysql_cond_wait(&COND_wsrep_notify, &LOCK_wsrep_notify);
+  mysql_mutex_unlock(&LOCK_wsrep_notify);
+}
+
+void wsrep_notify_init()
+{
+  mysql_mutex_init(key_LOCK_wsrep_notify, &LOCK_wsrep_notify,
+                   MY_MUTEX_INIT_FAST);
+  mysql_cond_init(key_COND_wsrep_notify, &COND_wsrep_notify, NULL);
+  notify_inited= true;
+}
+
+void wsrep_notify_deinit()
+{
+  if (!notify_inited) return;
+
+  mysql_mutex_lock(&LOCK_wsrep_notify);
+  notify_shutdown= true;
+  mysql_cond_broadcast(&COND_wsrep_notify);
+  mysql_mutex_unlock(&LOCK_wsrep_notify);
+
+  if (notifier_started) pthread_join(notifier_thread, NULL);
+
+  notify_inited= false;
+  for (int i= 0; i < WSREP_NOTIFY_HISTORY; ++i)
+  {
+    my_free(events[i].members);
+    events[i].members= NULL;
+  }
+  mysql_cond_destroy(&COND_wsrep_notify);
+  mysql_mutex_destroy(&LOCK_wsrep_notify);
+}
+
+/*
+  INFORMATION_SCHEMA.WSREP_MEMBERSHIP_EVENTS
+*/
+
+static ST_FIELD_INFO membership_events_fields[]=
+{
+  {"EVENT_ID", MY_INT64_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONGLONG, 0,
+   MY_I_S_UNSIGNED, 0, SKIP_OPEN_TABLE},
+  {"EVENT_TIME", 0, MYSQL_TYPE_DATETIME, 0, 0, 0, SKIP_OPEN_TABLE},
+  {"STATUS", 16, MYSQL_TYPE_STRING, 0, 0, 0, SKIP_OPEN_TABLE},
+  {"VIEW_UUID", WSREP_UUID_STR_LEN, MYSQL_TYPE_STRING, 0, MY_I_S_MAYBE_NULL,
+   0, SKIP_OPEN_TABLE},
+  {"VIEW_ID", MY_INT64_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONGLONG, 0,
+   MY_I_S_MAYBE_NULL, 0, SKIP_OPEN_TABLE},
+  {"VIEW_STATUS", 16, MYSQL_TYPE_STRING, 0, MY_I_S_MAYBE_NULL, 0,
+   SKIP_OPEN_TABLE},
+  {"LOCAL_INDEX", MY_INT32_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONG, 0,
+   MY_I_S_MAYBE_NULL, 0, SKIP_OPEN_TABLE},
+  {"MEMBERS_NUM", MY_INT32_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONG, 0,
+   MY_I_S_MAYBE_NULL, 0, SKIP_OPEN_TABLE},
+  {"MEMBERS", PROCESS_LIST_INFO_WIDTH, MYSQL_TYPE_STRING, 0,
+   MY_I_S_MAYBE_NULL, 0, SKIP_OPEN_TABLE},
+  {0, 0, MYSQL_TYPE_NULL, 0, 0, 0, SKIP_OPEN_TABLE}
+};
+
+static int membership_events_fill(THD* thd, TABLE_LIST* tables, Item* cond)
+{
+  DBUG_ENTER("membership_events_fill");
+
+  /* deny access to non-superusers */
+  if (check_global_access(thd, PROCESS_ACL)) DBUG_RETURN(0);
+
+  if (!notify_inited) DBUG_RETURN(0);
+
+  TABLE*              table= tables->table;
+  CHARSET_INFO*       cs= system_charset_info;
+  wsrep_notify_event* snapshot= (wsrep_notify_event*)
+    my_malloc(sizeof(events), MYF(MY_WME));
+  int                 num= 0;
+  int                 ret= 0;
+
+  if (!snapshot) DBUG_RETURN(1);
+
+  /* copy events out, so that view handler doesn't wait for the client */
+  mysql_mutex_lock(&LOCK_wsrep_notify);
+  ulonglong const oldest= events_next > WSREP_NOTIFY_HISTORY ?
+                          events_next - WSREP_NOTIFY_HISTORY : 1;
+  for (ulonglong id= oldest; id < events_next; ++id, ++num)
+  {
+    snapshot[num]= events[id % WSREP_NOTIFY_HISTORY];
+    if (snapshot[num].members)
+      snapshot[num].members= my_strdup(snapshot[num].members, MYF(0));
+  }
+  mysql_mutex_unlock(&LOCK_wsrep_notify);
+
+  for (int i= 0; i < num; ++i)
+  {
+    const wsrep_notify_event* const ev= &snapshot[i];
+    MYSQL_TIME time;
+    char       status[32];
+
+    if (!_status_is_error(ev->status))
+      strmake(status, _status_str((wsrep_member_status_t)ev->status),
+              sizeof(status) - 1);
+    else
+      my_snprintf(status, sizeof(status), "Error(%d)", ev->status);
+
+    restore_record(table, s->default_values);
+    table->field[0]->store(ev->id, true);
+    thd->variables.time_zone->gmt_sec_to_TIME(&time,
+                                              (my_time_t)(ev->time / 1000000));
+    table->field[1]->store_time(&time);
+    table->field[2]->store(status, strlen(status), cs);
+
+    if (ev->has_view)
+    {
+      const char* const view_status(ev->view_id >= 0 ? "Primary" :
+                                                       "Non-primary");
+      table->field[3]->store(ev->uuid, strlen(ev->uuid), cs);
+      table->field[3]->set_notnull();
+      table->field[4]->store(ev->view_id, false);
+      table->field[4]->set_notnull();
+      table->field[5]->store(view_status, strlen(view_status), cs);
+      table->field[5]->set_notnull();
+      table->field[6]->store(ev->index, false);
+      table->field[6]->set_notnull();
+      table->field[7]->store(ev->members_num, false);
+      table->field[7]->set_notnull();
+      if (ev->members)
+      {
+        table->field[8]->store(ev->members, strlen(ev->members), cs);
+        table->field[8]->set_notnull();
+      }
+    }
+
+    if (!ret && schema_table_store_record(thd, table)) ret= 1;
+  }
+
+  for (int i= 0; i < num; ++i) my_free(snapshot[i].members);
+  my_free(snapshot);
+  DBUG_RETURN(ret);
+}
+
+int wsrep_membership_events_init(void* p)
+{
+  ST_SCHEMA_TABLE* schema= (ST_SCHEMA_TABLE*) p;
+  schema->fields_info= membership_events_fields;
+  schema->fill_table=  membership_events_fill;
+  return 0;
+}
+
+int wsrep_membership_events_deinit(void* p)
+{
+  return 0;
+}
@@ -0,0 +1,67 @@
+/* Copyright (C) 2013 Codership Oy <info@codership.com>
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA. */
+
+#ifndef WSREP_NOTIFY_H
+#define WSREP_NOTIFY_H
+
+#include <my_global.h>
+
+/*
+  Node status and membership notifications.
+
+  View handler only records an event in a ring of the most recent events
+  and wakes up the notifier thread. The notifier delivers events in order
+  to the registered listeners and then runs wsrep_notify_cmd, if it is
+  set, so no process is spawned on the view change path. The ring is shown
+  in INFORMATION_SCHEMA.WSREP_MEMBERSHIP_EVENTS. Events overwritten before
+  the notifier got to them are not delivered, which is logged.
+*/
+
+struct wsrep_notify_event
+{
+  ulonglong id;           /* sequence number of the event, from 1 */
+  ulonglong time;         /* my_micro_time() when recorded */
+  int       status;       /* wsrep_member_status_t or provider error */
+  bool      has_view;     /* fields below are set */
+  char      uuid[40];     /* state UUID */
+  longlong  view_id;      /* negative if not primary */
+  int       index;        /* own index in members */
+  int       members_num;
+  char*     members;      /* "uuid/name/incoming,..." */
+};
+
+/*!
+  Listener is called by the notifier thread for every event, in event
+  order. Event is valid only for the duration of the call.
+*/
+typedef void (*wsrep_notify_listener_t)(const wsrep_notify_event* ev,
+                                        void* ctx);
+
+/*!
+  Register listener, e.g. from plugin init. Returns non-zero if the
+  maximum number of listeners is registered already.
+*/
+int  wsrep_notify_register(wsrep_notify_listener_t listener, void* ctx);
+void wsrep_notify_unregister(wsrep_notify_listener_t listener, void* ctx);
+
+void wsrep_notify_init();
+/* delivers pending events and stops the notifier thread */
+void wsrep_notify_deinit();
+
+/* information schema plugin init and deinit */
+int wsrep_membership_events_init(void* p);
+int wsrep_membership_events_deinit(void* p);
+
+#endif /* WSREP_NOTIFY_H */
@@ -24,6 +24,9 @@
 #include "wsrep_priv.h"
 #include "wsrep_utils.h"
 #include "wsrep_xid.h"
+#include "wsrep_sst_native.h"
+#include "binlog.h"
+#include "rpl_gtid.h"
 #include <cstdio>
 #include <cstdlib>
 
@@ -51,7 +54,14 @@ extern const char wsrep_defaults_group_suffix[];
 #define WSREP_SST_OPT_GTID     "--gtid"
 #define WSREP_SST_OPT_BYPASS   "--bypass"
 
+// binlog-specific
+#define WSREP_SST_OPT_GTID_SET     "--gtid-set"
+#define WSREP_SST_OPT_BINLOG_FILES "--binlog-files"
+#define WSREP_SST_OPT_BINLOG_STOP  "--binlog-stop"
+
 #define WSREP_SST_MYSQLDUMP       "mysqldump"
+#define WSREP_SST_BINLOG          "binlog"
+#define WSREP_SST_NATIVE          "native"
 #define WSREP_SST_RSYNC           "rsync"
 #define WSREP_SST_SKIP            "skip"
 #define WSREP_SST_XTRABACKUP      "xtrabackup"
@@ -178,7 +188,8 @@ bool wsrep_before_SE()
   return (wsrep_provider != NULL
           && strcmp (wsrep_provider,   WSREP_NONE)
           && strcmp (wsrep_sst_method, WSREP_SST_SKIP)
-          && strcmp (wsrep_sst_method, WSREP_SST_MYSQLDUMP));
+          && strcmp (wsrep_sst_method, WSREP_SST_MYSQLDUMP)
+          && strcmp (wsrep_sst_method, WSREP_SST_BINLOG));
 }
 
 static bool            sst_complete = false;
@@ -607,6 +618,23 @@ static ssize_t sst_prepare_mysqldump (const char*  addr_in,
   return ret;
 }
 
+/*!
+  Joiner's gtid_executed, which binlog SST request carries after the
+  address, so that donor can send only the transactions that are missing.
+  Returns NULL if binlog or GTIDs are off. Free with my_free().
+*/
+static char* sst_prepare_binlog_gtids ()
+{
+  if (!mysql_bin_log.is_open() || gtid_mode != GTID_MODE_ON) return NULL;
+
+  char* gtids= NULL;
+  global_sid_lock->wrlock();
+  if (gtid_state->get_logged_gtids()->to_string(&gtids) < 0) gtids= NULL;
+  global_sid_lock->unlock();
+
+  return gtids;
+}
+
 static bool SE_initialized = false;
 
 ssize_t wsrep_sst_prepare (void** msg)
@@ -668,10 +696,15 @@ ssize_t wsrep_sst_prepare (void** msg)
   }
 
   ssize_t addr_len= -ENOSYS;
-  if (!strcmp(wsrep_sst_method, WSREP_SST_MYSQLDUMP))
+  char*   gtids= NULL;
+  if (!strcmp(wsrep_sst_method, WSREP_SST_MYSQLDUMP) ||
+      !strcmp(wsrep_sst_method, WSREP_SST_BINLOG))
   {
     addr_len= sst_prepare_mysqldump (addr_in, &addr_out);
     if (addr_len < 0) unireg_abort(1);
+
+    if (!strcmp(wsrep_sst_method, WSREP_SST_BINLOG))
+      gtids= sst_prepare_binlog_gtids();
   }
   else
   {
@@ -692,8 +725,11 @@ ssize_t wsrep_sst_prepare (void** msg)
       return 0;
     }
 
-    addr_len = sst_prepare_other (wsrep_sst_method, sst_auth_real,
-                                  addr_in, &addr_out);
+    if (!strcmp(wsrep_sst_method, WSREP_SST_NATIVE))
+      addr_len = wsrep_sst_native_prepare (addr_in, &addr_out);
+    else
+      addr_len = sst_prepare_other (wsrep_sst_method, sst_auth_real,
+                                    addr_in, &addr_out);
     if (addr_len < 0)
     {
       WSREP_ERROR("Failed to prepare for '%s' SST. Unrecoverable.",
@@ -703,7 +739,9 @@ ssize_t wsrep_sst_prepare (void** msg)
   }
 
   size_t const method_len(strlen(wsrep_sst_method));
-  size_t const msg_len   (method_len + addr_len + 2 /* + auth_len + 1*/);
+  size_t const gtids_len (gtids ? strlen(gtids) + 1 : 0);
+  size_t const msg_len   (method_len + addr_len + 2 /* + auth_len + 1*/
+                          + gtids_len);
 
   *msg = malloc (msg_len);
   if (NULL != *msg) {
@@ -711,6 +749,7 @@ ssize_t wsrep_sst_prepare (void** msg)
     strcpy (method_ptr, wsrep_sst_method);
     char* const addr_ptr(method_ptr + method_len + 1);
     strcpy (addr_ptr, addr_out);
+    if (gtids) strcpy (addr_ptr + addr_len + 1, gtids);
 
     WSREP_INFO ("Prepared SST request: %s|%s", method_ptr, addr_ptr);
   }
@@ -721,6 +760,7 @@ ssize_t wsrep_sst_prepare (void** msg)
   }
 
   if (addr_out != addr_in) /* malloc'ed */ free ((char*)addr_out);
+  my_free (gtids);
 
   return msg_len;
 }
@@ -810,6 +850,197 @@ static int sst_donate_mysqldump (const char*         addr,
   return ret;
 }
 
+/*!
+  Finds what binlog SST has to send to the joiner with gtid_executed
+  joiner_gtids: the GTIDs donor has logged and joiner has not, in
+  *gtid_set, and binary logs that contain them, in *files, the last one
+  up to *stop. Returns non-zero if donor binary log can't bring joiner up
+  to date, e.g. the joiner has diverged or the events are purged.
+*/
+static int sst_binlog_range (const char* joiner_gtids,
+                             char**      gtid_set,
+                             String*     files,
+                             my_off_t*   stop)
+{
+  if (!mysql_bin_log.is_open() || gtid_mode != GTID_MODE_ON ||
+      wsrep_sidno <= 0)
+  {
+    WSREP_INFO("Binlog SST needs binary log and gtid_mode=ON on donor.");
+    return 1;
+  }
+
+  if (!strlen(joiner_gtids))
+  {
+    WSREP_INFO("Binlog SST: joiner did not send its gtid_executed.");
+    return 1;
+  }
+
+  Gtid_set    joiner(global_sid_map);
+  Gtid_set    missing(global_sid_map);
+  Gtid_set    head(global_sid_map);
+  LOG_INFO    cur;
+  const char* errmsg= NULL;
+
+  /*
+    Binary log position and logged GTIDs are updated together in the flush
+    stage under LOCK_log, take both at once.
+  */
+  mysql_mutex_lock(mysql_bin_log.get_log_lock());
+  mysql_bin_log.raw_get_current_log(&cur);
+  global_sid_lock->wrlock();
+  mysql_mutex_unlock(mysql_bin_log.get_log_lock());
+
+  const Gtid_set* const logged= gtid_state->get_logged_gtids();
+
+  if (joiner.add_gtid_text(joiner_gtids) != RETURN_STATUS_OK)
+  {
+    errmsg= "malformed joiner gtid_executed";
+  }
+  else if (joiner.get_max_sidno() < wsrep_sidno ||
+           !Gtid_set::Const_interval_iterator(&joiner, wsrep_sidno).get())
+  {
+    errmsg= "joiner has no transactions of this cluster";
+  }
+  else if (!joiner.is_subset_for_sid(logged, wsrep_sidno, wsrep_sidno))
+  {
+    errmsg= "joiner has transactions of this cluster that donor has not";
+  }
+  else if (missing.add_gtid_set(logged) != RETURN_STATUS_OK ||
+           missing.remove_gtid_set(&joiner) != RETURN_STATUS_OK ||
+           head.add_gtid_set(logged) != RETURN_STATUS_OK ||
+           head.remove_gtid_set(&missing) != RETURN_STATUS_OK)
+  {
+    errmsg= "out of memory";
+  }
+  else if (missing.is_intersection_nonempty(gtid_state->get_lost_gtids()))
+  {
+    errmsg= "missing transactions are purged from donor binary log";
+  }
+  else if (missing.to_string(gtid_set) < 0)
+  {
+    errmsg= "out of memory";
+  }
+  global_sid_lock->unlock();
+
+  if (!errmsg && strlen(*gtid_set))
+  {
+    /* reads Previous_gtids of binary logs, needs own sid map */
+    Sid_map  sid_map(NULL);
+    Gtid_set skip(&sid_map);
+    Gtid     first_gtid;
+    char     first[FN_REFLEN];
+
+    global_sid_lock->wrlock();
+    if (skip.add_gtid_set(&head) != RETURN_STATUS_OK)
+      errmsg= "out of memory";
+    global_sid_lock->unlock();
+
+    first_gtid.clear();
+    if (!errmsg &&
+        !mysql_bin_log.find_first_log_not_in_gtid_set(first, &skip,
+                                                      &first_gtid, &errmsg))
+    {
+      LOG_INFO linfo;
+      int      error= mysql_bin_log.find_log_pos(&linfo, first, true);
+
+      while (!error)
+      {
+        if (files->length()) files->append(' ');
+        files->append(linfo.log_file_name);
+        if (!strcmp(linfo.log_file_name, cur.log_file_name)) break;
+        error= mysql_bin_log.find_next_log(&linfo, true);
+      }
+      if (error) errmsg= "binary log index changed";
+    }
+  }
+
+  if (errmsg)
+  {
+    WSREP_INFO("Binlog SST can't be used: %s.", errmsg);
+    my_free(*gtid_set);
+    *gtid_set= NULL;
+    return 1;
+  }
+
+  *stop= cur.pos;
+  return 0;
+}
+
+/*!
+  Sends transactions that joiner is missing from donor binary log, with
+  mysqlbinlog into joiner mysqld, like mysqldump does. Falls back to
+  mysqldump SST if binary log can't be used.
+*/
+static int sst_donate_binlog (const char*         addr,
+                              const char*         joiner_gtids,
+                              const wsrep_uuid_t* uuid,
+                              const char*         uuid_str,
+                              wsrep_seqno_t       seqno,
+                              bool                bypass,
+                              char**              env) // carries auth info
+{
+  char*    gtid_set= NULL;
+  String   files;
+  my_off_t stop= 0;
+
+  if (bypass || sst_binlog_range (joiner_gtids, &gtid_set, &files, &stop))
+  {
+    if (!bypass) WSREP_INFO("Falling back to mysqldump SST.");
+    return sst_donate_mysqldump (addr, uuid, uuid_str, seqno, bypass, env);
+  }
+
+  if (!strlen(gtid_set))
+  {
+    /* joiner has all transactions, just set the position */
+    my_free(gtid_set);
+    return sst_donate_mysqldump (addr, uuid, uuid_str, seqno, true, env);
+  }
+
+  int const cmd_len= 4096 + strlen(gtid_set) + files.length();
+  wsp::string  cmd_str(cmd_len);
+
+  if (!cmd_str())
+  {
+    WSREP_ERROR("sst_donate_binlog(): "
+                "could not allocate cmd buffer of %d bytes", cmd_len);
+    my_free(gtid_set);
+    return -ENOMEM;
+  }
+
+  if (wsrep_sst_donor_rejects_queries) sst_reject_queries(TRUE);
+
+  int ret= snprintf (cmd_str(), cmd_len,
+                     "wsrep_sst_binlog "
+                     WSREP_SST_OPT_ADDR" '%s' "
+                     WSREP_SST_OPT_LPORT" '%u' "
+                     WSREP_SST_OPT_SOCKET" '%s' "
+                     WSREP_SST_OPT_CONF" '%s' "
+                     WSREP_SST_OPT_GTID" '%s:%lld' "
+                     WSREP_SST_OPT_GTID_SET" '%s' "
+                     WSREP_SST_OPT_BINLOG_FILES" '%s' "
+                     WSREP_SST_OPT_BINLOG_STOP" '%llu'",
+                     addr, mysqld_port, mysqld_unix_port,
+                     wsrep_defaults_file, uuid_str, (long long)seqno,
+                     gtid_set, files.c_ptr_safe(), (ulonglong)stop);
+  my_free(gtid_set);
+
+  if (ret < 0 || ret >= cmd_len)
+  {
+    WSREP_ERROR("sst_donate_binlog(): snprintf() failed: %d", ret);
+    return (ret < 0 ? ret : -EMSGSIZE);
+  }
+
+  WSREP_DEBUG("Running: '%s'", cmd_str());
+
+  ret= sst_run_shell (cmd_str(), env, 3);
+
+  wsrep_gtid_t const state_id = { *uuid, (ret ? WSREP_SEQNO_UNDEFINED : seqno)};
+
+  wsrep->sst_sent (wsrep, &state_id, ret);
+
+  return ret;
+}
+
 wsrep_seqno_t wsrep_locked_seqno= WSREP_SEQNO_UNDEFINED;
 
 static int run_sql_command(THD *thd, const char *query)
@@ -837,7 +1068,30 @@ static int run_sql_command(THD *thd, const char *query)
   return 0;
 }
 
-static int sst_flush_tables(THD* thd)
+/*
+  InnoDB keeps writing while the SST script copies its files, and saves the
+  pages it overwrites to ib_snapshot.done for the joiner to write back.
+*/
+static int sst_snapshot (THD* thd, bool yes)
+{
+  char query_str[64] = { 0, };
+  ssize_t const query_max = sizeof(query_str) - 1;
+  snprintf (query_str, query_max, "SET GLOBAL innodb_snapshot=%d",
+            yes ? 1 : 0);
+
+  if (run_sql_command(thd, query_str))
+  {
+    WSREP_ERROR("Failed to %s InnoDB snapshot", yes ? "begin" : "end");
+    return -1;
+  }
+  return 0;
+}
+
+/*
+  With snapshot, the InnoDB snapshot begins before the state file is written,
+  so that the SST script does not copy InnoDB files any earlier.
+*/
+static int sst_flush_tables(THD* thd, bool snapshot)
 {
   WSREP_INFO("Flushing tables for SST...");
 
@@ -853,6 +1107,7 @@ static int sst_flush_tables(THD* thd)
     /* make sure logs are flushed after global read lock acquired */
     err= reload_acl_and_cache(thd, REFRESH_ENGINE_LOG | REFRESH_BINARY_LOG,
 			      (TABLE_LIST*) 0, &not_used);
+    if (!err && snapshot) err= sst_snapshot (thd, true);
   }
 
   if (err)
@@ -895,6 +1150,18 @@ static int sst_flush_tables(THD* thd)
   return err;
 }
 
+/* native SST reads the state directly, tables_flushed is for scripts */
+static void sst_remove_tables_flushed ()
+{
+  char path[FN_REFLEN];
+  snprintf (path, sizeof(path), "%s/tables_flushed", mysql_real_data_home);
+  if (unlink (path) && errno != ENOENT)
+  {
+    WSREP_WARN("Failed to remove '%s': %d (%s)", path, errno,
+               strerror(errno));
+  }
+}
+
 static void sst_disallow_writes (THD* thd, bool yes)
 {
   char query_str[64] = { 0, };
@@ -916,6 +1183,8 @@ static void* sst_donor_thread (void* a)
 
   int  err= 1;
   bool locked= false;
+  bool disallowed= false;
+  bool snapshot= false;
 
   const char*  out= NULL;
   const size_t out_len= 128;
@@ -944,26 +1213,52 @@ wait_signal:
     if (out)
     {
       const char magic_flush[]= "flush tables";
+      const char magic_snapshot[]= "snapshot";
+      const char magic_snapshot_end[]= "snapshot end";
       const char magic_cont[]= "continue";
       const char magic_done[]= "done";
 
       if (!strcasecmp (out, magic_flush))
       {
-        err= sst_flush_tables (thd.ptr);
+        err= sst_flush_tables (thd.ptr, false);
         if (!err)
         {
           sst_disallow_writes (thd.ptr, true);
           locked= true;
+          disallowed= true;
           goto wait_signal;
         }
       }
+      else if (!strcasecmp (out, magic_snapshot))
+      {
+        /* tables stay locked until "continue", InnoDB only until its
+           snapshot begins */
+        err= sst_flush_tables (thd.ptr, true);
+        snapshot= true; // end it below even if flushing failed
+        if (!err)
+        {
+          locked= true;
+          goto wait_signal;
+        }
+      }
+      else if (!strcasecmp (out, magic_snapshot_end))
+      {
+        if (snapshot)
+        {
+          sst_snapshot (thd.ptr, false);
+          snapshot= false;
+        }
+        err= 0;
+        goto wait_signal;
+      }
       else if (!strcasecmp (out, magic_cont))
       {
         if (locked)
         {
-          sst_disallow_writes (thd.ptr, false);
+          if (disallowed) sst_disallow_writes (thd.ptr, false);
           thd.ptr->global_read_lock.unlock_global_read_lock (thd.ptr);
           locked= false;
+          disallowed= false;
         }
         err=  0;
         goto wait_signal;
@@ -991,9 +1286,11 @@ wait_signal:
                 proc.cmd(), err, strerror(err));
   }
 
+  if (snapshot) sst_snapshot (thd.ptr, false);
+
   if (locked) // don't forget to unlock server before return
   {
-    sst_disallow_writes (thd.ptr, false);
+    if (disallowed) sst_disallow_writes (thd.ptr, false);
     thd.ptr->global_read_lock.unlock_global_read_lock (thd.ptr);
   }
 
@@ -1009,6 +1306,110 @@ wait_signal:
 
 
 
+struct sst_native_arg : public sst_thread_arg
+{
+  const char* state;
+  bool        bypass;
+
+  sst_native_arg (const char* addr, const char* s, bool b)
+    : sst_thread_arg(addr, NULL), state(s), bypass(b)
+  {}
+};
+
+static void* sst_native_donor_thread (void* a)
+{
+  sst_native_arg* arg= (sst_native_arg*)a;
+
+  char* const addr=  strdup(arg->cmd);
+  bool  const bypass= arg->bypass;
+  char  state[64];
+  strmake (state, arg->state, sizeof(state) - 1);
+
+  int  err= addr ? 0 : ENOMEM;
+  bool locked= false;
+
+  wsrep_uuid_t  ret_uuid= WSREP_UUID_UNDEFINED;
+  wsrep_seqno_t ret_seqno= WSREP_SEQNO_UNDEFINED;
+
+  if (!err) err= sst_scan_uuid_seqno (state, &ret_uuid, &ret_seqno);
+
+  wsp::thd thd(FALSE);
+
+  /* Inform server about SST startup and release TO isolation */
+  mysql_mutex_lock   (&arg->lock);
+  arg->err = -err;
+  mysql_cond_signal  (&arg->cond);
+  mysql_mutex_unlock (&arg->lock); //! @note arg is unusable after that.
+
+  if (!err && !bypass)
+  {
+    err= sst_flush_tables (thd.ptr, false);
+    if (!err)
+    {
+      sst_disallow_writes (thd.ptr, true);
+      locked= true;
+
+      /*
+        The copy is of the state tables were locked at, which may be past
+        the one SST was requested at. Report it, like scripts do with the
+        tables_flushed file, or IST would apply write sets the joiner has.
+      */
+      snprintf (state, sizeof(state), "%s:%lld",
+                wsrep_cluster_state_uuid, (long long)wsrep_locked_seqno);
+      err= sst_scan_uuid_seqno (state, &ret_uuid, &ret_seqno);
+      sst_remove_tables_flushed ();
+    }
+  }
+
+  if (!err)
+  {
+    WSREP_INFO("Running native SST to '%s'", addr);
+    err= -wsrep_sst_native_send (addr, state, bypass);
+  }
+
+  if (locked)
+  {
+    sst_disallow_writes (thd.ptr, false);
+    thd.ptr->global_read_lock.unlock_global_read_lock (thd.ptr);
+  }
+
+  free(addr);
+
+  struct wsrep_gtid const state_id = {
+      ret_uuid, err ? WSREP_SEQNO_UNDEFINED : ret_seqno
+  };
+  wsrep->sst_sent (wsrep, &state_id, -err);
+
+  return NULL;
+}
+
+static int sst_donate_native (const char*   addr,
+                              const char*   uuid,
+                              wsrep_seqno_t seqno,
+                              bool          bypass)
+{
+  char state[64];
+  snprintf (state, sizeof(state), "%s:%lld", uuid, (long long) seqno);
+
+  if (!bypass && wsrep_sst_donor_rejects_queries) sst_reject_queries(FALSE);
+
+  pthread_t tmp;
+  sst_native_arg arg(addr, state, bypass);
+  mysql_mutex_lock (&arg.lock);
+  int ret = pthread_create (&tmp, NULL, sst_native_donor_thread, &arg);
+  if (ret)
+  {
+    WSREP_ERROR("sst_donate_native(): pthread_create() failed: %d (%s)",
+                ret, strerror(ret));
+    return -ret;
+  }
+  pthread_detach (tmp);
+  mysql_cond_wait (&arg.cond, &arg.lock);
+
+  WSREP_INFO("sst_native_donor_thread signaled with %d", arg.err);
+  return arg.err;
+}
+
 static int sst_donate_other (const char*   method,
                              const char*   addr,
                              const char*   uuid,
@@ -1115,6 +1516,19 @@ wsrep_cb_status_t wsrep_sst_donate_cb (void* app_ctx, void* recv_ctx,
     ret = sst_donate_mysqldump(data, &current_gtid->uuid, uuid_str,
                                current_gtid->seqno, bypass, env());
   }
+  else if (!strcmp (WSREP_SST_BINLOG, method))
+  {
+    /* joiner gtid_executed follows the address, if it sent it */
+    size_t const addr_len= strlen (data) + 1;
+    const char*  gtids= (method_len + 1 + addr_len < msg_len) ?
+      data + addr_len : "";
+    ret = sst_donate_binlog(data, gtids, &current_gtid->uuid, uuid_str,
+                            current_gtid->seqno, bypass, env());
+  }
+  else if (!strcmp (WSREP_SST_NATIVE, method))
+  {
+    ret = sst_donate_native(data, uuid_str, current_gtid->seqno, bypass);
+  }
   else
   {
     ret = sst_donate_other(method, data, uuid_str,
@@ -0,0 +1,1146 @@
+/* Copyright (C) 2013 Codership Oy <info@codership.com>
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA. */
+
+#include "wsrep_sst_native.h"
+
+#include <mysqld.h>      // mysql_real_data_home
+#include "set_var.h"       // sys_var
+#include "sys_vars_shared.h" // intern_find_sys_var()
+#include "sql_class.h"   // current_thd
+#include <my_dir.h>
+#include <my_atomic.h>
+#include "wsrep_priv.h"
+#include "wsrep_utils.h" // wsrep_host_len()
+#include <zlib.h>
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netdb.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <cerrno>
+#include <set>
+#include <string>
+#include <vector>
+
+ulong   wsrep_sst_native_threads = 4;
+my_bool wsrep_sst_native_compress= FALSE;
+ulong   wsrep_sst_native_timeout = 300;
+
+/*
+  Every connection starts with magic, connection index and the number of
+  connections, followed by records. Connection 0 carries directories and,
+  after all other connections have been closed by donor, the state. All
+  integers are little endian.
+
+  D <name len:2> <name>
+  F <name len:2> <name> <file size:8> <offset:8> <flags:1> <raw len:4>
+    <data len:4> <data>
+  S <state len:2> <state>
+  E
+*/
+#define SST_NATIVE_MAGIC        "WSRPSST1"
+#define SST_NATIVE_MAGIC_LEN    8
+#define SST_NATIVE_HEADER_LEN   (SST_NATIVE_MAGIC_LEN + 4 + 4)
+#define SST_NATIVE_DEFAULT_PORT "4444"
+#define SST_NATIVE_CHUNK        (4UL << 20)
+#define SST_NATIVE_POLL_SEC     1
+
+#define SST_REC_DIR             'D'
+#define SST_REC_FILE            'F'
+#define SST_REC_STATE           'S'
+#define SST_REC_END             'E'
+
+#define SST_FLAG_COMPRESSED     0x1
+
+/* data directory files which belong to the node and are not transferred */
+static bool sst_native_skip(const char* name)
+{
+  static const char* const names[]=
+  {
+    "galera.cache", "grastate.dat", "gvwstate.dat", "auto.cnf", "core",
+    "tables_flushed", "sst_in_progress", "lost+found", NULL
+  };
+  static const char* const suffixes[]=
+  {
+    ".pid", ".err", ".sock", ".pem", ".index", ".tmp", NULL
+  };
+
+  for (const char* const* n= names; *n; ++n)
+    if (!strcmp(name, *n)) return true;
+
+  size_t const len= strlen(name);
+  for (const char* const* s= suffixes; *s; ++s)
+  {
+    size_t const s_len= strlen(*s);
+    if (len > s_len && !strcmp(name + len - s_len, *s)) return true;
+  }
+
+  /* binary and relay logs */
+  if (len > 7 && name[len - 7] == '.' &&
+      strspn(name + len - 6, "0123456789") == 6)
+    return true;
+
+  return false;
+}
+
+/* name received from donor must stay inside data directory */
+static bool sst_native_name_ok(const std::string& name)
+{
+  if (name.empty() || name[0] == '/') return false;
+
+  size_t pos= 0;
+  while (pos <= name.size())
+  {
+    size_t end= name.find('/', pos);
+    if (end == std::string::npos) end= name.size();
+    std::string const part(name, pos, end - pos);
+    if (part.empty() || part == "." || part == "..") return false;
+    pos= end + 1;
+  }
+  return true;
+}
+
+static std::string sst_native_path(const std::string& name)
+{
+  return std::string(mysql_real_data_home) + "/" + name;
+}
+
+/* global value of a string variable, def if it is not set */
+static std::string sst_native_var(const char* name, const char* def)
+{
+  std::string value(def);
+
+  mysql_rwlock_rdlock(&LOCK_system_variables_hash);
+  sys_var* const var= intern_find_sys_var(name, 0);
+  if (var)
+  {
+    mysql_mutex_lock(&LOCK_global_system_variables);
+    const char* const str= *(const char**) var->value_ptr(current_thd,
+                                                          OPT_GLOBAL,
+                                                          NULL);
+    if (str) value= str;
+    mysql_mutex_unlock(&LOCK_global_system_variables);
+  }
+  mysql_rwlock_unlock(&LOCK_system_variables_hash);
+
+  return value;
+}
+
+/* true if directory dir is the data directory or below it */
+static bool sst_native_in_datadir(const std::string& dir)
+{
+  char real_dir[PATH_MAX], real_data[PATH_MAX];
+  if (!realpath(dir.empty() ? "." : dir.c_str(), real_dir) ||
+      !realpath(mysql_real_data_home, real_data))
+    return false;
+
+  size_t const len= strlen(real_data);
+  return (!strncmp(real_dir, real_data, len) &&
+          (real_dir[len] == '\0' || real_dir[len] == '/'));
+}
+
+/*
+  Only the data directory is transferred. InnoDB system tablespace, redo
+  log and undo tablespaces can be configured to live elsewhere, refuse
+  SST then rather than give joiner a data directory without them.
+*/
+static int sst_native_check_innodb()
+{
+  typedef std::pair<const char*, std::string> var_dir;
+  std::vector<var_dir> dirs;
+
+  /* system tablespace files are innodb_data_home_dir + name */
+  std::string const home(sst_native_var("innodb_data_home_dir", "."));
+  std::string const files(sst_native_var("innodb_data_file_path", ""));
+  for (size_t pos= 0; pos < files.size(); )
+  {
+    size_t const end= std::min(files.find(';', pos), files.size());
+    std::string const name(files, pos,
+                           std::min(files.find(':', pos), end) - pos);
+    std::string const path(home.empty() ? name : home + "/" + name);
+    size_t const slash= path.rfind('/');
+    dirs.push_back(var_dir("innodb_data_file_path",
+                           slash == std::string::npos ?
+                           std::string(".") : path.substr(0, slash)));
+    pos= end + 1;
+  }
+
+  dirs.push_back(var_dir("innodb_log_group_home_dir",
+                         sst_native_var("innodb_log_group_home_dir", ".")));
+  dirs.push_back(var_dir("innodb_undo_directory",
+                         sst_native_var("innodb_undo_directory", ".")));
+
+  for (size_t i= 0; i < dirs.size(); ++i)
+  {
+    if (!sst_native_in_datadir(dirs[i].second))
+    {
+      WSREP_ERROR("SST: native method transfers only the data directory "
+                  "'%s', but %s puts InnoDB files in '%s'. Move them into "
+                  "the data directory or use another wsrep_sst_method.",
+                  mysql_real_data_home, dirs[i].first,
+                  dirs[i].second.c_str());
+      return -EINVAL;
+    }
+  }
+  return 0;
+}
+
+/*
+  Split "host[:port]" address, host may be an IPv6 address in brackets.
+*/
+static void sst_native_split(const char* addr, std::string* host,
+                             std::string* port)
+{
+  size_t const addr_len= strlen(addr);
+  size_t const host_len= wsrep_host_len(addr, addr_len);
+
+  host->assign(addr, host_len);
+  if (host->size() > 1 && (*host)[0] == '[' &&
+      (*host)[host->size() - 1] == ']')
+    *host= host->substr(1, host->size() - 2);
+
+  if (host_len + 1 < addr_len)
+    port->assign(addr + host_len + 1);
+  else
+    port->assign(SST_NATIVE_DEFAULT_PORT);
+}
+
+static int sst_native_send(int fd, const void* buf, size_t len)
+{
+  const char* ptr= static_cast<const char*>(buf);
+  while (len > 0)
+  {
+    ssize_t const n= send(fd, ptr, len, MSG_NOSIGNAL);
+    if (n < 0)
+    {
+      if (errno == EINTR) continue;
+      return -errno;
+    }
+    ptr+= n;
+    len-= n;
+  }
+  return 0;
+}
+
+static int sst_native_send_header(int fd, uint index, uint total)
+{
+  uchar header[SST_NATIVE_HEADER_LEN];
+  memcpy(header, SST_NATIVE_MAGIC, SST_NATIVE_MAGIC_LEN);
+  int4store(header + SST_NATIVE_MAGIC_LEN, index);
+  int4store(header + SST_NATIVE_MAGIC_LEN + 4, total);
+  return sst_native_send(fd, header, sizeof(header));
+}
+
+/* send record consisting of type and string */
+static int sst_native_send_str(int fd, char type, const std::string& str)
+{
+  uchar header[3];
+  header[0]= type;
+  int2store(header + 1, str.size());
+  int err= sst_native_send(fd, header, sizeof(header));
+  if (!err) err= sst_native_send(fd, str.data(), str.size());
+  return err;
+}
+
+/* create directory and its parents, ignoring existing ones */
+static int sst_native_mkdir(const std::string& name)
+{
+  for (size_t pos= name.find('/'); ; pos= name.find('/', pos + 1))
+  {
+    std::string const path(sst_native_path(name.substr(0, pos)));
+    if (mkdir(path.c_str(), 0700) && errno != EEXIST) return -errno;
+    if (pos == std::string::npos) break;
+  }
+  return 0;
+}
+
+/*
+  Donor
+*/
+class sst_native_donor
+{
+public:
+
+  sst_native_donor(const char* addr, bool compress)
+    : addr_(addr), compress_(compress), next_(0), err_(0)
+  {}
+
+  /* collect directories and chunks to send */
+  int scan(const std::string& dir);
+
+  int  connect();
+  int  send_dirs(int fd);
+  void send_chunks(int fd);
+
+  size_t chunks() const { return chunks_.size(); }
+  int    error()        { return my_atomic_load32(&err_); }
+  void   set_error(int err)
+  {
+    int32 expected= 0;
+    my_atomic_cas32(&err_, &expected, err);
+  }
+
+private:
+
+  struct file
+  {
+    std::string name;
+    ulonglong   size;
+  };
+
+  struct chunk
+  {
+    size_t    file;
+    ulonglong offset;
+    size_t    len;
+  };
+
+  int send_chunk(int fd, int file_fd, const chunk& c,
+                 uchar* raw, uchar* zbuf, size_t zbuf_len);
+
+  const char*              addr_;
+  bool                     compress_;
+  std::vector<std::string> dirs_;
+  std::vector<file>        files_;
+  std::vector<chunk>       chunks_;
+  volatile int64           next_; /* next chunk to send */
+  volatile int32           err_;  /* first error */
+};
+
+int sst_native_donor::scan(const std::string& dir)
+{
+  std::string const path(sst_native_path(dir));
+  MY_DIR* const entries= my_dir(path.c_str(), MYF(MY_WANT_STAT));
+  if (!entries)
+  {
+    WSREP_ERROR("SST: failed to read directory '%s'", path.c_str());
+    return -EIO;
+  }
+
+  int err= 0;
+  for (uint i= 0; !err && i < entries->number_off_files; ++i)
+  {
+    const FILEINFO* const entry= &entries->dir_entry[i];
+    if (!strcmp(entry->name, ".") || !strcmp(entry->name, "..") ||
+        sst_native_skip(entry->name))
+      continue;
+
+    std::string const name(dir.empty() ? std::string(entry->name)
+                                       : dir + "/" + entry->name);
+    if (MY_S_ISDIR(entry->mystat->st_mode))
+    {
+      dirs_.push_back(name);
+      err= scan(name);
+    }
+    else if (MY_S_ISREG(entry->mystat->st_mode))
+    {
+      file const f= { name, (ulonglong) entry->mystat->st_size };
+      files_.push_back(f);
+
+      ulonglong offset= 0;
+      do
+      {
+        size_t const len= (size_t) std::min<ulonglong>(f.size - offset,
+                                                       SST_NATIVE_CHUNK);
+        chunk const c= { files_.size() - 1, offset, len };
+        chunks_.push_back(c);
+        offset+= len;
+      }
+      while (offset < f.size);
+    }
+  }
+
+  my_dirend(entries);
+  return err;
+}
+
+int sst_native_donor::connect()
+{
+  std::string host, port;
+  sst_native_split(addr_, &host, &port);
+
+  struct addrinfo hints;
+  memset(&hints, 0, sizeof(hints));
+  hints.ai_family=   AF_UNSPEC;
+  hints.ai_socktype= SOCK_STREAM;
+
+  struct addrinfo* res= NULL;
+  int const gai_err= getaddrinfo(host.c_str(), port.c_str(), &hints, &res);
+  if (gai_err)
+  {
+    WSREP_ERROR("SST: failed to resolve '%s': %s", addr_,
+                gai_strerror(gai_err));
+    return -EINVAL;
+  }
+
+  int fd= -1;
+  int err= -ECONNREFUSED;
+  for (struct addrinfo* ai= res; ai && fd < 0; ai= ai->ai_next)
+  {
+    fd= socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+    if (fd < 0)
+    {
+      err= -errno;
+      continue;
+    }
+    if (::connect(fd, ai->ai_addr, ai->ai_addrlen))
+    {
+      err= -errno;
+      close(fd);
+      fd= -1;
+    }
+  }
+  freeaddrinfo(res);
+
+  if (fd < 0)
+  {
+    WSREP_ERROR("SST: failed to connect to '%s': %d (%s)",
+                addr_, -err, strerror(-err));
+    return err;
+  }
+  return fd;
+}
+
+int sst_native_donor::send_dirs(int fd)
+{
+  int err= 0;
+  for (size_t i= 0; !err && i < dirs_.size(); ++i)
+    err= sst_native_send_str(fd, SST_REC_DIR, dirs_[i]);
+  return err;
+}
+
+int sst_native_donor::send_chunk(int fd, int file_fd, const chunk& c,
+                                 uchar* raw, uchar* zbuf, size_t zbuf_len)
+{
+  const file& f= files_[c.file];
+
+  size_t done= 0;
+  while (done < c.len)
+  {
+    ssize_t const n= pread(file_fd, raw + done, c.len - done,
+                           c.offset + done);
+    if (n < 0 && errno == EINTR) continue;
+    if (n <= 0)
+    {
+      int const err= (n < 0 ? errno : EIO);
+      WSREP_ERROR("SST: failed to read '%s' at %llu: %d (%s)",
+                  f.name.c_str(), c.offset + done, err, strerror(err));
+      return -err;
+    }
+    done+= n;
+  }
+
+  const uchar* data= raw;
+  size_t       data_len= c.len;
+  uchar        flags= 0;
+  if (zbuf && c.len > 0)
+  {
+    uLongf z_len= zbuf_len;
+    if (compress2(zbuf, &z_len, raw, c.len, 1) == Z_OK && z_len < c.len)
+    {
+      data=     zbuf;
+      data_len= z_len;
+      flags|=   SST_FLAG_COMPRESSED;
+    }
+  }
+
+  uchar header[8 + 8 + 1 + 4 + 4];
+  int8store(header, f.size);
+  int8store(header + 8, c.offset);
+  header[16]= flags;
+  int4store(header + 17, c.len);
+  int4store(header + 21, data_len);
+
+  int err= sst_native_send_str(fd, SST_REC_FILE, f.name);
+  if (!err) err= sst_native_send(fd, header, sizeof(header));
+  if (!err) err= sst_native_send(fd, data, data_len);
+  return err;
+}
+
+void sst_native_donor::send_chunks(int fd)
+{
+  size_t const zbuf_len= compress_ ? compressBound(SST_NATIVE_CHUNK) : 0;
+  uchar* const raw=  (uchar*) my_malloc(SST_NATIVE_CHUNK, MYF(MY_WME));
+  uchar* const zbuf= zbuf_len ? (uchar*) my_malloc(zbuf_len, MYF(MY_WME))
+                              : NULL;
+  if (!raw || (zbuf_len && !zbuf))
+  {
+    set_error(-ENOMEM);
+    my_free(raw);
+    my_free(zbuf);
+    return;
+  }
+
+  size_t file_idx= files_.size();
+  int    file_fd=  -1;
+
+  while (!error())
+  {
+    size_t const idx= (size_t) my_atomic_add64(&next_, 1);
+    if (idx >= chunks_.size()) break;
+
+    const chunk& c= chunks_[idx];
+    if (c.file != file_idx)
+    {
+      if (file_fd >= 0) close(file_fd);
+      file_idx= c.file;
+      std::string const path(sst_native_path(files_[file_idx].name));
+      file_fd= open(path.c_str(), O_RDONLY);
+      if (file_fd < 0)
+      {
+        int const err= errno;
+        WSREP_ERROR("SST: failed to open '%s': %d (%s)",
+                    path.c_str(), err, strerror(err));
+        set_error(-err);
+        break;
+      }
+    }
+
+    int const err= send_chunk(fd, file_fd, c, raw, zbuf, zbuf_len);
+    if (err) set_error(err);
+  }
+
+  if (file_fd >= 0) close(file_fd);
+  my_free(zbuf);
+  my_free(raw);
+
+  if (!error())
+  {
+    const uchar end= SST_REC_END;
+    int const err= sst_native_send(fd, &end, 1);
+    if (err) set_error(err);
+  }
+}
+
+struct sst_native_stream
+{
+  sst_native_donor* donor;
+  int               fd;
+  pthread_t         thread;
+};
+
+static void* sst_native_stream_thread(void* arg)
+{
+  sst_native_stream* const stream= static_cast<sst_native_stream*>(arg);
+  stream->donor->send_chunks(stream->fd);
+  return NULL;
+}
+
+int wsrep_sst_native_send(const char* addr, const char* state, bool bypass)
+{
+  sst_native_donor donor(addr, wsrep_sst_native_compress);
+
+  int err= 0;
+  if (!bypass)
+  {
+    err= sst_native_check_innodb();
+    if (!err) err= donor.scan("");
+    if (err) return err;
+  }
+
+  /* connection 0 is for control, the rest send file chunks */
+  size_t const streams= std::min<size_t>(wsrep_sst_native_threads,
+                                         donor.chunks());
+  uint const total= 1 + streams;
+
+  int const control_fd= donor.connect();
+  if (control_fd < 0) return control_fd;
+
+  err= sst_native_send_header(control_fd, 0, total);
+  if (!err) err= donor.send_dirs(control_fd);
+
+  std::vector<sst_native_stream> threads(streams);
+  size_t started= 0;
+  for (; !err && started < streams; ++started)
+  {
+    sst_native_stream* const stream= &threads[started];
+    stream->donor= &donor;
+    stream->fd=    donor.connect();
+    if (stream->fd < 0)
+    {
+      err= stream->fd;
+      break;
+    }
+    if ((err= sst_native_send_header(stream->fd, started + 1, total)) ||
+        (err= pthread_create(&stream->thread, NULL,
+                             sst_native_stream_thread, stream) ? -EAGAIN : 0))
+    {
+      close(stream->fd);
+      break;
+    }
+  }
+
+  if (err) donor.set_error(err);
+
+  for (size_t i= 0; i < started; ++i)
+  {
+    pthread_join(threads[i].thread, NULL);
+    close(threads[i].fd);
+  }
+  if (!err) err= donor.error();
+
+  /* joiner treats missing state as failure */
+  if (!err) err= sst_native_send_str(control_fd, SST_REC_STATE, state);
+  const uchar end= SST_REC_END;
+  int const end_err= sst_native_send(control_fd, &end, 1);
+  close(control_fd);
+
+  if (!err) err= end_err;
+  if (err)
+  {
+    WSREP_ERROR("SST: sending to '%s' failed: %d (%s)",
+                addr, -err, strerror(-err));
+  }
+  else
+  {
+    WSREP_INFO("SST: sent %zu chunks over %zu connections to '%s'",
+               donor.chunks(), streams, addr);
+  }
+  return err;
+}
+
+/*
+  Joiner
+*/
+class sst_native_joiner
+{
+public:
+
+  explicit sst_native_joiner(int listen_fd)
+    : listen_fd_(listen_fd), total_(0), received_(0), err_(0),
+      control_ended_(false), state_received_(false)
+  {
+    mysql_mutex_init(key_LOCK_wsrep_sst_thread, &lock_, MY_MUTEX_INIT_FAST);
+  }
+
+  ~sst_native_joiner()
+  {
+    close(listen_fd_);
+    mysql_mutex_destroy(&lock_);
+  }
+
+  void run();
+
+private:
+
+  struct stream
+  {
+    sst_native_joiner* joiner;
+    int                fd;
+    uint               index;
+    pthread_t          thread;
+  };
+
+  static void* stream_thread(void* arg);
+
+  int  recv_buf(int fd, void* buf, size_t len);
+  int  recv_str(int fd, std::string* str);
+  int  receive(int fd, bool control);
+  int  receive_file(int fd, std::string* open_name, int* open_fd,
+                    std::vector<uchar>* raw, std::vector<uchar>* data);
+  int  accept_stream(stream* s);
+  int  remove_stale(const std::string& dir);
+  void set_error(int err);
+
+  int                   listen_fd_;
+  uint                  total_;
+  volatile int64        received_; /* bytes received on all connections */
+  int                   err_;
+  bool                  control_ended_;
+  bool                  state_received_;
+  std::string           state_;
+  std::set<std::string> files_; /* files received, truncated to size */
+  std::set<std::string> dirs_;
+  mysql_mutex_t         lock_;
+};
+
+void sst_native_joiner::set_error(int err)
+{
+  mysql_mutex_lock(&lock_);
+  if (!err_) err_= err;
+  mysql_mutex_unlock(&lock_);
+}
+
+/*
+  Joiner sockets have a receive timeout of SST_NATIVE_POLL_SEC, so that
+  a donor which died or stalled does not keep joiner waiting forever.
+  A connection may stay idle while the others receive data, control
+  connection does until donor sends the state.
+*/
+int sst_native_joiner::recv_buf(int fd, void* buf, size_t len)
+{
+  char* ptr=  static_cast<char*>(buf);
+  ulong idle= 0;
+  int64 seen= my_atomic_load64(&received_);
+  while (len > 0)
+  {
+    ssize_t const n= recv(fd, ptr, len, 0);
+    if (n < 0)
+    {
+      if (errno == EINTR) continue;
+      if (errno != EAGAIN && errno != EWOULDBLOCK) return -errno;
+
+      int64 const now= my_atomic_load64(&received_);
+      if (now != seen)
+      {
+        seen= now;
+        idle= 0;
+      }
+      else
+        idle+= SST_NATIVE_POLL_SEC;
+
+      mysql_mutex_lock(&lock_);
+      bool const failed= (err_ != 0);
+      mysql_mutex_unlock(&lock_);
+      if (abort_loop || failed) return -ECANCELED;
+      if (idle >= wsrep_sst_native_timeout) return -ETIMEDOUT;
+      continue;
+    }
+    if (n == 0) return -ECONNRESET;
+    my_atomic_add64(&received_, n);
+    ptr+= n;
+    len-= n;
+  }
+  return 0;
+}
+
+int sst_native_joiner::recv_str(int fd, std::string* str)
+{
+  uchar len_buf[2];
+  int err= recv_buf(fd, len_buf, sizeof(len_buf));
+  if (err) return err;
+
+  size_t const len= uint2korr(len_buf);
+  str->resize(len);
+  return (len ? recv_buf(fd, &(*str)[0], len) : 0);
+}
+
+int sst_native_joiner::receive_file(int fd, std::string* open_name,
+                                    int* open_fd, std::vector<uchar>* raw,
+                                    std::vector<uchar>* data)
+{
+  std::string name;
+  uchar       header[8 + 8 + 1 + 4 + 4];
+
+  int err= recv_str(fd, &name);
+  if (!err) err= recv_buf(fd, header, sizeof(header));
+  if (err) return err;
+
+  ulonglong const file_size= uint8korr(header);
+  ulonglong const offset=    uint8korr(header + 8);
+  uchar const     flags=     header[16];
+  size_t const    raw_len=   uint4korr(header + 17);
+  size_t const    data_len=  uint4korr(header + 21);
+
+  if (!sst_native_name_ok(name) || raw_len > SST_NATIVE_CHUNK ||
+      data_len > compressBound(SST_NATIVE_CHUNK) ||
+      (!(flags & SST_FLAG_COMPRESSED) && data_len != raw_len))
+  {
+    WSREP_ERROR("SST: malformed file record for '%s'", name.c_str());
+    return -EPROTO;
+  }
+
+  data->resize(std::max<size_t>(data_len, 1));
+  if ((err= recv_buf(fd, &(*data)[0], data_len))) return err;
+
+  const uchar* buf= &(*data)[0];
+  if (flags & SST_FLAG_COMPRESSED)
+  {
+    raw->resize(std::max<size_t>(raw_len, 1));
+    uLongf len= raw_len;
+    if (uncompress(&(*raw)[0], &len, buf, data_len) != Z_OK ||
+        len != raw_len)
+    {
+      WSREP_ERROR("SST: failed to decompress '%s' at %llu",
+                  name.c_str(), offset);
+      return -EPROTO;
+    }
+    buf= &(*raw)[0];
+  }
+
+  if (name != *open_name)
+  {
+    if (*open_fd >= 0) close(*open_fd);
+    *open_fd= -1;
+    open_name->clear();
+
+    size_t const slash= name.rfind('/');
+    if (slash != std::string::npos &&
+        (err= sst_native_mkdir(name.substr(0, slash))))
+      return err;
+
+    mysql_mutex_lock(&lock_);
+    bool const first= files_.insert(name).second;
+    mysql_mutex_unlock(&lock_);
+
+    std::string const path(sst_native_path(name));
+    *open_fd= open(path.c_str(), O_WRONLY | O_CREAT, 0660);
+    if (*open_fd < 0 ||
+        /* other chunks only write below file_size, so this is safe */
+        (first && ftruncate(*open_fd, file_size)))
+    {
+      err= -errno;
+      WSREP_ERROR("SST: failed to create '%s': %d (%s)",
+                  path.c_str(), -err, strerror(-err));
+      return err;
+    }
+    *open_name= name;
+  }
+
+  size_t done= 0;
+  while (done < raw_len)
+  {
+    ssize_t const n= pwrite(*open_fd, buf + done, raw_len - done,
+                            offset + done);
+    if (n < 0 && errno == EINTR) continue;
+    if (n <= 0)
+    {
+      err= (n < 0 ? -errno : -EIO);
+      WSREP_ERROR("SST: failed to write '%s' at %llu: %d (%s)",
+                  name.c_str(), offset + done, -err, strerror(-err));
+      return err;
+    }
+    done+= n;
+  }
+  return 0;
+}
+
+int sst_native_joiner::receive(int fd, bool control)
+{
+  std::string        open_name;
+  int                open_fd= -1;
+  std::vector<uchar> raw, data;
+  int                err= 0;
+
+  for (;;)
+  {
+    uchar type;
+    if ((err= recv_buf(fd, &type, 1))) break;
+
+    if (type == SST_REC_END) break;
+
+    switch (type)
+    {
+    case SST_REC_FILE:
+      err= receive_file(fd, &open_name, &open_fd, &raw, &data);
+      break;
+    case SST_REC_DIR:
+    {
+      std::string name;
+      if ((err= recv_str(fd, &name))) break;
+      if (!sst_native_name_ok(name))
+      {
+        err= -EPROTO;
+        break;
+      }
+      if ((err= sst_native_mkdir(name))) break;
+      mysql_mutex_lock(&lock_);
+      dirs_.insert(name);
+      mysql_mutex_unlock(&lock_);
+      break;
+    }
+    case SST_REC_STATE:
+    {
+      std::string state;
+      if (!control) err= -EPROTO;
+      else if (!(err= recv_str(fd, &state)))
+      {
+        mysql_mutex_lock(&lock_);
+        state_=          state;
+        state_received_= true;
+        mysql_mutex_unlock(&lock_);
+      }
+      break;
+    }
+    default:
+      WSREP_ERROR("SST: unknown record type %d", (int)type);
+      err= -EPROTO;
+    }
+    if (err) break;
+  }
+
+  if (open_fd >= 0 && (fsync(open_fd) || close(open_fd)) && !err) err= -errno;
+  return err;
+}
+
+void* sst_native_joiner::stream_thread(void* arg)
+{
+  stream* const s= static_cast<stream*>(arg);
+  sst_native_joiner* const joiner= s->joiner;
+
+  int const err= joiner->receive(s->fd, s->index == 0);
+  if (err)
+  {
+    WSREP_ERROR("SST: receiving on connection %u failed: %d (%s)",
+                s->index, -err, strerror(-err));
+    joiner->set_error(err);
+  }
+  close(s->fd);
+
+  if (s->index == 0)
+  {
+    mysql_mutex_lock(&joiner->lock_);
+    joiner->control_ended_= true;
+    mysql_mutex_unlock(&joiner->lock_);
+  }
+  return NULL;
+}
+
+int sst_native_joiner::accept_stream(stream* s)
+{
+  s->joiner= this;
+  s->fd=     accept(listen_fd_, NULL, NULL);
+  if (s->fd < 0) return -errno;
+
+  struct timeval const tv= { SST_NATIVE_POLL_SEC, 0 };
+  setsockopt(s->fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+  uchar header[SST_NATIVE_HEADER_LEN];
+  int err= recv_buf(s->fd, header, sizeof(header));
+  if (!err)
+  {
+    uint const index= uint4korr(header + SST_NATIVE_MAGIC_LEN);
+    uint const total= uint4korr(header + SST_NATIVE_MAGIC_LEN + 4);
+    if (memcmp(header, SST_NATIVE_MAGIC, SST_NATIVE_MAGIC_LEN) ||
+        total == 0 || total > WSREP_SST_NATIVE_THREADS_MAX + 1 ||
+        index >= total || (total_ && total != total_))
+    {
+      WSREP_ERROR("SST: malformed connection header");
+      err= -EPROTO;
+    }
+    else
+    {
+      total_=   total;
+      s->index= index;
+    }
+  }
+
+  if (!err && pthread_create(&s->thread, NULL, stream_thread, s))
+    err= -EAGAIN;
+
+  if (err) close(s->fd);
+  return err;
+}
+
+/* remove files which donor does not have, like rsync --delete */
+int sst_native_joiner::remove_stale(const std::string& dir)
+{
+  std::string const path(sst_native_path(dir));
+  MY_DIR* const entries= my_dir(path.c_str(), MYF(MY_WANT_STAT));
+  if (!entries) return -EIO;
+
+  int err= 0;
+  for (uint i= 0; !err && i < entries->number_off_files; ++i)
+  {
+    const FILEINFO* const entry= &entries->dir_entry[i];
+    if (!strcmp(entry->name, ".") || !strcmp(entry->name, "..") ||
+        sst_native_skip(entry->name))
+      continue;
+
+    std::string const name(dir.empty() ? std::string(entry->name)
+                                       : dir + "/" + entry->name);
+    std::string const name_path(sst_native_path(name));
+    if (MY_S_ISDIR(entry->mystat->st_mode))
+    {
+      err= remove_stale(name);
+      if (!err && !dirs_.count(name) && rmdir(name_path.c_str()) &&
+          errno != ENOTEMPTY)
+        err= -errno;
+    }
+    else if (!files_.count(name))
+    {
+      WSREP_DEBUG("SST: removing '%s'", name_path.c_str());
+      if (unlink(name_path.c_str())) err= -errno;
+    }
+  }
+
+  my_dirend(entries);
+  return err;
+}
+
+void sst_native_joiner::run()
+{
+  std::vector<stream> streams(WSREP_SST_NATIVE_THREADS_MAX + 1);
+  uint  accepted= 0;
+  int   err= 0;
+  ulong idle= 0;
+  int64 seen= 0;
+
+  WSREP_INFO("SST: waiting for donor connections");
+
+  while (!err && (total_ == 0 || accepted < total_))
+  {
+    if (abort_loop)
+    {
+      err= -ECANCELED;
+      break;
+    }
+    if (idle >= wsrep_sst_native_timeout)
+    {
+      WSREP_ERROR("SST: nothing received from donor in %lu seconds", idle);
+      err= -ETIMEDOUT;
+      break;
+    }
+
+    mysql_mutex_lock(&lock_);
+    bool const control_ended= control_ended_;
+    mysql_mutex_unlock(&lock_);
+    if (control_ended)
+    {
+      /* donor does not open more connections after closing control one */
+      err= -ECONNABORTED;
+      break;
+    }
+
+    struct pollfd pfd= { listen_fd_, POLLIN, 0 };
+    int const n= poll(&pfd, 1, SST_NATIVE_POLL_SEC * 1000);
+    if (n < 0 && errno != EINTR) err= -errno;
+    if (n == 0)
+    {
+      int64 const now= my_atomic_load64(&received_);
+      idle= (now == seen ? idle + SST_NATIVE_POLL_SEC : 0);
+      seen= now;
+    }
+    if (n <= 0) continue;
+
+    err= accept_stream(&streams[accepted]);
+    if (!err) ++accepted;
+    idle= 0;
+  }
+
+  /* connections already accepted stop receiving */
+  if (err) set_error(err);
+  for (uint i= 0; i < accepted; ++i) pthread_join(streams[i].thread, NULL);
+
+  if (!err) err= err_;
+  if (!err && !state_received_)
+  {
+    WSREP_ERROR("SST: donor did not send state");
+    err= -ECONNABORTED;
+  }
+  /* with bypass donor sends only state */
+  if (!err && !files_.empty()) err= remove_stale("");
+
+  wsrep_uuid_t  uuid=  WSREP_UUID_UNDEFINED;
+  wsrep_seqno_t seqno= WSREP_SEQNO_UNDEFINED;
+  if (!err)
+  {
+    int const offt= wsrep_uuid_scan(state_.c_str(), state_.size(), &uuid);
+    if (offt > 0 && (size_t)offt < state_.size() && state_[offt] == ':')
+      seqno= strtoll(state_.c_str() + offt + 1, NULL, 10);
+    else
+      err= -EINVAL;
+  }
+
+  if (err)
+  {
+    WSREP_ERROR("SST: receiving state failed: %d (%s)", -err, strerror(-err));
+    uuid=  WSREP_UUID_UNDEFINED;
+    seqno= err;
+  }
+  else
+  {
+    WSREP_INFO("SST: received %zu files, state %s",
+               files_.size(), state_.c_str());
+  }
+
+  wsrep_sst_complete(&uuid, seqno, true);
+}
+
+static void* sst_native_joiner_thread(void* arg)
+{
+  sst_native_joiner* const joiner= static_cast<sst_native_joiner*>(arg);
+  joiner->run();
+  delete joiner;
+  return NULL;
+}
+
+ssize_t wsrep_sst_native_prepare(const char* addr_in, const char** addr_out)
+{
+  std::string host, port;
+  sst_native_split(addr_in, &host, &port);
+
+  struct addrinfo hints;
+  memset(&hints, 0, sizeof(hints));
+  hints.ai_family=   AF_UNSPEC;
+  hints.ai_socktype= SOCK_STREAM;
+  hints.ai_flags=    AI_PASSIVE;
+
+  struct addrinfo* res= NULL;
+  int const gai_err= getaddrinfo(host.c_str(), port.c_str(), &hints, &res);
+  if (gai_err)
+  {
+    WSREP_ERROR("SST: failed to resolve '%s': %s", addr_in,
+                gai_strerror(gai_err));
+    return -EINVAL;
+  }
+
+  int fd= -1;
+  int err= -EADDRNOTAVAIL;
+  for (struct addrinfo* ai= res; ai && fd < 0; ai= ai->ai_next)
+  {
+    fd= socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+    if (fd < 0)
+    {
+      err= -errno;
+      continue;
+    }
+    int const on= 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+    if (bind(fd, ai->ai_addr, ai->ai_addrlen) ||
+        listen(fd, WSREP_SST_NATIVE_THREADS_MAX + 1))
+    {
+      err= -errno;
+      close(fd);
+      fd= -1;
+    }
+  }
+  freeaddrinfo(res);
+
+  if (fd < 0)
+  {
+    WSREP_ERROR("SST: failed to listen at '%s': %d (%s)",
+                addr_in, -err, strerror(-err));
+    return err;
+  }
+
+  size_t const host_len= wsrep_host_len(addr_in, strlen(addr_in));
+  size_t const out_len= host_len + 1 + port.size() + 1;
+  char* const out= (char*) malloc(out_len);
+  if (!out)
+  {
+    close(fd);
+    return -ENOMEM;
+  }
+  snprintf(out, out_len, "%.*s:%s", (int)host_len, addr_in, port.c_str());
+
+  sst_native_joiner* const joiner= new sst_native_joiner(fd);
+  pthread_t tmp;
+  if ((err= pthread_create(&tmp, NULL, sst_native_joiner_thread, joiner)))
+  {
+    WSREP_ERROR("SST: pthread_create() failed: %d (%s)", err, strerror(err));
+    delete joiner;
+    free(out);
+    return -err;
+  }
+  pthread_detach(tmp);
+
+  *addr_out= out;
+  return strlen(out);
+}
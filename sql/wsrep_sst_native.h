@@ -0,0 +1,54 @@
+/* Copyright (C) 2013 Codership Oy <info@codership.com>
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA. */
+
+#ifndef WSREP_SST_NATIVE_H
+#define WSREP_SST_NATIVE_H
+
+#include <my_global.h>
+
+/*
+  Built-in physical state snapshot transfer ("native" SST method).
+
+  Donor copies the data directory while the server is locked with
+  FLUSH TABLES WITH READ LOCK and innodb_disallow_writes, so the copy
+  is the same as after a clean crash and joiner brings it to a consistent
+  state with InnoDB crash recovery. Files are split in chunks which are
+  sent over several connections in parallel, optionally compressed.
+*/
+
+/* system variables */
+extern ulong   wsrep_sst_native_threads;
+extern my_bool wsrep_sst_native_compress;
+extern ulong   wsrep_sst_native_timeout;
+
+#define WSREP_SST_NATIVE_THREADS_MAX 64
+
+/*!
+  Joiner: start listening at addr_in and receiving data directory in
+  background. On success returns the length of the address to pass to
+  donor in addr_out (malloc'ed), negative error code otherwise.
+  Completion is reported with wsrep_sst_complete().
+*/
+ssize_t wsrep_sst_native_prepare(const char* addr_in, const char** addr_out);
+
+/*!
+  Donor: send data directory to joiner at addr followed by state, which
+  is "uuid:seqno". If bypass is true only state is sent. Server must be
+  locked by the caller. Returns 0 on success, negative error code
+  otherwise.
+*/
+int wsrep_sst_native_send(const char* addr, const char* state, bool bypass);
+
+#endif /* WSREP_SST_NATIVE_H */
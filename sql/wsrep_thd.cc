@@ -14,6 +14,8 @@
    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA. */
 
 #include "wsrep_thd.h"
+#include "wsrep_applier.h"
+#include "wsrep_conflict_stats.h"
 
 #include "transaction.h"
 #include "rpl_rli.h"
@@ -92,6 +94,12 @@ static Relay_log_info* wsrep_relay_log_init(const char* log_fname)
   return (rli);
 }
 
+Relay_log_info* wsrep_thd_rli(THD *thd)
+{
+  if (!thd->wsrep_rli) thd->wsrep_rli= wsrep_relay_log_init("wsrep_relay");
+  return thd->wsrep_rli;
+}
+
 static void wsrep_prepare_bf_thd(THD *thd, struct wsrep_thd_shadow* shadow)
 {
   shadow->options       = thd->variables.option_bits;
@@ -107,8 +115,7 @@ static void wsrep_prepare_bf_thd(THD *thd, struct wsrep_thd_shadow* shadow)
   else
     thd->variables.option_bits&= ~(OPTION_BIN_LOG);
 
-  if (!thd->wsrep_rli) thd->wsrep_rli= wsrep_relay_log_init("wsrep_relay");
-  thd->wsrep_rli->info_thd = thd;
+  wsrep_thd_rli(thd)->info_thd = thd;
 
   thd->wsrep_exec_mode= REPL_RECV;
   thd->net.vio= 0;
@@ -212,9 +219,12 @@ void wsrep_replay_transaction(THD *thd)
       thd->variables.option_bits|= OPTION_BEGIN;
       thd->server_status|= SERVER_STATUS_IN_TRANS;
 
+      ulonglong const replay_start= my_micro_time();
       int rcode = wsrep->replay_trx(wsrep,
                                     &thd->wsrep_ws_handle,
                                     (void *)thd);
+      wsrep_conflict_stats_add(thd, WSREP_CONFLICT_REPLAY, replay_start);
+      wsrep_applier_ctx_release(thd);
 
       wsrep_return_from_bf_mode(thd, &shadow);
       if (thd->wsrep_conflict_state!= REPLAYING)
@@ -357,6 +367,7 @@ static void wsrep_replication_process(THD *thd)
                   (tmp->s) ? tmp->s->db.str : "void",
                   (tmp->s) ? tmp->s->table_name.str : "void");
   }
+  wsrep_applier_ctx_release(thd);
   wsrep_return_from_bf_mode(thd, &shadow);
   DBUG_VOID_RETURN;
 }
@@ -386,45 +397,156 @@ void wsrep_create_appliers(long threads)
   }
 }
 
+/*
+  BF abort rollbacker pool.
+
+  Every rollbacker owns a multi-producer single-consumer queue of victims.
+  Victims are pushed to the queue head with CAS by the threads performing
+  BF abort and the rollbacker detaches the whole queue at once, so queue
+  itself needs no locking. The mutex is used only for sleeping and wakeup.
+  Queue nodes are embedded in victim THD, a victim can be in the queue only
+  once as its conflict state is ABORTING until rollback is done.
+*/
+struct wsrep_rollbacker
+{
+  wsrep_aborting_thd_t volatile queue;
+  mysql_mutex_t                 LOCK;
+  mysql_cond_t                  COND;
+  THD*                          thd;         /* NULL if not running */
+  /* statistics, updated by rollbacker thread only */
+  ulonglong                     rollbacks;
+  ulonglong                     latency;     /* total, microseconds */
+  ulonglong                     latency_max; /* microseconds */
+};
+
+static struct wsrep_rollbacker wsrep_rollbackers[WSREP_ROLLBACKER_THREADS_MAX];
+static int32 wsrep_rollbacker_queue_depth= 0;
+
+void wsrep_rollbacker_init()
+{
+  for (int i= 0; i < WSREP_ROLLBACKER_THREADS_MAX; i++)
+  {
+    struct wsrep_rollbacker* const rb(&wsrep_rollbackers[i]);
+    rb->queue= NULL;
+    rb->thd= NULL;
+    rb->rollbacks= rb->latency= rb->latency_max= 0;
+    mysql_mutex_init(key_LOCK_wsrep_rollbacker, &rb->LOCK, MY_MUTEX_INIT_FAST);
+    mysql_cond_init(key_COND_wsrep_rollbacker, &rb->COND, NULL);
+  }
+}
+
+void wsrep_rollbacker_deinit()
+{
+  for (int i= 0; i < WSREP_ROLLBACKER_THREADS_MAX; i++)
+  {
+    mysql_mutex_destroy(&wsrep_rollbackers[i].LOCK);
+    mysql_cond_destroy(&wsrep_rollbackers[i].COND);
+  }
+}
+
+/* must have (&thd->LOCK_wsrep_thd) */
+extern "C" void wsrep_thd_enqueue_rollback(THD *thd)
+{
+  struct wsrep_rollbacker* const rb
+    (&wsrep_rollbackers[thd->thread_id % wsrep_rollbacker_threads]);
+  wsrep_aborting_thd_t const node(&thd->wsrep_aborting_node);
+
+  node->aborting_thd= thd;
+  node->enqueued= my_micro_time();
+
+  void* head= my_atomic_loadptr((void* volatile*)&rb->queue);
+  do
+  {
+    node->next= (wsrep_aborting_thd_t)head;
+  } while (!my_atomic_casptr((void* volatile*)&rb->queue, &head, node));
+
+  my_atomic_add32(&wsrep_rollbacker_queue_depth, 1);
+
+  DBUG_PRINT("wsrep",("enqueuing trx abort for %lu", thd->thread_id));
+  WSREP_DEBUG("enqueuing trx abort for (%lu)", thd->thread_id);
+
+  mysql_mutex_lock(&rb->LOCK);
+  mysql_cond_signal(&rb->COND);
+  mysql_mutex_unlock(&rb->LOCK);
+}
+
 static void wsrep_rollback_process(THD *thd)
 {
   DBUG_ENTER("wsrep_rollback_process");
 
-  mysql_mutex_lock(&LOCK_wsrep_rollback);
-  wsrep_aborting_thd= NULL;
+  struct wsrep_rollbacker* rb(NULL);
+  for (ulong i= 0; i < wsrep_rollbacker_threads && !rb; i++)
+  {
+    mysql_mutex_lock(&wsrep_rollbackers[i].LOCK);
+    if (!wsrep_rollbackers[i].thd)
+    {
+      rb= &wsrep_rollbackers[i];
+      rb->thd= thd;
+    }
+    mysql_mutex_unlock(&wsrep_rollbackers[i].LOCK);
+  }
+
+  if (!rb)
+  {
+    WSREP_WARN("all %lu rollbacker slots are taken, thread exiting",
+               wsrep_rollbacker_threads);
+    DBUG_VOID_RETURN;
+  }
+
+  mysql_mutex_lock(&rb->LOCK);
 
   while (thd->killed == THD::NOT_KILLED) {
-    thd_proc_info(thd, "wsrep aborter idle");
-    thd->mysys_var->current_mutex= &LOCK_wsrep_rollback;
-    thd->mysys_var->current_cond=  &COND_wsrep_rollback;
+    if (!my_atomic_loadptr((void* volatile*)&rb->queue))
+    {
+      thd_proc_info(thd, "wsrep aborter idle");
+      thd->mysys_var->current_mutex= &rb->LOCK;
+      thd->mysys_var->current_cond=  &rb->COND;
 
-    mysql_cond_wait(&COND_wsrep_rollback,&LOCK_wsrep_rollback);
+      mysql_cond_wait(&rb->COND, &rb->LOCK);
 
-    WSREP_DEBUG("WSREP rollback thread wakes for signal");
+      WSREP_DEBUG("WSREP rollback thread wakes for signal");
+
+      mysql_mutex_lock(&thd->mysys_var->mutex);
+      thd_proc_info(thd, "wsrep aborter active");
+      thd->mysys_var->current_mutex= 0;
+      thd->mysys_var->current_cond=  0;
+      mysql_mutex_unlock(&thd->mysys_var->mutex);
+    }
+
+    /*
+     * must release mutex, appliers my want to add more
+     * aborting thds in our work queue, while we rollback
+     */
+    mysql_mutex_unlock(&rb->LOCK);
 
-    mysql_mutex_lock(&thd->mysys_var->mutex);
-    thd_proc_info(thd, "wsrep aborter active");
-    thd->mysys_var->current_mutex= 0;
-    thd->mysys_var->current_cond=  0;
-    mysql_mutex_unlock(&thd->mysys_var->mutex);
+    wsrep_aborting_thd_t queue= (wsrep_aborting_thd_t)
+      my_atomic_fasptr((void* volatile*)&rb->queue, NULL);
 
     /* check for false alarms */
-    if (!wsrep_aborting_thd)
+    if (!queue)
     {
       WSREP_DEBUG("WSREP rollback thread has empty abort queue");
     }
+
+    /* queue was built by pushing to the head, restore arrival order */
+    wsrep_aborting_thd_t fifo(NULL);
+    while (queue)
+    {
+      wsrep_aborting_thd_t const next(queue->next);
+      queue->next= fifo;
+      fifo= queue;
+      queue= next;
+    }
+
     /* process all entries in the queue */
-    while (wsrep_aborting_thd) {
-      THD *aborting;
-      wsrep_aborting_thd_t next = wsrep_aborting_thd->next;
-      aborting = wsrep_aborting_thd->aborting_thd;
-      my_free(wsrep_aborting_thd);
-      wsrep_aborting_thd= next;
-      /*
-       * must release mutex, appliers my want to add more
-       * aborting thds in our work queue, while we rollback
-       */
-      mysql_mutex_unlock(&LOCK_wsrep_rollback);
+    while (fifo) {
+      /* node belongs to victim THD and may be reused once it is aborted */
+      wsrep_aborting_thd_t const next(fifo->next);
+      THD* const aborting(fifo->aborting_thd);
+      ulonglong const enqueued(fifo->enqueued);
+      fifo= next;
+
+      my_atomic_add32(&wsrep_rollbacker_queue_depth, -1);
 
       mysql_mutex_lock(&aborting->LOCK_wsrep_thd);
       if (aborting->wsrep_conflict_state== ABORTED)
@@ -434,7 +556,6 @@ static void wsrep_rollback_process(THD *thd)
                     aborting->wsrep_conflict_state);
 
         mysql_mutex_unlock(&aborting->LOCK_wsrep_thd);
-        mysql_mutex_lock(&LOCK_wsrep_rollback);
         continue;
       }
       aborting->wsrep_conflict_state= ABORTING;
@@ -454,11 +575,17 @@ static void wsrep_rollback_process(THD *thd)
                   aborting->thread_id, (long long)aborting->real_id);
       mysql_mutex_unlock(&aborting->LOCK_wsrep_thd);
 
-      mysql_mutex_lock(&LOCK_wsrep_rollback);
+      ulonglong const latency(my_micro_time() - enqueued);
+      rb->rollbacks++;
+      rb->latency+= latency;
+      if (latency > rb->latency_max) rb->latency_max= latency;
     }
+
+    mysql_mutex_lock(&rb->LOCK);
   }
 
-  mysql_mutex_unlock(&LOCK_wsrep_rollback);
+  rb->thd= NULL;
+  mysql_mutex_unlock(&rb->LOCK);
   sql_print_information("WSREP: rollbacker thread exiting");
 
   DBUG_PRINT("wsrep",("wsrep rollbacker thread exiting"));
@@ -469,14 +596,68 @@ void wsrep_create_rollbacker()
 {
   if (wsrep_provider && strcasecmp(wsrep_provider, "none"))
   {
-    pthread_t hThread;
-    /* create rollbacker */
-    if (pthread_create( &hThread, &connection_attrib,
-                        start_wsrep_THD, (void*)wsrep_rollback_process))
-      WSREP_WARN("Can't create thread to manage wsrep rollback");
+    for (ulong i= 0; i < wsrep_rollbacker_threads; i++)
+    {
+      pthread_t hThread;
+      /* create rollbacker */
+      if (pthread_create( &hThread, &connection_attrib,
+                          start_wsrep_THD, (void*)wsrep_rollback_process))
+        WSREP_WARN("Can't create thread to manage wsrep rollback");
+    }
   }
 }
 
+/*
+  Status variables of the rollbacker pool:
+  wsrep_rollbacker_queue_depth - victims waiting for rollback,
+  wsrep_rollbacker_N_rollbacks - victims rolled back by rollbacker N,
+  wsrep_rollbacker_N_latency_avg, wsrep_rollbacker_N_latency_max -
+  time from enqueuing a victim until its rollback is done, microseconds.
+*/
+#define WSREP_ROLLBACKER_STATUS_LEN (1 + 3 * WSREP_ROLLBACKER_THREADS_MAX)
+static SHOW_VAR  wsrep_rollbacker_status[WSREP_ROLLBACKER_STATUS_LEN + 1];
+static char      wsrep_rollbacker_status_names[WSREP_ROLLBACKER_STATUS_LEN][32];
+static long long wsrep_rollbacker_status_values[WSREP_ROLLBACKER_STATUS_LEN];
+
+int wsrep_show_rollbacker_status(THD *thd, SHOW_VAR *var, char *buff)
+{
+  int n= 0;
+
+  wsrep_rollbacker_status_values[n]=
+    my_atomic_load32(&wsrep_rollbacker_queue_depth);
+  strmake(wsrep_rollbacker_status_names[n], STRING_WITH_LEN("queue_depth"));
+  n++;
+
+  for (ulong i= 0; i < wsrep_rollbacker_threads; i++)
+  {
+    struct wsrep_rollbacker* const rb(&wsrep_rollbackers[i]);
+    ulonglong const rollbacks(rb->rollbacks);
+
+    my_snprintf(wsrep_rollbacker_status_names[n], 32, "%lu_rollbacks", i);
+    wsrep_rollbacker_status_values[n++]= rollbacks;
+    my_snprintf(wsrep_rollbacker_status_names[n], 32, "%lu_latency_avg", i);
+    wsrep_rollbacker_status_values[n++]= rollbacks ?
+      rb->latency / rollbacks : 0;
+    my_snprintf(wsrep_rollbacker_status_names[n], 32, "%lu_latency_max", i);
+    wsrep_rollbacker_status_values[n++]= rb->latency_max;
+  }
+
+  for (int i= 0; i < n; i++)
+  {
+    wsrep_rollbacker_status[i].name= wsrep_rollbacker_status_names[i];
+    wsrep_rollbacker_status[i].value=
+      (char*)&wsrep_rollbacker_status_values[i];
+    wsrep_rollbacker_status[i].type= SHOW_LONGLONG;
+  }
+  wsrep_rollbacker_status[n].name= NullS;
+  wsrep_rollbacker_status[n].value= NullS;
+  wsrep_rollbacker_status[n].type= SHOW_LONG;
+
+  var->type= SHOW_ARRAY;
+  var->value= (char*)&wsrep_rollbacker_status;
+  return 0;
+}
+
 void wsrep_thd_set_PA_safe(void *thd_ptr, my_bool safe)
 { 
   if (thd_ptr) 
@@ -21,8 +21,13 @@
 int wsrep_show_bf_aborts (THD *thd, SHOW_VAR *var, char *buff);
 void wsrep_client_rollback(THD *thd);
 void wsrep_replay_transaction(THD *thd);
+/* relay log info for applying events in thd, created on first use */
+Relay_log_info* wsrep_thd_rli(THD *thd);
 void wsrep_create_appliers(long threads);
 void wsrep_create_rollbacker();
+void wsrep_rollbacker_init();
+void wsrep_rollbacker_deinit();
+int  wsrep_show_rollbacker_status(THD *thd, SHOW_VAR *var, char *buff);
 
 int  wsrep_abort_thd(void *bf_thd_ptr, void *victim_thd_ptr,
                                 my_bool signal);
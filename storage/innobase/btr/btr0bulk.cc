@@ -0,0 +1,688 @@
+/*****************************************************************************
+
+Copyright (C) 2017 Codership Oy <info@codership.com>
+
+This program is free software; you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation; version 2 of the License.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Suite 500, Boston, MA 02110-1335 USA
+
+*****************************************************************************/
+
+/**************************************************//**
+@file btr/btr0bulk.cc
+Bottom-up construction of an index tree from sorted records
+*******************************************************/
+
+#include "btr0bulk.h"
+#include "btr0btr.h"
+#include "btr0cur.h"
+#include "btr0sea.h"
+#include "buf0buf.h"
+#include "dict0dict.h"
+#include "fsp0fsp.h"
+#include "log0log.h"
+#include "mtr0log.h"
+#include "page0cur.h"
+#include "page0page.h"
+#include "page0zip.h"
+#include "rem0cmp.h"
+#include "rem0rec.h"
+
+/** Percentage of each index page to fill in btr_bulk_insert() */
+UNIV_INTERN ulong	btr_bulk_fill_factor = 100;
+
+/** A leaf page that is being filled */
+struct btr_bulk_page_t {
+	mtr_t		mtr;	/*!< mini-transaction that x-latches
+				block */
+	buf_block_t*	block;	/*!< the page */
+	rec_t*		last;	/*!< the last record on the page,
+				or the page infimum */
+};
+
+/** Bulk loader of an index tree */
+struct btr_bulk_t {
+	mtr_t		mtr;	/*!< mini-transaction that latches
+				the index tree */
+	dict_index_t*	index;	/*!< the index */
+	trx_id_t	trx_id;	/*!< PAGE_MAX_TRX_ID of secondary
+				index leaf pages */
+	ulint		reserve;/*!< free space to leave on
+				each page, in bytes */
+	mem_heap_t*	heap;	/*!< heap for records and node
+				pointers, emptied for each entry */
+	btr_bulk_page_t	pages[2];/*!< the leaf page that is being
+				filled and the next one */
+	btr_bulk_page_t* leaf;	/*!< the leaf page that is being
+				filled, in pages[], or NULL */
+	ulint		n_levels;/*!< number of levels in page_no[] */
+	ulint		page_no[BTR_MAX_LEVELS];
+				/*!< the rightmost page of each
+				level, starting from the leaf level */
+};
+
+/*********************************************************************//**
+Latch the index tree for the duration of the bulk load.  The clustered
+index of a table that is being rebuilt is not accessed by anybody else.
+The secondary index that is being created online is s-latched, so that
+concurrent DML can keep writing to the online log. */
+static
+void
+btr_bulk_lock(
+/*==========*/
+	btr_bulk_t*	bulk)	/*!< in/out: bulk loader */
+{
+	mtr_start(&bulk->mtr);
+
+	if (dict_index_is_clust(bulk->index)) {
+		mtr_x_lock(dict_index_get_lock(bulk->index), &bulk->mtr);
+	} else {
+		mtr_s_lock(dict_index_get_lock(bulk->index), &bulk->mtr);
+	}
+}
+
+/*********************************************************************//**
+Start a mini-transaction for a page of the bulk loaded tree.  For the
+clustered index, it x-latches the tree again, because
+btr_store_big_rec_extern_fields() requires that. */
+static
+void
+btr_bulk_mtr_start(
+/*===============*/
+	const btr_bulk_t*	bulk,	/*!< in: bulk loader */
+	mtr_t*			mtr)	/*!< out: mini-transaction */
+{
+	mtr_start(mtr);
+
+	if (dict_index_is_clust(bulk->index)) {
+		mtr_x_lock(dict_index_get_lock(bulk->index), mtr);
+	}
+}
+
+/*********************************************************************//**
+Write the records and the page directory of a page that has been filled
+by page_cur_insert_rec_low() to the redo log. */
+static
+void
+btr_bulk_page_log(
+/*==============*/
+	page_t*	dest,	/*!< in/out: page to write */
+	ulint	from,	/*!< in: offset of the first byte of
+			the page header to write */
+	page_t*	src,	/*!< in: page whose contents to write */
+	mtr_t*	mtr)	/*!< in/out: mini-transaction */
+{
+	ulint	heap_top = page_header_get_field(src, PAGE_HEAP_TOP);
+	byte*	dir = page_dir_get_nth_slot(
+		src, page_dir_get_n_slots(src) - 1);
+	ulint	dir_len = src + UNIV_PAGE_SIZE - PAGE_DIR - dir;
+
+	ut_ad(from >= PAGE_HEADER);
+	ut_ad(from <= heap_top);
+
+	if (dest != src) {
+		memcpy(dest + from, src + from, heap_top - from);
+		memcpy(dest + (dir - src), dir, dir_len);
+	}
+
+	mlog_log_string(dest + from, heap_top - from, mtr);
+	mlog_log_string(dest + (dir - src), dir_len, mtr);
+}
+
+/*********************************************************************//**
+Allocate and create the next page on a level of the tree.
+@return the page, or NULL if the tablespace is full */
+static MY_ATTRIBUTE((nonnull, warn_unused_result))
+buf_block_t*
+btr_bulk_page_create(
+/*=================*/
+	btr_bulk_t*	bulk,		/*!< in/out: bulk loader */
+	ulint		level,		/*!< in: level of the page */
+	ulint		prev_page_no,	/*!< in: left sibling, or FIL_NULL */
+	mtr_t*		mtr)		/*!< in/out: mini-transaction
+					that will latch the page */
+{
+	mtr_t		alloc_mtr;
+	ulint		n_reserved;
+	buf_block_t*	block	= NULL;
+	page_t*		page;
+
+	DBUG_EXECUTE_IF("disk_is_full",
+			os_has_said_disk_full = true;
+			return(NULL););
+
+	/* Latch the root page before the tablespace, as
+	btr_page_alloc() would. */
+	mtr_start(&alloc_mtr);
+	btr_root_get(bulk->index, &alloc_mtr);
+
+	if (fsp_reserve_free_extents(&n_reserved, bulk->index->space, 2,
+				     FSP_NORMAL, &alloc_mtr)) {
+		block = btr_page_alloc(bulk->index,
+				       prev_page_no == FIL_NULL
+				       ? 0 : prev_page_no + 1,
+				       FSP_UP, level, &alloc_mtr, mtr);
+		fil_space_release_free_extents(bulk->index->space,
+					       n_reserved);
+	}
+
+	mtr_commit(&alloc_mtr);
+
+	if (block == NULL) {
+		return(NULL);
+	}
+
+	page = buf_block_get_frame(block);
+
+	btr_page_create(block, NULL, bulk->index, level, mtr);
+	btr_page_set_next(page, NULL, FIL_NULL, mtr);
+	btr_page_set_prev(page, NULL, prev_page_no, mtr);
+
+	if (level == 0 && !dict_index_is_clust(bulk->index)) {
+		/* The page header is logged by btr_bulk_page_log(). */
+		page_set_max_trx_id(block, NULL, bulk->trx_id, NULL);
+	}
+
+	return(block);
+}
+
+/*********************************************************************//**
+Allocate and create the next leaf page.
+@return DB_SUCCESS or DB_OUT_OF_FILE_SPACE */
+static MY_ATTRIBUTE((nonnull, warn_unused_result))
+dberr_t
+btr_bulk_leaf_create(
+/*=================*/
+	btr_bulk_t*		bulk,	/*!< in/out: bulk loader */
+	ulint			prev_page_no,
+					/*!< in: left sibling, or FIL_NULL */
+	btr_bulk_page_t*	bpage)	/*!< out: the page */
+{
+	btr_bulk_mtr_start(bulk, &bpage->mtr);
+
+	bpage->block = btr_bulk_page_create(bulk, 0, prev_page_no,
+					    &bpage->mtr);
+
+	if (bpage->block == NULL) {
+		mtr_commit(&bpage->mtr);
+		return(DB_OUT_OF_FILE_SPACE);
+	}
+
+	bpage->last = page_get_infimum_rec(buf_block_get_frame(bpage->block));
+	bulk->page_no[0] = buf_block_get_page_no(bpage->block);
+
+	return(DB_SUCCESS);
+}
+
+/*********************************************************************//**
+Write a completed leaf page to the redo log and release it. */
+static
+void
+btr_bulk_page_commit(
+/*=================*/
+	btr_bulk_page_t*	bpage)	/*!< in/out: page */
+{
+	page_t*	page = buf_block_get_frame(bpage->block);
+
+	btr_bulk_page_log(page, PAGE_HEADER, page, &bpage->mtr);
+	mtr_commit(&bpage->mtr);
+	bpage->block = NULL;
+}
+
+/*********************************************************************//**
+Write the leaf page that is being filled to the redo log and release it
+together with the index tree, so that the redo log can be checkpointed.
+Then latch the page again. */
+static
+void
+btr_bulk_log_free_check(
+/*====================*/
+	btr_bulk_t*	bulk)	/*!< in/out: bulk loader */
+{
+	btr_bulk_page_t*	bpage	= bulk->leaf;
+	ulint			last	= 0;
+
+	if (bpage) {
+		last = page_offset(bpage->last);
+		btr_bulk_page_commit(bpage);
+	}
+
+	mtr_commit(&bulk->mtr);
+
+	log_free_check();
+
+	btr_bulk_lock(bulk);
+
+	if (bpage) {
+		btr_bulk_mtr_start(bulk, &bpage->mtr);
+
+		bpage->block = btr_block_get(
+			dict_index_get_space(bulk->index), 0,
+			bulk->page_no[0], RW_X_LATCH, bulk->index,
+			&bpage->mtr);
+		bpage->last = buf_block_get_frame(bpage->block) + last;
+	}
+}
+
+/*********************************************************************//**
+Append a node pointer to a non-leaf level of the tree, starting a new
+page on that level if the current page is full.  The page is latched
+and the record is redo logged only for the duration of the call, so
+that the non-leaf pages can be flushed while the leaf level is being
+filled.
+@return DB_SUCCESS or error code */
+static MY_ATTRIBUTE((nonnull, warn_unused_result))
+dberr_t
+btr_bulk_node_ptr_insert(
+/*=====================*/
+	btr_bulk_t*	bulk,	/*!< in/out: bulk loader */
+	dtuple_t*	node_ptr,/*!< in/out: node pointer */
+	ulint		level)	/*!< in: level of the tree, at least 1 */
+{
+	dict_index_t*	index	= bulk->index;
+	mtr_t		mtr;
+	buf_block_t*	block;
+	page_t*		page;
+	rec_t*		rec;
+	ulint*		offsets;
+	ulint		rec_size;
+	ulint		max_size;
+	dberr_t		err	= DB_SUCCESS;
+
+	ut_ad(level > 0);
+	ut_ad(level <= bulk->n_levels);
+
+	if (level == BTR_MAX_LEVELS) {
+		return(DB_CORRUPTION);
+	}
+
+	btr_bulk_mtr_start(bulk, &mtr);
+
+	if (level == bulk->n_levels) {
+		block = btr_bulk_page_create(bulk, level, FIL_NULL, &mtr);
+
+		if (block == NULL) {
+			err = DB_OUT_OF_FILE_SPACE;
+			goto func_exit;
+		}
+
+		bulk->page_no[level] = buf_block_get_page_no(block);
+		bulk->n_levels++;
+
+		/* This is the first node pointer on the level. */
+		dtuple_set_info_bits(node_ptr,
+				     dtuple_get_info_bits(node_ptr)
+				     | REC_INFO_MIN_REC_FLAG);
+	} else {
+		block = btr_block_get(dict_index_get_space(index), 0,
+				      bulk->page_no[level], RW_X_LATCH,
+				      index, &mtr);
+	}
+
+	page = buf_block_get_frame(block);
+	rec_size = rec_get_converted_size(index, node_ptr, 0);
+	max_size = page_get_max_insert_size(page, 1);
+
+	if (rec_size > max_size
+	    || (page_get_n_recs(page) >= 2
+		&& rec_size + bulk->reserve > max_size)) {
+		/* Start a new page on this level, and add a node pointer
+		to the completed page on the level above. */
+		ulint		page_no	= page_get_page_no(page);
+		buf_block_t*	new_block;
+
+		new_block = btr_bulk_page_create(bulk, level, page_no, &mtr);
+
+		if (new_block == NULL) {
+			err = DB_OUT_OF_FILE_SPACE;
+			goto func_exit;
+		}
+
+		btr_page_set_next(page, NULL,
+				  buf_block_get_page_no(new_block), &mtr);
+
+		err = btr_bulk_node_ptr_insert(
+			bulk, dict_index_build_node_ptr(
+				index,
+				page_rec_get_next(page_get_infimum_rec(page)),
+				page_no, bulk->heap, level),
+			level + 1);
+
+		if (err != DB_SUCCESS) {
+			goto func_exit;
+		}
+
+		block = new_block;
+		page = buf_block_get_frame(block);
+		bulk->page_no[level] = buf_block_get_page_no(block);
+	}
+
+	rec = rec_convert_dtuple_to_rec(
+		static_cast<byte*>(mem_heap_alloc(bulk->heap, rec_size)),
+		index, node_ptr, 0);
+	offsets = rec_get_offsets(rec, index, NULL, ULINT_UNDEFINED,
+				  &bulk->heap);
+
+	rec = page_cur_insert_rec_low(
+		page_rec_get_prev(page_get_supremum_rec(page)),
+		index, rec, offsets, &mtr);
+	ut_a(rec);
+
+func_exit:
+	mtr_commit(&mtr);
+
+	return(err);
+}
+
+/*********************************************************************//**
+Append a record to the leaf level of the tree, starting a new page if
+the current page is full.
+@return DB_SUCCESS or error code */
+static MY_ATTRIBUTE((nonnull, warn_unused_result))
+dberr_t
+btr_bulk_insert_low(
+/*================*/
+	btr_bulk_t*	bulk,	/*!< in/out: bulk loader */
+	dtuple_t*	entry)	/*!< in/out: record */
+{
+	dict_index_t*		index	= bulk->index;
+	btr_bulk_page_t*	bpage	= bulk->leaf;
+	big_rec_t*		big_rec	= NULL;
+	ulint			n_ext	= 0;
+	ulint			rec_size;
+	ulint			max_size;
+	page_t*			page;
+	rec_t*			rec;
+	ulint*			offsets;
+	dberr_t			err;
+
+	if (bpage == NULL) {
+		bpage = &bulk->pages[0];
+		err = btr_bulk_leaf_create(bulk, FIL_NULL, bpage);
+
+		if (err != DB_SUCCESS) {
+			return(err);
+		}
+
+		bulk->leaf = bpage;
+		bulk->n_levels = 1;
+	}
+
+	rec_size = rec_get_converted_size(index, entry, 0);
+
+	if (page_zip_rec_needs_ext(rec_size, dict_table_is_comp(index->table),
+				   dtuple_get_n_fields(entry), 0)) {
+		big_rec = dtuple_convert_big_rec(index, entry, &n_ext);
+
+		if (big_rec == NULL) {
+			return(DB_TOO_BIG_RECORD);
+		}
+
+		rec_size = rec_get_converted_size(index, entry, n_ext);
+	}
+
+	page = buf_block_get_frame(bpage->block);
+	max_size = page_get_max_insert_size(page, 1);
+
+	if (rec_size > max_size
+	    || (page_get_n_recs(page) >= 2
+		&& rec_size + bulk->reserve > max_size)) {
+		/* Start a new page, and add a node pointer to the
+		completed page on the level above. */
+		btr_bulk_page_t*	full	= bpage;
+		ulint			page_no	= page_get_page_no(page);
+
+		ut_ad(page_get_n_recs(page) > 0);
+
+		bpage = &bulk->pages[full == &bulk->pages[0]];
+		err = btr_bulk_leaf_create(bulk, page_no, bpage);
+
+		if (err != DB_SUCCESS) {
+			goto func_exit;
+		}
+
+		bulk->leaf = bpage;
+
+		btr_page_set_next(page, NULL,
+				  buf_block_get_page_no(bpage->block),
+				  &full->mtr);
+
+		err = btr_bulk_node_ptr_insert(
+			bulk, dict_index_build_node_ptr(
+				index,
+				page_rec_get_next(page_get_infimum_rec(page)),
+				page_no, bulk->heap, 0),
+			1);
+
+		btr_bulk_page_commit(full);
+
+		if (err != DB_SUCCESS) {
+			goto func_exit;
+		}
+
+		page = buf_block_get_frame(bpage->block);
+	}
+
+	rec = rec_convert_dtuple_to_rec(
+		static_cast<byte*>(mem_heap_alloc(bulk->heap, rec_size)),
+		index, entry, n_ext);
+	offsets = rec_get_offsets(rec, index, NULL, ULINT_UNDEFINED,
+				  &bulk->heap);
+
+#ifdef UNIV_DEBUG
+	/* Check that the records are inserted in order. */
+	if (!page_rec_is_infimum(bpage->last)) {
+		ulint*	last_offsets = rec_get_offsets(
+			bpage->last, index, NULL, ULINT_UNDEFINED,
+			&bulk->heap);
+		ut_ad(cmp_rec_rec(rec, bpage->last, offsets, last_offsets,
+				  index) > 0);
+	}
+#endif /* UNIV_DEBUG */
+
+	rec = page_cur_insert_rec_low(bpage->last, index, rec, offsets, NULL);
+	ut_a(rec);
+	bpage->last = rec;
+
+	if (big_rec) {
+		offsets = rec_get_offsets(rec, index, offsets,
+					  ULINT_UNDEFINED, &bulk->heap);
+		err = btr_store_big_rec_extern_fields(
+			index, bpage->block, rec, offsets, big_rec,
+			&bpage->mtr, BTR_STORE_INSERT);
+	} else {
+		err = DB_SUCCESS;
+	}
+
+func_exit:
+	if (big_rec) {
+		dtuple_convert_back_big_rec(index, entry, big_rec);
+	}
+
+	return(err);
+}
+
+/*********************************************************************//**
+Start loading an empty index tree in ascending key order.  Compressed
+tables are not supported.
+@return bulk loader, or NULL if the index cannot be bulk loaded */
+UNIV_INTERN
+btr_bulk_t*
+btr_bulk_create(
+/*============*/
+	dict_index_t*	index,	/*!< in/out: index whose tree is empty */
+	trx_id_t	trx_id)	/*!< in: PAGE_MAX_TRX_ID of secondary
+				index leaf pages */
+{
+	btr_bulk_t*	bulk;
+	mtr_t		mtr;
+	const page_t*	root;
+	bool		empty;
+
+	ut_ad(!dict_index_is_ibuf(index));
+
+	if (dict_table_zip_size(index->table)) {
+		return(NULL);
+	}
+
+	mtr_start(&mtr);
+	root = btr_root_get(index, &mtr);
+	empty = page_is_empty(root) && page_is_leaf(root);
+	mtr_commit(&mtr);
+
+	if (!empty) {
+		return(NULL);
+	}
+
+	bulk = static_cast<btr_bulk_t*>(mem_alloc(sizeof *bulk));
+	bulk->index = index;
+	bulk->trx_id = trx_id;
+	bulk->reserve = page_get_free_space_of_empty(
+		dict_table_is_comp(index->table))
+		* (100 - btr_bulk_fill_factor) / 100;
+	bulk->heap = mem_heap_create(1024);
+	bulk->leaf = NULL;
+	bulk->n_levels = 0;
+
+	btr_bulk_lock(bulk);
+
+	return(bulk);
+}
+
+/*********************************************************************//**
+Append an index entry to the tree.  The entries must be passed in
+ascending order.
+@return DB_SUCCESS or error code */
+UNIV_INTERN
+dberr_t
+btr_bulk_insert(
+/*============*/
+	btr_bulk_t*	bulk,	/*!< in/out: bulk loader */
+	dtuple_t*	entry)	/*!< in/out: index entry without
+				externally stored columns */
+{
+	ut_ad(dtuple_validate(entry));
+
+	if (log_sys->check_flush_or_checkpoint) {
+		btr_bulk_log_free_check(bulk);
+	}
+
+	mem_heap_empty(bulk->heap);
+
+	return(btr_bulk_insert_low(bulk, entry));
+}
+
+/*********************************************************************//**
+Complete the node pointer levels, write the last leaf page to the redo
+log and free the bulk loader.  If err is not DB_SUCCESS, the tree is
+left incomplete; it can only be freed.
+@return DB_SUCCESS or error code */
+UNIV_INTERN
+dberr_t
+btr_bulk_finish(
+/*============*/
+	btr_bulk_t*	bulk,	/*!< in, own: bulk loader */
+	dberr_t		err)	/*!< in: error from btr_bulk_insert() */
+{
+	dict_index_t*	index	= bulk->index;
+	ulint		page_no	= FIL_NULL;
+	ulint		level	= 0;
+
+	mem_heap_empty(bulk->heap);
+
+	/* Add node pointers to the rightmost page of each level.
+	This may add a page or a level above. */
+	if (bulk->leaf) {
+		page_t*	page = buf_block_get_frame(bulk->leaf->block);
+
+		if (err == DB_SUCCESS && bulk->n_levels > 1) {
+			err = btr_bulk_node_ptr_insert(
+				bulk, dict_index_build_node_ptr(
+					index, page_rec_get_next(
+						page_get_infimum_rec(page)),
+					page_get_page_no(page), bulk->heap, 0),
+				1);
+		}
+
+		btr_bulk_page_commit(bulk->leaf);
+	}
+
+	for (ulint i = 1; err == DB_SUCCESS && i + 1 < bulk->n_levels; i++) {
+		mtr_t		mtr;
+		page_t*		page;
+		dtuple_t*	node_ptr;
+
+		mem_heap_empty(bulk->heap);
+
+		btr_bulk_mtr_start(bulk, &mtr);
+		page = buf_block_get_frame(btr_block_get(
+			dict_index_get_space(index), 0, bulk->page_no[i],
+			RW_X_LATCH, index, &mtr));
+		node_ptr = dict_index_build_node_ptr(
+			index, page_rec_get_next(page_get_infimum_rec(page)),
+			bulk->page_no[i], bulk->heap, i);
+		mtr_commit(&mtr);
+
+		err = btr_bulk_node_ptr_insert(bulk, node_ptr, i + 1);
+	}
+
+	if (bulk->n_levels) {
+		level = bulk->n_levels - 1;
+		page_no = bulk->page_no[level];
+	}
+
+	mtr_commit(&bulk->mtr);
+
+	if (err == DB_SUCCESS && page_no != FIL_NULL) {
+		/* The only page on the top level becomes the root.
+		Copy it over the empty root page, except for the
+		file segment headers, and free it. */
+		mtr_t		mtr;
+		buf_block_t*	root_block;
+		page_t*		root;
+		buf_block_t*	block;
+
+		mtr_start(&mtr);
+		mtr_x_lock(dict_index_get_lock(index), &mtr);
+
+		root_block = btr_block_get(dict_index_get_space(index), 0,
+					   dict_index_get_page(index),
+					   RW_X_LATCH, index, &mtr);
+		root = buf_block_get_frame(root_block);
+		block = btr_block_get(dict_index_get_space(index), 0,
+				      page_no, RW_X_LATCH, index, &mtr);
+
+		btr_search_drop_page_hash_index(root_block);
+
+		ut_ad(page_is_empty(root));
+		ut_ad(btr_page_get_prev(buf_block_get_frame(block), &mtr)
+		      == FIL_NULL);
+		ut_ad(btr_page_get_next(buf_block_get_frame(block), &mtr)
+		      == FIL_NULL);
+
+		memcpy(root + PAGE_HEADER, buf_block_get_frame(block)
+		       + PAGE_HEADER, PAGE_BTR_SEG_LEAF);
+		mlog_log_string(root + PAGE_HEADER, PAGE_BTR_SEG_LEAF, &mtr);
+		btr_bulk_page_log(root, PAGE_DATA,
+				  buf_block_get_frame(block), &mtr);
+
+		/* Do not let the copy look like a page of the index. */
+		mlog_write_ulint(buf_block_get_frame(block) + FIL_PAGE_TYPE,
+				 FIL_PAGE_TYPE_ALLOCATED, MLOG_2BYTES, &mtr);
+		btr_page_free_low(index, block, level, &mtr);
+		mtr_commit(&mtr);
+	}
+
+	mem_heap_free(bulk->heap);
+	mem_free(bulk);
+
+	return(err);
+}
@@ -67,6 +67,51 @@ reduce the wait time for the threads waiting for a clean block */
 UNIV_INTERN mysql_pfs_key_t buf_page_cleaner_thread_key;
 #endif /* UNIV_PFS_THREAD */
 
+#ifdef UNIV_PFS_MUTEX
+UNIV_INTERN mysql_pfs_key_t page_cleaner_mutex_key;
+#endif /* UNIV_PFS_MUTEX */
+
+/** Work done by one page_cleaner thread in the current batch */
+struct page_cleaner_slot_t {
+	ulint		n_flushed;	/*!< pages flushed */
+	ulint		flush_time;	/*!< time spent in ms */
+	bool		success;	/*!< false if a batch of the same
+					type was already running in some
+					of the buffer pool instances */
+};
+
+/** State shared by the page_cleaner coordinator and worker threads.
+The coordinator requests a batch of one flush type from all threads and
+flushes its own share of the buffer pool instances, then waits for the
+workers to finish theirs. Thread n flushes the instances i for which
+i % srv_n_page_cleaners == n, the coordinator is thread 0. */
+struct page_cleaner_t {
+	ib_mutex_t	mutex;		/*!< protects the fields below */
+	os_event_t	is_requested;	/*!< set when a batch is requested
+					or the workers must exit */
+	os_event_t	is_finished;	/*!< set when n_pending or
+					n_workers drops to zero */
+	ulint		n_workers;	/*!< worker threads not exited */
+	ulint		n_started;	/*!< worker threads started */
+	ulint		n_pending;	/*!< workers yet to finish the
+					current batch */
+	ib_uint64_t	batch;		/*!< number of the current batch,
+					starting from 1 */
+	buf_flush_t	flush_type;	/*!< BUF_FLUSH_LRU or
+					BUF_FLUSH_LIST */
+	ulint		min_n;		/*!< BUF_FLUSH_LIST: wished minimum
+					number of pages per instance */
+	lsn_t		lsn_limit;	/*!< BUF_FLUSH_LIST: lsn up to
+					which to flush */
+	bool		is_running;	/*!< false when the workers must
+					exit */
+	page_cleaner_slot_t*
+			slots;		/*!< srv_n_page_cleaners slots,
+					one for each thread */
+};
+
+static page_cleaner_t*	page_cleaner = NULL;
+
 /** If LRU list of a buf_pool is less than this size then LRU eviction
 should not happen. This is because when we do LRU flushing we also put
 the blocks on free list. If LRU list is very small then we can end up
@@ -1870,6 +1915,53 @@ buf_flush_LRU(
 	return(true);
 }
 
+/*******************************************************************//**
+Flushes dirty blocks from the end of the flush list of a buffer pool
+instance.
+NOTE: The calling thread is not allowed to own any latches on pages!
+@return true if a batch was queued successfully, false if another batch
+of same type was already running */
+static
+bool
+buf_flush_list_low(
+/*===============*/
+	buf_pool_t*	buf_pool,	/*!< in/out: buffer pool instance */
+	ulint		min_n,		/*!< in: wished minimum mumber of blocks
+					flushed in this instance */
+	lsn_t		lsn_limit,	/*!< in: all blocks whose
+					oldest_modification is smaller than
+					this should be flushed */
+	ulint*		n_processed)	/*!< out: the number of pages
+					which were processed */
+{
+	ulint	page_count;
+
+	*n_processed = 0;
+
+	if (!buf_flush_start(buf_pool, BUF_FLUSH_LIST)) {
+		return(false);
+	}
+
+	page_count = buf_flush_batch(
+		buf_pool, BUF_FLUSH_LIST, min_n, lsn_limit);
+
+	buf_flush_end(buf_pool, BUF_FLUSH_LIST);
+
+	buf_flush_common(BUF_FLUSH_LIST, page_count);
+
+	*n_processed = page_count;
+
+	if (page_count) {
+		MONITOR_INC_VALUE_CUMULATIVE(
+			MONITOR_FLUSH_BATCH_TOTAL_PAGE,
+			MONITOR_FLUSH_BATCH_COUNT,
+			MONITOR_FLUSH_BATCH_PAGES,
+			page_count);
+	}
+
+	return(true);
+}
+
 /*******************************************************************//**
 This utility flushes dirty blocks from the end of the flush list of
 all buffer pool instances.
@@ -1917,7 +2009,8 @@ buf_flush_list(
 
 		buf_pool = buf_pool_from_array(i);
 
-		if (!buf_flush_start(buf_pool, BUF_FLUSH_LIST)) {
+		if (!buf_flush_list_low(
+			    buf_pool, min_n, lsn_limit, &page_count)) {
 			/* We have two choices here. If lsn_limit was
 			specified then skipping an instance of buffer
 			pool means we cannot guarantee that all pages
@@ -1933,24 +2026,9 @@ buf_flush_list(
 			continue;
 		}
 
-		page_count = buf_flush_batch(
-			buf_pool, BUF_FLUSH_LIST, min_n, lsn_limit);
-
-		buf_flush_end(buf_pool, BUF_FLUSH_LIST);
-
-		buf_flush_common(BUF_FLUSH_LIST, page_count);
-
 		if (n_processed) {
 			*n_processed += page_count;
 		}
-
-		if (page_count) {
-			MONITOR_INC_VALUE_CUMULATIVE(
-				MONITOR_FLUSH_BATCH_TOTAL_PAGE,
-				MONITOR_FLUSH_BATCH_COUNT,
-				MONITOR_FLUSH_BATCH_PAGES,
-				page_count);
-		}
 	}
 
 	return(success);
@@ -2053,6 +2131,61 @@ buf_flush_single_page_from_LRU(
 	return(freed);
 }
 
+/*********************************************************************//**
+Clears up tail of the LRU list of a buffer pool instance, see
+buf_flush_LRU_tail().
+@return pages flushed */
+static
+ulint
+buf_flush_LRU_tail_low(
+/*===================*/
+	buf_pool_t*	buf_pool)	/*!< in/out: buffer pool instance */
+{
+	ulint	total_flushed = 0;
+	ulint	scan_depth;
+
+	/* srv_LRU_scan_depth can be arbitrarily large value.
+	We cap it with current LRU size. */
+	buf_pool_mutex_enter(buf_pool);
+	scan_depth = UT_LIST_GET_LEN(buf_pool->LRU);
+	buf_pool_mutex_exit(buf_pool);
+
+	scan_depth = ut_min(srv_LRU_scan_depth, scan_depth);
+
+	/* We divide LRU flush into smaller chunks because
+	there may be user threads waiting for the flush to
+	end in buf_LRU_get_free_block(). */
+	for (ulint j = 0;
+	     j < scan_depth;
+	     j += PAGE_CLEANER_LRU_BATCH_CHUNK_SIZE) {
+
+		ulint	n_flushed = 0;
+
+		/* Currently page_cleaner is the only thread
+		that can trigger an LRU flush. It is possible
+		that a batch triggered during last iteration is
+		still running, */
+		if (buf_flush_LRU(buf_pool,
+				  PAGE_CLEANER_LRU_BATCH_CHUNK_SIZE,
+				  &n_flushed)) {
+
+			/* Allowed only one batch per
+			buffer pool instance. */
+			buf_flush_wait_batch_end(
+				buf_pool, BUF_FLUSH_LRU);
+		}
+
+		if (n_flushed) {
+			total_flushed += n_flushed;
+		} else {
+			/* Nothing to flush */
+			break;
+		}
+	}
+
+	return(total_flushed);
+}
+
 /*********************************************************************//**
 Clears up tail of the LRU lists:
 * Put replaceable pages at the tail of LRU to the free list
@@ -2069,47 +2202,8 @@ buf_flush_LRU_tail(void)
 
 	for (ulint i = 0; i < srv_buf_pool_instances; i++) {
 
-		buf_pool_t*	buf_pool = buf_pool_from_array(i);
-		ulint		scan_depth;
-
-		/* srv_LRU_scan_depth can be arbitrarily large value.
-		We cap it with current LRU size. */
-		buf_pool_mutex_enter(buf_pool);
-		scan_depth = UT_LIST_GET_LEN(buf_pool->LRU);
-		buf_pool_mutex_exit(buf_pool);
-
-		scan_depth = ut_min(srv_LRU_scan_depth, scan_depth);
-
-		/* We divide LRU flush into smaller chunks because
-		there may be user threads waiting for the flush to
-		end in buf_LRU_get_free_block(). */
-		for (ulint j = 0;
-		     j < scan_depth;
-		     j += PAGE_CLEANER_LRU_BATCH_CHUNK_SIZE) {
-
-			ulint	n_flushed = 0;
-
-			/* Currently page_cleaner is the only thread
-			that can trigger an LRU flush. It is possible
-			that a batch triggered during last iteration is
-			still running, */
-			if (buf_flush_LRU(buf_pool,
-					  PAGE_CLEANER_LRU_BATCH_CHUNK_SIZE,
-					  &n_flushed)) {
-
-				/* Allowed only one batch per
-				buffer pool instance. */
-				buf_flush_wait_batch_end(
-					buf_pool, BUF_FLUSH_LRU);
-			}
-
-			if (n_flushed) {
-				total_flushed += n_flushed;
-			} else {
-				/* Nothing to flush */
-				break;
-			}
-		}
+		total_flushed += buf_flush_LRU_tail_low(
+			buf_pool_from_array(i));
 	}
 
 	if (total_flushed) {
@@ -2148,6 +2242,201 @@ buf_flush_wait_LRU_batch_end(void)
 	}
 }
 
+/******************************************************************//**
+Creates the page_cleaner state shared by the coordinator and worker
+threads. Must be called before the threads are created. */
+UNIV_INTERN
+void
+buf_flush_page_cleaner_init(void)
+/*=============================*/
+{
+	ut_ad(page_cleaner == NULL);
+
+	page_cleaner = static_cast<page_cleaner_t*>(
+		mem_zalloc(sizeof(*page_cleaner)));
+
+	mutex_create(page_cleaner_mutex_key,
+		     &page_cleaner->mutex, SYNC_NO_ORDER_CHECK);
+
+	page_cleaner->is_requested = os_event_create();
+	page_cleaner->is_finished = os_event_create();
+
+	page_cleaner->n_workers = srv_n_page_cleaners - 1;
+	page_cleaner->is_running = true;
+
+	page_cleaner->slots = static_cast<page_cleaner_slot_t*>(
+		mem_zalloc(srv_n_page_cleaners
+			   * sizeof(*page_cleaner->slots)));
+}
+
+/******************************************************************//**
+Stops the worker threads and frees the page_cleaner state. Called by the
+coordinator when it exits. */
+static
+void
+buf_flush_page_cleaner_close(void)
+/*==============================*/
+{
+	mutex_enter(&page_cleaner->mutex);
+
+	page_cleaner->is_running = false;
+	os_event_set(page_cleaner->is_requested);
+
+	while (page_cleaner->n_workers > 0) {
+		ib_int64_t	sig_count;
+
+		sig_count = os_event_reset(page_cleaner->is_finished);
+		mutex_exit(&page_cleaner->mutex);
+
+		os_event_wait_low(page_cleaner->is_finished, sig_count);
+
+		mutex_enter(&page_cleaner->mutex);
+	}
+
+	mutex_exit(&page_cleaner->mutex);
+
+	os_event_free(page_cleaner->is_finished);
+	os_event_free(page_cleaner->is_requested);
+	mutex_free(&page_cleaner->mutex);
+
+	mem_free(page_cleaner->slots);
+	mem_free(page_cleaner);
+	page_cleaner = NULL;
+}
+
+/*********************************************************************//**
+Flushes the share of the buffer pool instances of one page_cleaner
+thread and records the work done in its slot. */
+static
+void
+page_cleaner_flush_slot(
+/*====================*/
+	ulint		n,		/*!< in: thread number, 0 for the
+					coordinator */
+	buf_flush_t	flush_type,	/*!< in: BUF_FLUSH_LRU or
+					BUF_FLUSH_LIST */
+	ulint		min_n,		/*!< in: BUF_FLUSH_LIST: wished
+					minimum number of pages per
+					instance */
+	lsn_t		lsn_limit)	/*!< in: BUF_FLUSH_LIST: lsn up to
+					which to flush */
+{
+	page_cleaner_slot_t*	slot = &page_cleaner->slots[n];
+	ulint			start_time = ut_time_ms();
+
+	slot->n_flushed = 0;
+	slot->success = true;
+
+	for (ulint i = n; i < srv_buf_pool_instances;
+	     i += srv_n_page_cleaners) {
+
+		buf_pool_t*	buf_pool = buf_pool_from_array(i);
+
+		if (flush_type == BUF_FLUSH_LRU) {
+			slot->n_flushed += buf_flush_LRU_tail_low(buf_pool);
+		} else {
+			ulint	n_flushed;
+
+			if (!buf_flush_list_low(
+				    buf_pool, min_n, lsn_limit, &n_flushed)) {
+				slot->success = false;
+			}
+
+			slot->n_flushed += n_flushed;
+		}
+	}
+
+	slot->flush_time = ut_time_ms() - start_time;
+}
+
+/*********************************************************************//**
+Runs a batch of one flush type in all page_cleaner threads and waits for
+it to finish. Called by the coordinator only.
+@return number of pages flushed */
+static
+ulint
+page_cleaner_flush(
+/*===============*/
+	buf_flush_t	flush_type,	/*!< in: BUF_FLUSH_LRU or
+					BUF_FLUSH_LIST */
+	ulint		min_n,		/*!< in: BUF_FLUSH_LIST: wished
+					minimum number of pages, ULINT_MAX
+					for all up to lsn_limit */
+	lsn_t		lsn_limit)	/*!< in: BUF_FLUSH_LIST: lsn up to
+					which to flush */
+{
+	ulint	n_flushed = 0;
+	ulint	sum_time = 0;
+	ulint	max_time = 0;
+
+	if (min_n != ULINT_MAX) {
+		/* Spread flushing evenly amongst the buffer pool
+		instances, as buf_flush_list() does. */
+		min_n = (min_n + srv_buf_pool_instances - 1)
+			 / srv_buf_pool_instances;
+	}
+
+	mutex_enter(&page_cleaner->mutex);
+
+	page_cleaner->flush_type = flush_type;
+	page_cleaner->min_n = min_n;
+	page_cleaner->lsn_limit = lsn_limit;
+	page_cleaner->n_pending = page_cleaner->n_workers;
+	page_cleaner->batch++;
+
+	if (page_cleaner->n_pending > 0) {
+		os_event_set(page_cleaner->is_requested);
+	}
+
+	mutex_exit(&page_cleaner->mutex);
+
+	page_cleaner_flush_slot(0, flush_type, min_n, lsn_limit);
+
+	mutex_enter(&page_cleaner->mutex);
+
+	while (page_cleaner->n_pending > 0) {
+		ib_int64_t	sig_count;
+
+		sig_count = os_event_reset(page_cleaner->is_finished);
+		mutex_exit(&page_cleaner->mutex);
+
+		os_event_wait_low(page_cleaner->is_finished, sig_count);
+
+		mutex_enter(&page_cleaner->mutex);
+	}
+
+	mutex_exit(&page_cleaner->mutex);
+
+	for (ulint n = 0; n < srv_n_page_cleaners; n++) {
+		const page_cleaner_slot_t*	slot = &page_cleaner->slots[n];
+
+		n_flushed += slot->n_flushed;
+		sum_time += slot->flush_time;
+		max_time = ut_max(max_time, slot->flush_time);
+	}
+
+	if (flush_type == BUF_FLUSH_LRU) {
+		MONITOR_SET(MONITOR_LRU_BATCH_FLUSH_AVG_TIME_THREAD,
+			    sum_time / srv_n_page_cleaners);
+		MONITOR_SET(MONITOR_LRU_BATCH_FLUSH_MAX_TIME_THREAD,
+			    max_time);
+
+		if (n_flushed) {
+			MONITOR_INC_VALUE_CUMULATIVE(
+				MONITOR_LRU_BATCH_TOTAL_PAGE,
+				MONITOR_LRU_BATCH_COUNT,
+				MONITOR_LRU_BATCH_PAGES,
+				n_flushed);
+		}
+	} else {
+		MONITOR_SET(MONITOR_FLUSH_AVG_TIME_THREAD,
+			    sum_time / srv_n_page_cleaners);
+		MONITOR_SET(MONITOR_FLUSH_MAX_TIME_THREAD, max_time);
+	}
+
+	return(n_flushed);
+}
+
 /*********************************************************************//**
 Flush a batch of dirty pages from the flush list
 @return number of pages flushed, 0 if no page is flushed or if another
@@ -2161,11 +2450,7 @@ page_cleaner_do_flush_batch(
 	lsn_t		lsn_limit)	/*!< in: LSN up to which flushing
 					must happen */
 {
-	ulint n_flushed;
-
-	buf_flush_list(n_to_flush, lsn_limit, &n_flushed);
-
-	return(n_flushed);
+	return(page_cleaner_flush(BUF_FLUSH_LIST, n_to_flush, lsn_limit));
 }
 
 /*********************************************************************//**
@@ -2377,8 +2662,9 @@ page_cleaner_sleep_if_needed(
 }
 
 /******************************************************************//**
-page_cleaner thread tasked with flushing dirty pages from the buffer
-pools. As of now we'll have only one instance of this thread.
+page_cleaner coordinator thread tasked with flushing dirty pages from the
+buffer pools. It flushes its own share of the buffer pool instances and
+hands out the rest to the worker threads.
 @return a dummy parameter */
 extern "C" UNIV_INTERN
 os_thread_ret_t
@@ -2423,7 +2709,8 @@ DECLARE_THREAD(buf_flush_page_cleaner_thread)(
 			last_activity = srv_get_activity_count();
 
 			/* Flush pages from end of LRU if required */
-			n_flushed = buf_flush_LRU_tail();
+			n_flushed = page_cleaner_flush(
+				BUF_FLUSH_LRU, 0, LSN_MAX);
 
 			/* Flush pages from flush_list if required */
 			n_flushed += page_cleaner_flush_pages_if_needed();
@@ -2505,6 +2792,8 @@ DECLARE_THREAD(buf_flush_page_cleaner_thread)(
 	/* We have lived our life. Time to die. */
 
 thread_exit:
+	buf_flush_page_cleaner_close();
+
 	buf_page_cleaner_is_active = FALSE;
 
 	my_thread_end();
@@ -2515,6 +2804,91 @@ thread_exit:
 	OS_THREAD_DUMMY_RETURN;
 }
 
+/******************************************************************//**
+page_cleaner worker thread, srv_n_page_cleaners - 1 of these flush the
+buffer pool instances that the coordinator hands out to them.
+@return a dummy parameter */
+extern "C" UNIV_INTERN
+os_thread_ret_t
+DECLARE_THREAD(buf_flush_page_cleaner_worker)(
+/*==========================================*/
+	void*	arg MY_ATTRIBUTE((unused)))
+			/*!< in: a dummy parameter required by
+			os_thread_create */
+{
+	my_thread_init();
+	ulint		n;
+	ib_uint64_t	last_batch = 0;
+
+	ut_ad(!srv_read_only_mode);
+
+#ifdef UNIV_PFS_THREAD
+	pfs_register_thread(buf_page_cleaner_thread_key);
+#endif /* UNIV_PFS_THREAD */
+
+	mutex_enter(&page_cleaner->mutex);
+
+	n = ++page_cleaner->n_started;
+	ut_a(n < srv_n_page_cleaners);
+
+	for (;;) {
+		buf_flush_t	flush_type;
+		ulint		min_n;
+		lsn_t		lsn_limit;
+
+		/* The coordinator waits for all workers to finish a
+		batch before it requests the next one, so a worker
+		that starts late can only have missed the current
+		batch. */
+		while (page_cleaner->is_running
+		       && page_cleaner->batch == last_batch) {
+			ib_int64_t	sig_count;
+
+			sig_count = os_event_reset(page_cleaner->is_requested);
+			mutex_exit(&page_cleaner->mutex);
+
+			os_event_wait_low(page_cleaner->is_requested,
+					  sig_count);
+
+			mutex_enter(&page_cleaner->mutex);
+		}
+
+		if (!page_cleaner->is_running) {
+			break;
+		}
+
+		last_batch = page_cleaner->batch;
+		flush_type = page_cleaner->flush_type;
+		min_n = page_cleaner->min_n;
+		lsn_limit = page_cleaner->lsn_limit;
+
+		mutex_exit(&page_cleaner->mutex);
+
+		page_cleaner_flush_slot(n, flush_type, min_n, lsn_limit);
+
+		mutex_enter(&page_cleaner->mutex);
+
+		ut_ad(page_cleaner->n_pending > 0);
+
+		if (--page_cleaner->n_pending == 0) {
+			os_event_set(page_cleaner->is_finished);
+		}
+	}
+
+	if (--page_cleaner->n_workers == 0) {
+		os_event_set(page_cleaner->is_finished);
+	}
+
+	mutex_exit(&page_cleaner->mutex);
+
+	my_thread_end();
+	/* We count the number of threads in os_thread_exit(). A created
+	thread should always use that to exit and not use return() to exit. */
+	os_thread_exit(NULL);
+
+	OS_THREAD_DUMMY_RETURN;
+}
+
 #if defined UNIV_DEBUG || defined UNIV_BUF_DEBUG
 
 /** Functor to validate the flush list. */
@@ -28,6 +28,8 @@ Created 10/25/1995 Heikki Tuuri
 #include <debug_sync.h>
 #include <my_dbug.h>
 
+#include <set>
+
 #include "mem0mem.h"
 #include "hash0hash.h"
 #include "os0file.h"
@@ -309,6 +311,10 @@ struct fil_system_t {
 					/* !< TRUE if fil_space_create()
 					has issued a warning about
 					potential space_id reuse */
+#ifdef WITH_INNODB_DISALLOW_WRITES
+	ibool		snapshot_active;/*!< TRUE if writes must save the
+					pages for fil_snapshot first */
+#endif /* WITH_INNODB_DISALLOW_WRITES */
 };
 
 /** The tablespace memory cache. This variable is NULL before the module is
@@ -329,6 +335,523 @@ static fil_system_t*	fil_system	= NULL;
 # define fil_buffering_disabled(s)	(0)
 #endif /* __WIN__ */
 
+#ifdef WITH_INNODB_DISALLOW_WRITES
+/* Snapshot for state transfer. While a snapshot is active, the original
+contents of every page that is written for the first time are appended to
+FIL_SNAPSHOT_TMP. Data and log files copied during the snapshot, with the
+saved pages written back over them, are the files as they were when the
+snapshot began, which InnoDB can recover like after a crash. Creating,
+deleting and renaming tablespaces waits until the snapshot ends, in
+row_mysql_lock_data_dictionary() before the dictionary is locked. */
+
+/** Saved pages while the snapshot is active */
+#define FIL_SNAPSHOT_TMP	"ib_snapshot.tmp"
+/** Saved pages of a complete snapshot, for the state transfer to copy */
+#define FIL_SNAPSHOT_DONE	"ib_snapshot.done"
+/** Saved pages to apply at startup */
+#define FIL_SNAPSHOT_APPLY	"ib_snapshot"
+
+/** Magic at the start of the file */
+#define FIL_SNAPSHOT_MAGIC	"InnoDB snapshot1"
+#define FIL_SNAPSHOT_MAGIC_LEN	16
+
+/** Header of a saved page: type, name length, offset, length, followed by
+the file name and the page contents */
+#define FIL_SNAPSHOT_TYPE	0
+#define FIL_SNAPSHOT_NAME_LEN	4
+#define FIL_SNAPSHOT_OFFSET	8
+#define FIL_SNAPSHOT_LEN	16
+#define FIL_SNAPSHOT_HDR_SIZE	20
+
+/** Saved page types. Log file names are relative to
+innodb_log_group_home_dir, which may differ on the node applying them. */
+#define FIL_SNAPSHOT_DATA_PAGE	1
+#define FIL_SNAPSHOT_LOG_PAGE	2
+
+/** Snapshot state, protected by mutex */
+struct fil_snapshot_t {
+	ib_mutex_t	mutex;		/*!< protects the fields below */
+	os_event_t	no_snapshot;	/*!< set when no snapshot is active,
+					tablespace DDL waits for it */
+	ibool		open;		/*!< TRUE if file is open */
+	ibool		ending;		/*!< TRUE if fil_snapshot_end() is
+					waiting for the pages being saved */
+	ibool		failed;		/*!< TRUE if saving a page failed */
+	ib_time_t	begin_time;	/*!< when the snapshot began */
+	pfs_os_file_t	file;		/*!< FIL_SNAPSHOT_TMP */
+	os_offset_t	size;		/*!< bytes reserved in file */
+	ulint		n_pages;	/*!< number of saved pages */
+	ulint		n_pending;	/*!< number of pages being saved
+					outside of mutex */
+	std::set<ib_uint64_t>*	saved;	/*!< (space id, page number) of
+					saved pages */
+};
+
+static fil_snapshot_t	fil_snapshot;
+
+#ifdef UNIV_PFS_MUTEX
+/* Key to register fil_snapshot mutex with performance schema */
+UNIV_INTERN mysql_pfs_key_t	fil_snapshot_mutex_key;
+#endif /* UNIV_PFS_MUTEX */
+
+/********************************************************************//**
+Makes the path of a snapshot file in the data directory. */
+static
+void
+fil_snapshot_path(
+/*==============*/
+	char*		path,	/*!< out: path, OS_FILE_MAX_PATH bytes */
+	const char*	name)	/*!< in: file name */
+{
+	ut_snprintf(path, OS_FILE_MAX_PATH, "%s%c%s",
+		    fil_path_to_mysql_datadir, SRV_PATH_SEPARATOR, name);
+}
+
+/********************************************************************//**
+Waits until no snapshot is active. */
+UNIV_INTERN
+void
+fil_snapshot_wait(void)
+/*===================*/
+{
+	os_event_wait(fil_snapshot.no_snapshot);
+}
+
+/********************************************************************//**
+Checks if a snapshot is active.
+@return TRUE if a snapshot is active */
+UNIV_INTERN
+ibool
+fil_snapshot_is_active(void)
+/*========================*/
+{
+	return(fil_system->snapshot_active);
+}
+
+/********************************************************************//**
+Saves the current contents of the pages of a file node that a write is
+about to overwrite, unless they were saved already. The mutex is held only
+to claim a page and its place in the file; the page is read and written
+outside of it. Writes of the same page do not run concurrently (pages are
+io-fixed while flushed, and log writes are serialized), so the page is not
+overwritten before the write claiming it has read it. */
+static
+void
+fil_snapshot_save(
+/*==============*/
+	fil_node_t*	node,		/*!< in: file node, prepared for i/o */
+	ulint		first_page,	/*!< in: page number of the first page
+					of the node in the space */
+	ulint		page_size,	/*!< in: page size of the space */
+	os_offset_t	offset,		/*!< in: offset of the write */
+	ulint		len)		/*!< in: length of the write */
+{
+	const char*	name = node->name;
+	ulint		type = FIL_SNAPSHOT_DATA_PAGE;
+
+	if (node->space->purpose == FIL_LOG) {
+		const char*	sep = strrchr(name, SRV_PATH_SEPARATOR);
+
+		name = sep ? sep + 1 : name;
+		type = FIL_SNAPSHOT_LOG_PAGE;
+	}
+
+	ulint	name_len = ut_strlen(name);
+	ulint	hdr_len = FIL_SNAPSHOT_HDR_SIZE + name_len;
+	byte*	buf = NULL;
+	byte*	page_buf = NULL;
+	byte*	hdr = NULL;
+
+	for (ulint page = (ulint) (offset / page_size);
+	     page <= (ulint) ((offset + len - 1) / page_size);
+	     page++) {
+
+		ib_uint64_t	key = (ib_uint64_t) node->space->id << 32
+			| (first_page + page);
+		os_offset_t	page_offset = (os_offset_t) page * page_size;
+		os_offset_t	file_offset;
+
+		mutex_enter(&fil_snapshot.mutex);
+
+		if (!fil_snapshot.open || fil_snapshot.ending) {
+			mutex_exit(&fil_snapshot.mutex);
+			break;
+		}
+
+		if (!fil_snapshot.saved->insert(key).second) {
+			mutex_exit(&fil_snapshot.mutex);
+			continue;
+		}
+
+		file_offset = fil_snapshot.size;
+		fil_snapshot.size += hdr_len + page_size;
+		fil_snapshot.n_pages++;
+		fil_snapshot.n_pending++;
+
+		mutex_exit(&fil_snapshot.mutex);
+
+		if (buf == NULL) {
+			/* The page buffer is aligned for O_DIRECT */
+			buf = static_cast<byte*>(ut_malloc(
+				2 * UNIV_PAGE_SIZE_MAX + hdr_len));
+			page_buf = static_cast<byte*>(ut_align(
+				buf, UNIV_PAGE_SIZE_MAX));
+			hdr = buf + 2 * UNIV_PAGE_SIZE_MAX;
+
+			mach_write_to_4(hdr + FIL_SNAPSHOT_TYPE, type);
+			mach_write_to_4(hdr + FIL_SNAPSHOT_NAME_LEN,
+					name_len);
+			mach_write_to_4(hdr + FIL_SNAPSHOT_LEN, page_size);
+			memcpy(hdr + FIL_SNAPSHOT_HDR_SIZE, name, name_len);
+		}
+
+		mach_write_to_8(hdr + FIL_SNAPSHOT_OFFSET, page_offset);
+
+		ibool	success = os_file_read(node->handle, page_buf,
+					       page_offset, page_size)
+			&& os_file_write(FIL_SNAPSHOT_TMP, fil_snapshot.file,
+					 hdr, file_offset, hdr_len)
+			&& os_file_write(FIL_SNAPSHOT_TMP, fil_snapshot.file,
+					 page_buf, file_offset + hdr_len,
+					 page_size);
+
+		mutex_enter(&fil_snapshot.mutex);
+		fil_snapshot.n_pending--;
+		if (!success) {
+			fil_snapshot.failed = TRUE;
+		}
+		mutex_exit(&fil_snapshot.mutex);
+
+		if (!success) {
+			ib_logf(IB_LOG_LEVEL_ERROR,
+				"Could not save page %lu of '%s' for the"
+				" snapshot, the snapshot is not usable",
+				(ulong) page, node->name);
+			break;
+		}
+	}
+
+	ut_free(buf);
+}
+
+/********************************************************************//**
+Begins a snapshot. The caller must make sure that the log is written up to
+the changes that the snapshot must include.
+@return DB_SUCCESS or error code */
+UNIV_INTERN
+dberr_t
+fil_snapshot_begin(void)
+/*====================*/
+{
+	char	path[OS_FILE_MAX_PATH];
+	ibool	success;
+
+	ut_ad(!srv_read_only_mode);
+
+	/* Wait for tablespace DDL in progress, and keep new DDL from
+	starting until the snapshot is marked active. */
+	rw_lock_x_lock(&dict_operation_lock);
+	mutex_enter(&fil_snapshot.mutex);
+
+	if (fil_snapshot.open) {
+		dberr_t	err = fil_snapshot.ending ? DB_ERROR : DB_SUCCESS;
+
+		mutex_exit(&fil_snapshot.mutex);
+		rw_lock_x_unlock(&dict_operation_lock);
+		return(err);
+	}
+
+	fil_snapshot_path(path, FIL_SNAPSHOT_DONE);
+	os_file_delete_if_exists(innodb_file_data_key, path);
+	fil_snapshot_path(path, FIL_SNAPSHOT_TMP);
+	os_file_delete_if_exists(innodb_file_data_key, path);
+
+	fil_snapshot.file = os_file_create_simple_no_error_handling(
+		innodb_file_data_key, path, OS_FILE_CREATE,
+		OS_FILE_READ_WRITE, &success);
+
+	if (!success
+	    || !os_file_write(path, fil_snapshot.file, FIL_SNAPSHOT_MAGIC,
+			      0, FIL_SNAPSHOT_MAGIC_LEN)) {
+		if (success) {
+			os_file_close(fil_snapshot.file);
+		}
+		mutex_exit(&fil_snapshot.mutex);
+		rw_lock_x_unlock(&dict_operation_lock);
+		ib_logf(IB_LOG_LEVEL_ERROR,
+			"Could not create snapshot file '%s'", path);
+		return(DB_ERROR);
+	}
+
+	fil_snapshot.open = TRUE;
+	fil_snapshot.ending = FALSE;
+	fil_snapshot.failed = FALSE;
+	fil_snapshot.begin_time = ut_time();
+	fil_snapshot.size = FIL_SNAPSHOT_MAGIC_LEN;
+	fil_snapshot.n_pages = 0;
+	fil_snapshot.n_pending = 0;
+	fil_snapshot.saved = new std::set<ib_uint64_t>();
+	os_event_reset(fil_snapshot.no_snapshot);
+
+	/* Writes that find the flag set save the pages first. */
+	mutex_enter(&fil_system->mutex);
+	fil_system->snapshot_active = TRUE;
+	mutex_exit(&fil_system->mutex);
+
+	mutex_exit(&fil_snapshot.mutex);
+	rw_lock_x_unlock(&dict_operation_lock);
+
+	ib_logf(IB_LOG_LEVEL_INFO, "Snapshot begins at LSN " LSN_PF,
+		log_get_lsn());
+
+	return(DB_SUCCESS);
+}
+
+/********************************************************************//**
+Ends the snapshot. If all pages were saved, FIL_SNAPSHOT_TMP is renamed to
+FIL_SNAPSHOT_DONE, otherwise it is deleted.
+@return TRUE if a snapshot was ended */
+static
+ibool
+fil_snapshot_end_low(
+/*=================*/
+	ulint	timeout)	/*!< in: if nonzero, end the snapshot as
+				failed only if it has been active for
+				this many seconds */
+{
+	char	path[OS_FILE_MAX_PATH];
+	char	done_path[OS_FILE_MAX_PATH];
+
+	mutex_enter(&fil_snapshot.mutex);
+
+	if (!fil_snapshot.open || fil_snapshot.ending
+	    || (timeout && ut_difftime(ut_time(), fil_snapshot.begin_time)
+		< timeout)) {
+		mutex_exit(&fil_snapshot.mutex);
+		return(FALSE);
+	}
+
+	if (timeout) {
+		ib_logf(IB_LOG_LEVEL_WARN,
+			"Snapshot has been active for more than %lu"
+			" seconds, ending it", (ulong) timeout);
+		fil_snapshot.failed = TRUE;
+	}
+
+	fil_snapshot.ending = TRUE;
+
+	mutex_enter(&fil_system->mutex);
+	fil_system->snapshot_active = FALSE;
+	mutex_exit(&fil_system->mutex);
+
+	/* Wait for the pages being saved */
+	while (fil_snapshot.n_pending) {
+		mutex_exit(&fil_snapshot.mutex);
+		os_thread_sleep(1000);
+		mutex_enter(&fil_snapshot.mutex);
+	}
+
+	fil_snapshot_path(path, FIL_SNAPSHOT_TMP);
+	fil_snapshot_path(done_path, FIL_SNAPSHOT_DONE);
+
+	if (!os_file_flush(fil_snapshot.file)) {
+		fil_snapshot.failed = TRUE;
+	}
+	os_file_close(fil_snapshot.file);
+
+	if (fil_snapshot.failed
+	    || !os_file_rename(innodb_file_data_key, path, done_path)) {
+		os_file_delete_if_exists(innodb_file_data_key, path);
+		ib_logf(IB_LOG_LEVEL_ERROR, "Snapshot failed");
+	} else {
+		ib_logf(IB_LOG_LEVEL_INFO,
+			"Snapshot ends at LSN " LSN_PF ", %lu pages saved",
+			log_get_lsn(), (ulong) fil_snapshot.n_pages);
+	}
+
+	fil_snapshot.open = FALSE;
+	fil_snapshot.ending = FALSE;
+	delete fil_snapshot.saved;
+	fil_snapshot.saved = NULL;
+	os_event_set(fil_snapshot.no_snapshot);
+
+	mutex_exit(&fil_snapshot.mutex);
+
+	return(TRUE);
+}
+
+/********************************************************************//**
+Ends the snapshot. If all pages were saved, FIL_SNAPSHOT_TMP is renamed to
+FIL_SNAPSHOT_DONE, otherwise it is deleted. */
+UNIV_INTERN
+void
+fil_snapshot_end(void)
+/*==================*/
+{
+	fil_snapshot_end_low(0);
+}
+
+/********************************************************************//**
+Ends the snapshot as failed if it has been active for too long.
+@return TRUE if the snapshot was ended */
+UNIV_INTERN
+ibool
+fil_snapshot_end_if_expired(
+/*========================*/
+	ulint	timeout)	/*!< in: seconds */
+{
+	ut_ad(timeout);
+
+	return(fil_system->snapshot_active
+	       && fil_snapshot_end_low(timeout));
+}
+
+/********************************************************************//**
+Writes the pages saved by a snapshot on another node back over the data and
+log files copied from there, if FIL_SNAPSHOT_APPLY exists. Called at startup
+before the files are opened.
+@return DB_SUCCESS or error code */
+UNIV_INTERN
+dberr_t
+fil_snapshot_apply(void)
+/*====================*/
+{
+	char		path[OS_FILE_MAX_PATH];
+	char		name[OS_FILE_MAX_PATH];
+	char		target[OS_FILE_MAX_PATH];
+	byte		hdr[FIL_SNAPSHOT_HDR_SIZE];
+	byte		magic[FIL_SNAPSHOT_MAGIC_LEN];
+	pfs_os_file_t	file;
+	pfs_os_file_t	target_file;
+	ibool		target_open = FALSE;
+	ibool		success;
+	os_offset_t	offset = FIL_SNAPSHOT_MAGIC_LEN;
+	os_offset_t	size;
+	ulint		n_pages = 0;
+	dberr_t		err = DB_SUCCESS;
+
+	fil_snapshot_path(path, FIL_SNAPSHOT_APPLY);
+
+	file = os_file_create_simple_no_error_handling(
+		innodb_file_data_key, path, OS_FILE_OPEN,
+		OS_FILE_READ_ONLY, &success);
+
+	if (!success) {
+		return(DB_SUCCESS);
+	}
+
+	size = os_file_get_size(file);
+
+	byte*	buf = static_cast<byte*>(ut_malloc(UNIV_PAGE_SIZE_MAX));
+
+	if (!os_file_read(file, magic, 0, FIL_SNAPSHOT_MAGIC_LEN)
+	    || memcmp(magic, FIL_SNAPSHOT_MAGIC, FIL_SNAPSHOT_MAGIC_LEN)) {
+		err = DB_CORRUPTION;
+	}
+
+	target[0] = '\0';
+
+	while (err == DB_SUCCESS && offset < size) {
+		if (!os_file_read(file, hdr, offset, FIL_SNAPSHOT_HDR_SIZE)) {
+			err = DB_CORRUPTION;
+			break;
+		}
+
+		ulint		type = mach_read_from_4(hdr + FIL_SNAPSHOT_TYPE);
+		ulint		name_len = mach_read_from_4(
+			hdr + FIL_SNAPSHOT_NAME_LEN);
+		os_offset_t	page_offset = mach_read_from_8(
+			hdr + FIL_SNAPSHOT_OFFSET);
+		ulint		len = mach_read_from_4(hdr + FIL_SNAPSHOT_LEN);
+
+		offset += FIL_SNAPSHOT_HDR_SIZE;
+
+		if (name_len == 0 || name_len >= OS_FILE_MAX_PATH
+		    || len == 0 || len > UNIV_PAGE_SIZE_MAX
+		    || !os_file_read(file, name, offset, name_len)
+		    || !os_file_read(file, buf, offset + name_len, len)) {
+			err = DB_CORRUPTION;
+			break;
+		}
+
+		offset += name_len + len;
+		name[name_len] = '\0';
+
+		if (type == FIL_SNAPSHOT_LOG_PAGE) {
+			ulint	dirlen = ut_strlen(srv_log_group_home_dir);
+			ulint	seplen = dirlen && srv_log_group_home_dir[
+				dirlen - 1] != SRV_PATH_SEPARATOR;
+
+			if (dirlen + seplen + name_len >= sizeof path) {
+				err = DB_CORRUPTION;
+				break;
+			}
+
+			memcpy(path, srv_log_group_home_dir, dirlen);
+			path[dirlen] = SRV_PATH_SEPARATOR;
+			memcpy(path + dirlen + seplen, name, name_len + 1);
+		} else if (type == FIL_SNAPSHOT_DATA_PAGE) {
+			ut_strcpy(path, name);
+		} else {
+			err = DB_CORRUPTION;
+			break;
+		}
+
+		if (strcmp(path, target)) {
+			if (target_open) {
+				os_file_flush(target_file);
+				os_file_close(target_file);
+			}
+
+			ut_strcpy(target, path);
+			target_file = os_file_create_simple_no_error_handling(
+				innodb_file_data_key, target, OS_FILE_OPEN,
+				OS_FILE_READ_WRITE, &target_open);
+
+			if (!target_open) {
+				ib_logf(IB_LOG_LEVEL_ERROR,
+					"Could not open '%s' to apply the"
+					" snapshot", target);
+				err = DB_ERROR;
+				break;
+			}
+		}
+
+		if (!os_file_write(target, target_file, buf,
+				   page_offset, len)) {
+			err = DB_ERROR;
+			break;
+		}
+
+		n_pages++;
+	}
+
+	if (target_open) {
+		os_file_flush(target_file);
+		os_file_close(target_file);
+	}
+
+	os_file_close(file);
+	ut_free(buf);
+
+	fil_snapshot_path(path, FIL_SNAPSHOT_APPLY);
+
+	if (err != DB_SUCCESS) {
+		ib_logf(IB_LOG_LEVEL_ERROR,
+			"Could not apply snapshot '%s': %s", path,
+			ut_strerr(err));
+		return(err);
+	}
+
+	ib_logf(IB_LOG_LEVEL_INFO, "Applied %lu pages from snapshot '%s'",
+		(ulong) n_pages, path);
+
+	os_file_delete(innodb_file_data_key, path);
+
+	return(DB_SUCCESS);
+}
+#endif /* WITH_INNODB_DISALLOW_WRITES */
+
 #ifdef UNIV_DEBUG
 /** Try fil_validate() every this many times */
 # define FIL_VALIDATE_SKIP	17
@@ -1696,6 +2219,13 @@ fil_init(
 	UT_LIST_INIT(fil_system->LRU);
 
 	fil_system->max_n_open = max_n_open;
+
+#ifdef WITH_INNODB_DISALLOW_WRITES
+	mutex_create(fil_snapshot_mutex_key,
+		     &fil_snapshot.mutex, SYNC_NO_ORDER_CHECK);
+	fil_snapshot.no_snapshot = os_event_create();
+	os_event_set(fil_snapshot.no_snapshot);
+#endif /* WITH_INNODB_DISALLOW_WRITES */
 }
 
 /*******************************************************************//**
@@ -2694,6 +3224,11 @@ fil_delete_tablespace(
 
 	ut_a(id != TRX_SYS_SPACE);
 
+#ifdef WITH_INNODB_DISALLOW_WRITES
+	/* row_mysql_lock_data_dictionary() waited for the snapshot */
+	ut_ad(!fil_snapshot_is_active());
+#endif /* WITH_INNODB_DISALLOW_WRITES */
+
 	dberr_t		err = fil_check_pending_operations(id, &space, &path);
 
 	if (err != DB_SUCCESS) {
@@ -3066,6 +3601,11 @@ fil_rename_tablespace(
 
 	ut_a(id != 0);
 
+#ifdef WITH_INNODB_DISALLOW_WRITES
+	/* row_mysql_lock_data_dictionary() waited for the snapshot */
+	ut_ad(!fil_snapshot_is_active());
+#endif /* WITH_INNODB_DISALLOW_WRITES */
+
 retry:
 	count++;
 
@@ -3439,6 +3979,11 @@ fil_create_new_single_table_tablespace(
 	ut_a(size >= FIL_IBD_FILE_INITIAL_SIZE);
 	ut_a(fsp_flags_is_valid(flags));
 
+#ifdef WITH_INNODB_DISALLOW_WRITES
+	/* row_mysql_lock_data_dictionary() waited for the snapshot */
+	ut_ad(!fil_snapshot_is_active());
+#endif /* WITH_INNODB_DISALLOW_WRITES */
+
 	if (is_temp) {
 		/* Temporary table filepath */
 		ut_ad(dir_path);
@@ -5570,6 +6115,10 @@ fil_io(
 	ulint		wake_later;
 	os_offset_t	offset;
 	ibool		ignore_nonexistent_pages;
+#ifdef WITH_INNODB_DISALLOW_WRITES
+	ulint		first_page = block_offset;
+	ibool		snapshot;
+#endif /* WITH_INNODB_DISALLOW_WRITES */
 
 	is_log = type & OS_FILE_LOG;
 	type = type & ~OS_FILE_LOG;
@@ -5716,6 +6265,11 @@ fil_io(
 		ut_error;
 	}
 
+#ifdef WITH_INNODB_DISALLOW_WRITES
+	snapshot = type == OS_FILE_WRITE && fil_system->snapshot_active;
+	first_page -= block_offset;
+#endif /* WITH_INNODB_DISALLOW_WRITES */
+
 	/* Now we have made the changes in the data structures of fil_system */
 	mutex_exit(&fil_system->mutex);
 
@@ -5749,6 +6303,14 @@ fil_io(
 	ut_a(byte_offset % OS_FILE_LOG_BLOCK_SIZE == 0);
 	ut_a((len % OS_FILE_LOG_BLOCK_SIZE) == 0);
 
+#ifdef WITH_INNODB_DISALLOW_WRITES
+	if (snapshot) {
+		fil_snapshot_save(node, first_page,
+				  zip_size ? zip_size : UNIV_PAGE_SIZE,
+				  offset, len);
+	}
+#endif /* WITH_INNODB_DISALLOW_WRITES */
+
 #ifdef UNIV_HOTBACKUP
 	/* In mysqlbackup do normal i/o, not aio */
 	if (type == OS_FILE_READ) {
@@ -69,6 +69,7 @@ this program; if not, write to the Free Software Foundation, Inc.,
 #include "dict0crea.h"
 #include "btr0cur.h"
 #include "btr0btr.h"
+#include "btr0bulk.h"
 #include "fsp0fsp.h"
 #include "sync0sync.h"
 #include "fil0fil.h"
@@ -109,19 +110,20 @@ enum_tx_isolation thd_get_trx_isolation(const THD* thd);
 #ifdef WITH_WSREP
 #include "../storage/innobase/include/ut0byte.h"
 #include <wsrep_mysqld.h>
+#include <wsrep_conflict_stats.h>
 #include <my_md5.h>
+#include <my_murmur3.h>
 extern my_bool wsrep_certify_nonPK;
 class  binlog_trx_data;
 extern handlerton *binlog_hton;
 
-extern MYSQL_PLUGIN_IMPORT mysql_mutex_t LOCK_wsrep_rollback;
-extern MYSQL_PLUGIN_IMPORT mysql_cond_t COND_wsrep_rollback;
-extern MYSQL_PLUGIN_IMPORT wsrep_aborting_thd_t wsrep_aborting_thd;
-
-static inline wsrep_ws_handle_t*
-wsrep_ws_handle(THD* thd, const trx_t* trx) {
-	return wsrep_ws_handle_for_trx(wsrep_thd_ws_handle(thd),
-				       (wsrep_trx_id_t)trx->id);
+/** Bind the write set handle of thd to the InnoDB transaction id.
+wsrep_append_row_key() buffers keys against thd->wsrep_ws_handle, so the
+handle must carry the id of the transaction before keys are appended. */
+static inline void
+wsrep_ws_handle_set_trx(THD* thd, const trx_t* trx) {
+	wsrep_ws_handle_for_trx(wsrep_thd_ws_handle(thd),
+				(wsrep_trx_id_t)trx->id);
 }
 
 extern bool wsrep_prepare_key_for_innodb(const uchar *cache_key,
@@ -324,6 +326,9 @@ static PSI_mutex_info all_innodb_mutexes[] = {
 	{&dict_sys_mutex_key, "dict_sys_mutex", 0},
 	{&file_format_max_mutex_key, "file_format_max_mutex", 0},
 	{&fil_system_mutex_key, "fil_system_mutex", 0},
+#  ifdef WITH_INNODB_DISALLOW_WRITES
+	{&fil_snapshot_mutex_key, "fil_snapshot_mutex", 0},
+#  endif /* WITH_INNODB_DISALLOW_WRITES */
 	{&flush_list_mutex_key, "flush_list_mutex", 0},
 	{&fts_bg_threads_mutex_key, "fts_bg_threads_mutex", 0},
 	{&fts_delete_mutex_key, "fts_delete_mutex", 0},
@@ -345,10 +350,12 @@ static PSI_mutex_info all_innodb_mutexes[] = {
 #  endif /* UNIV_MEM_DEBUG */
 	{&mem_pool_mutex_key, "mem_pool_mutex", 0},
 	{&mutex_list_mutex_key, "mutex_list_mutex", 0},
+	{&page_cleaner_mutex_key, "page_cleaner_mutex", 0},
 	{&page_zip_stat_per_index_mutex_key, "page_zip_stat_per_index_mutex", 0},
 	{&purge_sys_bh_mutex_key, "purge_sys_bh_mutex", 0},
 	{&recv_sys_mutex_key, "recv_sys_mutex", 0},
 	{&recv_writer_mutex_key, "recv_writer_mutex", 0},
+	{&row_merge_scan_mutex_key, "row_merge_scan_mutex", 0},
 	{&rseg_mutex_key, "rseg_mutex", 0},
 #  ifdef UNIV_SYNC_DEBUG
 	{&rw_lock_debug_mutex_key, "rw_lock_debug_mutex", 0},
@@ -4945,8 +4952,9 @@ ha_innobase::open(
 	thd = ha_thd();
 
 	/* Under some cases MySQL seems to call this function while
-	holding btr_search_latch. This breaks the latching order as
-	we acquire dict_sys->mutex below and leads to a deadlock. */
+	holding an adaptive hash index latch. This breaks the latching
+	order as we acquire dict_sys->mutex below and leads to a
+	deadlock. */
 	if (thd != NULL) {
 		innobase_release_temporary_latches(ht, thd);
 	}
@@ -9242,6 +9250,39 @@ ha_innobase::ft_end()
 	rnd_end();
 }
 #ifdef WITH_WSREP
+/** Length of a key with its value replaced by hash: index number + hash */
+#define WSREP_HASHED_KEY_LEN	(1 + MURMUR3_128_LEN)
+
+/*********************************************************************//**
+Replaces a wide key value with its 128-bit hash if wsrep_hash_keys is set.
+The first key byte (index number) is kept as is. Equal keys give equal
+hashes, so conflicts between them are still detected, and a hash collision
+can only cause a false conflict. The rule depends on the key alone, so row
+keys and foreign keys appended for the same row still match. The bytes saved
+are counted in thd and added to wsrep_hash_keys_bytes_saved at commit.
+@return key to append: either key itself or its hash stored in buf */
+static
+const uchar*
+wsrep_hash_key(
+/*===========*/
+	THD*		thd,	/*!< in/out: thread appending the key */
+	const uchar*	key,	/*!< in: key */
+	ulint*		len,	/*!< in/out: key length */
+	uchar*		buf)	/*!< out: WSREP_HASHED_KEY_LEN bytes buffer */
+{
+	if (!wsrep_hash_keys || *len <= WSREP_HASHED_KEY_LEN) {
+		return(key);
+	}
+
+	buf[0] = key[0];
+	murmur3_128(key + 1, *len - 1, 0, buf + 1);
+
+	wsrep_hash_keys_add(thd, *len - WSREP_HASHED_KEY_LEN);
+	*len = WSREP_HASHED_KEY_LEN;
+
+	return(buf);
+}
+
 dict_index_t*
 wsrep_dict_foreign_find_index(
 	dict_table_t*	table,
@@ -9266,13 +9307,14 @@ wsrep_append_foreign_key(
 	int rcode = 0;
 	char cache_key[513] = {'\0'};
 	int cache_key_len;
-	bool const copy = true;
 	ut_a(trx);
 
 	if (!wsrep_on(trx->mysql_thd) ||
 	    wsrep_thd_exec_mode(thd) != LOCAL_STATE)
 		return DB_SUCCESS;
 
+	wsrep_ws_deps_add(thd, WSREP_DEPS_FK);
+
 	if (!thd || !foreign ||
 	    (!foreign->referenced_table && !foreign->foreign_table))
 	{
@@ -9397,10 +9439,13 @@ wsrep_append_foreign_key(
 
 	wsrep_buf_t wkey_part[3];
         wsrep_key_t wkey = {wkey_part, 3};
+	uchar	hashed_key[WSREP_HASHED_KEY_LEN];
+	ulint	key_len = len + 1;
+	const uchar* key_val = wsrep_hash_key(thd, key, &key_len, hashed_key);
 	if (!wsrep_prepare_key_for_innodb(
 		(const uchar*)cache_key,
 		cache_key_len +  1,
-		(const uchar*)key, len+1,
+		key_val, key_len,
 		wkey_part,
 		&wkey.key_parts_num)) {
 		WSREP_WARN("key prepare failed for cascaded FK: %s",
@@ -9408,13 +9453,9 @@ wsrep_append_foreign_key(
 			    wsrep_thd_query(thd) : "void");
 		return DB_ERROR;
 	}
-	rcode = wsrep->append_key(
-		wsrep,
-		wsrep_ws_handle(thd, trx),
-		&wkey,
-		1,
-		shared ? WSREP_KEY_SHARED : WSREP_KEY_EXCLUSIVE,
-		copy);
+	/* Assign the trx id to the write set before buffering the key */
+	wsrep_ws_handle_set_trx(thd, trx);
+	rcode = wsrep_append_row_key(thd, &wkey, shared);
 	if (rcode) {
 		DBUG_PRINT("wsrep", ("row key failed: %d", rcode));
 		WSREP_ERROR("Appending cascaded fk row key failed: %s, %d",
@@ -9438,7 +9479,6 @@ wsrep_append_key(
 )
 {
 	DBUG_ENTER("wsrep_append_key");
-	bool const copy = true;
 #ifdef WSREP_DEBUG_PRINT
 	fprintf(stderr, "%s conn %ld, trx %llu, keylen %d, table %s\n SQL: %s ",
 		(shared) ? "Shared" : "Exclusive",
@@ -9451,10 +9491,14 @@ wsrep_append_key(
 #endif
 	wsrep_buf_t wkey_part[3];
 	wsrep_key_t wkey = {wkey_part, 3};
+	uchar	hashed_key[WSREP_HASHED_KEY_LEN];
+	ulint	len = key_len;
+	const uchar* key_val = wsrep_hash_key(thd, (const uchar*)key, &len,
+					      hashed_key);
 	if (!wsrep_prepare_key_for_innodb(
 			(const uchar*)table_share->table_cache_key.str,
 			table_share->table_cache_key.length,
-			(const uchar*)key, key_len,
+			key_val, len,
 			wkey_part,
 			&wkey.key_parts_num)) {
 		WSREP_WARN("key prepare failed for: %s",
@@ -9463,13 +9507,9 @@ wsrep_append_key(
 		DBUG_RETURN(-1);
 	}
 
-	int rcode = wsrep->append_key(
-				wsrep,
-				wsrep_ws_handle(thd, trx),
-				&wkey,
-				1,
-				shared ? WSREP_KEY_SHARED : WSREP_KEY_EXCLUSIVE,
-				copy);
+	/* Assign the trx id to the write set before buffering the key */
+	wsrep_ws_handle_set_trx(thd, trx);
+	int rcode = wsrep_append_row_key(thd, &wkey, shared);
 	if (rcode) {
 		DBUG_PRINT("wsrep", ("row key failed: %d", rcode));
 		WSREP_WARN("Appending row key failed: %s, %d",
@@ -9524,6 +9564,15 @@ ha_innobase::wsrep_append_keys(
 		DBUG_RETURN(0);
 	}
 
+	if (!shared) {
+		/* for replication conflict statistics */
+		wsrep_conflict_stats_note(
+			thd, table_share,
+			(table_share->primary_key < MAX_KEY)
+			? table->key_info[table_share->primary_key].name
+			: "GEN_CLUST_INDEX");
+	}
+
 	if (wsrep_protocol_version == 0) {
 		uint	len;
 		char 	keyval[WSREP_MAX_SUPPORTED_KEY_LENGTH+1] = {'\0'};
@@ -9556,6 +9605,9 @@ ha_innobase::wsrep_append_keys(
 				hasPK = true;
 			}
 		}
+		if (!hasPK) {
+			wsrep_ws_deps_add(thd, WSREP_DEPS_NONPK);
+		}
 
 		for (i=0; i<table->s->keys; ++i) {
 			uint  len;
@@ -9643,6 +9695,21 @@ ha_innobase::wsrep_append_keys(
 		DBUG_RETURN(0);
 	}
 
+	/* without row keys, order the writeset after statement writesets
+	holding the table key; shared, so that concurrent row writes to
+	the table do not conflict with each other */
+	if (!key_appended && !shared && wsrep_pa_table_keys &&
+	    wsrep_protocol_version > 0) {
+		if (wsrep_append_table_key(thd, table_share->db.str,
+					   table_share->table_name.str,
+					   true)) {
+			WSREP_WARN("Appending table key failed: %s",
+				   (wsrep_thd_query(thd)) ?
+				   wsrep_thd_query(thd) : "void");
+			DBUG_RETURN(-1);
+		}
+	}
+
 	DBUG_RETURN(0);
 }
 #endif
@@ -17067,7 +17134,8 @@ wsrep_abort_slave_trx(wsrep_seqno_t bf_seqno, wsrep_seqno_t victim_seqno)
 int
 wsrep_innobase_kill_one_trx(void * const bf_thd_ptr,
                             const trx_t * const bf_trx,
-                            trx_t *victim_trx, ibool signal)
+                            trx_t *victim_trx, ibool signal,
+                            const dict_index_t* index)
 {
         ut_ad(lock_mutex_own());
         ut_ad(trx_mutex_own(victim_trx));
@@ -17129,6 +17197,12 @@ wsrep_innobase_kill_one_trx(void * const bf_thd_ptr,
 	switch (wsrep_thd_conflict_state(thd)) {
 	case NO_CONFLICT: 
 		wsrep_thd_set_conflict_state(thd, MUST_ABORT);
+		if (wsrep_thd_exec_mode(thd) != REPL_RECV) {
+			wsrep_conflict_stats_bf_abort(
+				thd,
+				index ? index->table_name : NULL,
+				index ? index->name : NULL);
+		}
 		break;
         case MUST_ABORT:
 		WSREP_DEBUG("victim %llu in MUST ABORT state",
@@ -17222,9 +17296,6 @@ wsrep_innobase_kill_one_trx(void * const bf_thd_ptr,
 		break;
 	case QUERY_IDLE:
 	{
-		bool skip_abort= false;
-		wsrep_aborting_thd_t abortees;
-
 		WSREP_DEBUG("kill IDLE for %llu", (long long)victim_trx->id);
 
 		if (wsrep_thd_exec_mode(thd) == REPL_RECV) {
@@ -17238,35 +17309,11 @@ wsrep_innobase_kill_one_trx(void * const bf_thd_ptr,
                 /* This will lock thd from proceeding after net_read() */
 		wsrep_thd_set_conflict_state(thd, ABORTING);
 
-		mysql_mutex_lock(&LOCK_wsrep_rollback);
-
-		abortees = wsrep_aborting_thd;
-		while (abortees && !skip_abort) {
-			/* check if we have a kill message for this already */
-			if (abortees->aborting_thd == thd) {
-				skip_abort = true;
-				WSREP_WARN("duplicate thd aborter %lu", 
-					  wsrep_thd_thread_id(thd));
-			}
-			abortees = abortees->next;
-		}
-		if (!skip_abort) {
-			wsrep_aborting_thd_t aborting = (wsrep_aborting_thd_t)
-				my_malloc(sizeof(struct wsrep_aborting_thd), 
-					  MYF(0));
-			aborting->aborting_thd  = thd;
-			aborting->next          = wsrep_aborting_thd;
-			wsrep_aborting_thd      = aborting;
- 			DBUG_PRINT("wsrep",("enqueuing trx abort for %lu",
-                                             wsrep_thd_thread_id(thd)));
-			WSREP_DEBUG("enqueuing trx abort for (%lu)",
-				    wsrep_thd_thread_id(thd));
-		}
-
+		/* ABORTING state above guarantees that victim is not
+		queued yet and will not be queued again before rollback */
 		DBUG_PRINT("wsrep",("signalling wsrep rollbacker"));
 		WSREP_DEBUG("signaling aborter");
-		mysql_cond_signal(&COND_wsrep_rollback);
-		mysql_mutex_unlock(&LOCK_wsrep_rollback);
+		wsrep_thd_enqueue_rollback(thd);
 
 		break;
 	}
@@ -17296,7 +17343,8 @@ wsrep_abort_transaction(handlerton* hton, THD *bf_thd, THD *victim_thd,
                 lock_mutex_enter();
                 trx_mutex_enter(victim_trx);
 		int rcode = wsrep_innobase_kill_one_trx(bf_thd, bf_trx,
-                                                        victim_trx, signal);
+                                                        victim_trx, signal,
+                                                        NULL);
                 trx_mutex_exit(victim_trx);
                 lock_mutex_exit();
 		wsrep_srv_conc_cancel_wait(victim_trx);
@@ -17316,12 +17364,16 @@ static int innobase_wsrep_set_checkpoint(handlerton* hton, const XID* xid)
 {
 	DBUG_ASSERT(hton == innodb_hton_ptr);
         if (wsrep_is_wsrep_xid(xid)) {
-                mtr_t mtr;
-                mtr_start(&mtr);
-                trx_sysf_t* sys_header = trx_sysf_get(&mtr);
-                trx_sys_update_wsrep_checkpoint(xid, sys_header, &mtr);
-                mtr_commit(&mtr);
-                innobase_flush_logs(hton);
+                /* InnoDB transactions stamp the XID in their commit
+                mini-transaction, this is for TOI and other commits which
+                InnoDB does not see. Nothing else makes those durable, so
+                flush regardless of innodb_flush_log_at_trx_commit, but
+                only up to our lsn so that concurrent commits share the
+                log flush. */
+                lsn_t lsn = trx_sys_set_wsrep_checkpoint(xid);
+                log_write_up_to(lsn, LOG_WAIT_ONE_GROUP,
+                                srv_unix_file_flush_method
+                                != SRV_UNIX_NOSYNC);
                 return 0;
         } else {
                 return 1;
@@ -17340,9 +17392,8 @@ wsrep_fake_trx_id(
 	handlerton	*hton,
 	THD		*thd)	/*!< in: user thread handle */
 {
-	mutex_enter(&trx_sys->mutex);
-	trx_id_t trx_id = trx_sys_get_new_trx_id();
-	mutex_exit(&trx_sys->mutex);
+	/* the id is not used for a transaction, no need for trx_sys->mutex */
+	trx_id_t trx_id = trx_sys_get_new_trx_id_nolock();
 	WSREP_DEBUG("innodb fake trx id: %lu thd: %s", trx_id, wsrep_thd_query(thd));
 	(void *)wsrep_ws_handle_for_trx(wsrep_thd_ws_handle(thd), trx_id);
 }
@@ -17449,6 +17500,14 @@ static MYSQL_SYSVAR_ULONG(purge_threads, srv_n_purge_threads,
   1,			/* Minimum value */
   32, 0);		/* Maximum value */
 
+static MYSQL_SYSVAR_ULONG(page_cleaners, srv_n_page_cleaners,
+  PLUGIN_VAR_OPCMDARG | PLUGIN_VAR_READONLY,
+  "Page cleaner threads can be from 1 to 64. Default is 1.",
+  NULL, NULL,
+  1,			/* Default setting */
+  1,			/* Minimum value */
+  64, 0);		/* Maximum value */
+
 static MYSQL_SYSVAR_ULONG(sync_array_size, srv_sync_array_size,
   PLUGIN_VAR_OPCMDARG | PLUGIN_VAR_READONLY,
   "Size of the mutex/lock wait array.",
@@ -17645,6 +17704,12 @@ static MYSQL_SYSVAR_BOOL(adaptive_hash_index, btr_search_enabled,
   "Disable with --skip-innodb-adaptive-hash-index.",
   NULL, innodb_adaptive_hash_index_update, TRUE);
 
+static MYSQL_SYSVAR_ULONG(adaptive_hash_index_parts, btr_search_n_parts,
+  PLUGIN_VAR_OPCMDARG | PLUGIN_VAR_READONLY,
+  "Number of InnoDB adaptive hash index partitions, each with its own "
+  "latch. Indexes are assigned to partitions by index id (8 by default).",
+  NULL, NULL, 8, 1, 512, 0);
+
 static MYSQL_SYSVAR_ULONG(replication_delay, srv_replication_delay,
   PLUGIN_VAR_RQCMDARG,
   "Replication thread delay (ms) on the slave server if "
@@ -17824,6 +17889,32 @@ static MYSQL_SYSVAR_ULONG(sort_buffer_size, srv_sort_buf_size,
   "Memory buffer size for index creation",
   NULL, NULL, 1048576, 65536, 64<<20, 0);
 
+static MYSQL_SYSVAR_ULONG(sort_merge_fan_in, srv_sort_merge_fan_in,
+  PLUGIN_VAR_RQCMDARG,
+  "Number of sorted runs merged in one pass of index creation. Each run"
+  " takes a buffer of innodb_sort_buffer_size.",
+  NULL, NULL, 8, 2, 64, 0);
+
+static MYSQL_SYSVAR_ULONG(sort_memory_limit, srv_sort_memory_limit,
+  PLUGIN_VAR_RQCMDARG,
+  "Maximum memory for the additional sort buffers of an index creation."
+  " Limits the number of runs merged in one pass below"
+  " innodb_sort_merge_fan_in if needed.",
+  NULL, NULL, 128 << 20, 1 << 20, ULONG_MAX, 0);
+
+static MYSQL_SYSVAR_ULONG(sort_scan_threads, srv_sort_scan_threads,
+  PLUGIN_VAR_RQCMDARG,
+  "Maximum number of threads reading the clustered index when indexes are"
+  " created with LOCK=SHARED or LOCK=EXCLUSIVE. Each thread takes a sort"
+  " buffer for each index plus one, within innodb_sort_memory_limit.",
+  NULL, NULL, 4, 1, 64, 0);
+
+static MYSQL_SYSVAR_ULONG(fill_factor, btr_bulk_fill_factor,
+  PLUGIN_VAR_RQCMDARG,
+  "Percentage of each index page to fill when an index is built from"
+  " sorted records by ALTER TABLE or CREATE INDEX.",
+  NULL, NULL, 100, 10, 100, 0);
+
 static MYSQL_SYSVAR_ULONGLONG(online_alter_log_max_size, srv_online_max_size,
   PLUGIN_VAR_RQCMDARG,
   "Maximum modification log file size for online index creation",
@@ -18105,6 +18196,41 @@ static MYSQL_SYSVAR_BOOL(disallow_writes, innobase_disallow_writes,
   PLUGIN_VAR_NOCMDOPT,
   "Tell InnoDB to stop any writes to disk",
   NULL, innobase_disallow_writes_update, FALSE);
+
+/**************************************************************************
+An "update" method for innodb_snapshot variable. */
+static
+void
+innobase_snapshot_update(
+/*=====================*/
+	THD*			thd,		/* in: thread handle */
+	st_mysql_sys_var*	var,		/* in: pointer to system
+						variable */
+	void*			var_ptr,	/* out: pointer to dynamic
+						variable */
+	const void*		save)		/* in: temporary storage */
+{
+	if (*(my_bool*) save && !srv_read_only_mode) {
+		/* The snapshot must include all committed transactions */
+		log_buffer_flush_to_disk();
+		*(my_bool*) var_ptr = fil_snapshot_begin() == DB_SUCCESS;
+	} else {
+		fil_snapshot_end();
+		*(my_bool*) var_ptr = FALSE;
+	}
+}
+
+static MYSQL_SYSVAR_BOOL(snapshot, srv_snapshot,
+  PLUGIN_VAR_NOCMDOPT,
+  "Save pages before they are overwritten, so that data and log files"
+  " can be copied consistently while InnoDB keeps writing",
+  NULL, innobase_snapshot_update, FALSE);
+
+static MYSQL_SYSVAR_ULONG(snapshot_timeout, srv_snapshot_timeout,
+  PLUGIN_VAR_RQCMDARG,
+  "Seconds after which an active innodb_snapshot is ended as failed, so"
+  " that tablespace DDL does not wait for it forever",
+  NULL, NULL, 86400, 1, ULONG_MAX, 0);
 #endif /* WITH_INNODB_DISALLOW_WRITES */
 static MYSQL_SYSVAR_BOOL(random_read_ahead, srv_random_read_ahead,
   PLUGIN_VAR_NOCMDARG,
@@ -18300,12 +18426,17 @@ static struct st_mysql_sys_var* innobase_system_variables[]= {
   MYSQL_SYSVAR(stats_persistent_sample_pages),
   MYSQL_SYSVAR(stats_auto_recalc),
   MYSQL_SYSVAR(adaptive_hash_index),
+  MYSQL_SYSVAR(adaptive_hash_index_parts),
   MYSQL_SYSVAR(stats_method),
   MYSQL_SYSVAR(replication_delay),
   MYSQL_SYSVAR(status_file),
   MYSQL_SYSVAR(strict_mode),
   MYSQL_SYSVAR(support_xa),
   MYSQL_SYSVAR(sort_buffer_size),
+  MYSQL_SYSVAR(sort_merge_fan_in),
+  MYSQL_SYSVAR(sort_memory_limit),
+  MYSQL_SYSVAR(sort_scan_threads),
+  MYSQL_SYSVAR(fill_factor),
   MYSQL_SYSVAR(online_alter_log_max_size),
   MYSQL_SYSVAR(sync_spin_loops),
   MYSQL_SYSVAR(spin_wait_delay),
@@ -18330,6 +18461,8 @@ static struct st_mysql_sys_var* innobase_system_variables[]= {
 #endif /* UNIV_DEBUG || UNIV_IBUF_DEBUG */
 #ifdef WITH_INNODB_DISALLOW_WRITES
   MYSQL_SYSVAR(disallow_writes),
+  MYSQL_SYSVAR(snapshot),
+  MYSQL_SYSVAR(snapshot_timeout),
 #endif /* WITH_INNODB_DISALLOW_WRITES */
   MYSQL_SYSVAR(random_read_ahead),
   MYSQL_SYSVAR(read_ahead_threshold),
@@ -18341,6 +18474,7 @@ static struct st_mysql_sys_var* innobase_system_variables[]= {
   MYSQL_SYSVAR(monitor_reset),
   MYSQL_SYSVAR(monitor_reset_all),
   MYSQL_SYSVAR(purge_threads),
+  MYSQL_SYSVAR(page_cleaners),
   MYSQL_SYSVAR(purge_batch_size),
 #ifdef UNIV_DEBUG
   MYSQL_SYSVAR(purge_run_now),
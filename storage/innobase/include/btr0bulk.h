@@ -0,0 +1,83 @@
+/*****************************************************************************
+
+Copyright (C) 2017 Codership Oy <info@codership.com>
+
+This program is free software; you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation; version 2 of the License.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Suite 500, Boston, MA 02110-1335 USA
+
+*****************************************************************************/
+
+/**************************************************//**
+@file include/btr0bulk.h
+Bottom-up construction of an index tree from sorted records
+
+The leaf pages are filled from left to right, and a node pointer is
+added to the level above whenever a page is completed.  The records
+are copied to the leaf page without redo logging; each completed leaf
+page is written to the redo log in one piece.  The node pointers are
+inserted and logged one at a time, so that only the leaf page that is
+being filled stays latched.
+*******************************************************/
+
+#ifndef btr0bulk_h
+#define btr0bulk_h
+
+#include "univ.i"
+#include "db0err.h"
+#include "data0types.h"
+#include "dict0types.h"
+#include "trx0types.h"
+
+/** Percentage of each index page to fill in btr_bulk_insert() */
+extern ulong	btr_bulk_fill_factor;
+
+/** Bulk loader of an index tree */
+struct btr_bulk_t;
+
+/*********************************************************************//**
+Start loading an empty index tree in ascending key order.  Compressed
+tables are not supported.
+@return bulk loader, or NULL if the index cannot be bulk loaded */
+UNIV_INTERN
+btr_bulk_t*
+btr_bulk_create(
+/*============*/
+	dict_index_t*	index,	/*!< in/out: index whose tree is empty */
+	trx_id_t	trx_id)	/*!< in: PAGE_MAX_TRX_ID of secondary
+				index leaf pages */
+	MY_ATTRIBUTE((nonnull, warn_unused_result));
+/*********************************************************************//**
+Append an index entry to the tree.  The entries must be passed in
+ascending order.
+@return DB_SUCCESS or error code */
+UNIV_INTERN
+dberr_t
+btr_bulk_insert(
+/*============*/
+	btr_bulk_t*	bulk,	/*!< in/out: bulk loader */
+	dtuple_t*	entry)	/*!< in/out: index entry without
+				externally stored columns */
+	MY_ATTRIBUTE((nonnull, warn_unused_result));
+/*********************************************************************//**
+Complete the node pointer levels, write the last pages to the redo log
+and free the bulk loader.  If err is not DB_SUCCESS, the tree is left
+incomplete; it can only be freed.
+@return DB_SUCCESS or error code */
+UNIV_INTERN
+dberr_t
+btr_bulk_finish(
+/*============*/
+	btr_bulk_t*	bulk,	/*!< in, own: bulk loader */
+	dberr_t		err)	/*!< in: error from btr_bulk_insert() */
+	MY_ATTRIBUTE((nonnull, warn_unused_result));
+
+#endif /* btr0bulk_h */
@@ -61,6 +61,61 @@ void
 btr_search_enable(void);
 /*====================*/
 
+/********************************************************************//**
+Returns the adaptive hash index partition of an index.
+@return partition number, less than btr_search_n_parts */
+UNIV_INLINE
+ulint
+btr_search_get_part(
+/*================*/
+	index_id_t	index_id);	/*!< in: index id */
+/********************************************************************//**
+Returns the latch of the adaptive hash index partition of an index.
+@return latch protecting the hash index entries of the index */
+UNIV_INLINE
+rw_lock_t*
+btr_search_get_latch(
+/*=================*/
+	const dict_index_t*	index);	/*!< in: index */
+/********************************************************************//**
+Returns the hash table of the adaptive hash index partition of an index.
+@return hash table holding the hash index entries of the index */
+UNIV_INLINE
+hash_table_t*
+btr_search_get_hash_table(
+/*======================*/
+	const dict_index_t*	index);	/*!< in: index */
+/********************************************************************//**
+X-latches all adaptive hash index partitions. */
+UNIV_INTERN
+void
+btr_search_x_lock_all(void);
+/*=======================*/
+/********************************************************************//**
+Releases the x-latches on all adaptive hash index partitions. */
+UNIV_INTERN
+void
+btr_search_x_unlock_all(void);
+/*=========================*/
+#ifdef UNIV_SYNC_DEBUG
+/********************************************************************//**
+Checks if the thread owns all adaptive hash index partition latches.
+@return TRUE if all are owned in the mode */
+UNIV_INTERN
+ibool
+btr_search_own_all(
+/*===============*/
+	ulint	lock_type);	/*!< in: RW_LOCK_SHARED or RW_LOCK_EX */
+/********************************************************************//**
+Checks if the thread owns any adaptive hash index partition latch.
+@return TRUE if some latch is owned in the mode */
+UNIV_INTERN
+ibool
+btr_search_own_any(
+/*===============*/
+	ulint	lock_type);	/*!< in: RW_LOCK_SHARED or RW_LOCK_EX */
+#endif /* UNIV_SYNC_DEBUG */
+
 /********************************************************************//**
 Returns search info for an index.
 @return	search info; search mutex reserved */
@@ -79,14 +134,15 @@ btr_search_info_create(
 /*===================*/
 	mem_heap_t*	heap);	/*!< in: heap where created */
 /*****************************************************************//**
-Returns the value of ref_count. The value is protected by
-btr_search_latch.
+Returns the value of ref_count. The value is protected by the
+adaptive hash index partition latch of the index.
 @return	ref_count value. */
 UNIV_INTERN
 ulint
 btr_search_info_get_ref_count(
 /*==========================*/
-	btr_search_t*   info);	/*!< in: search info. */
+	btr_search_t*   info,	/*!< in: search info. */
+	dict_index_t*	index);	/*!< in: index */
 /*********************************************************************//**
 Updates the search info. */
 UNIV_INLINE
@@ -112,7 +168,8 @@ btr_search_guess_on_hash(
 	ulint		latch_mode,	/*!< in: BTR_SEARCH_LEAF, ... */
 	btr_cur_t*	cursor,		/*!< out: tree cursor */
 	ulint		has_search_latch,/*!< in: latch mode the caller
-					currently has on btr_search_latch:
+					currently has on the latch of the
+					hash index partition of index:
 					RW_S_LATCH, RW_X_LATCH, or 0 */
 	mtr_t*		mtr);		/*!< in: mtr */
 /********************************************************************//**
@@ -196,9 +253,9 @@ struct btr_search_t{
 	ulint	ref_count;	/*!< Number of blocks in this index tree
 				that have search index built
 				i.e. block->index points to this index.
-				Protected by btr_search_latch except
-				when during initialization in
-				btr_search_info_create(). */
+				Protected by the partition latch of the
+				index except when during initialization
+				in btr_search_info_create(). */
 
 	/* @{ The following fields are not protected by any latch.
 	Unfortunately, this means that they must be aligned to
@@ -248,9 +305,11 @@ struct btr_search_t{
 
 /** The hash index system */
 struct btr_search_sys_t{
-	hash_table_t*	hash_index;	/*!< the adaptive hash index,
+	hash_table_t**	hash_tables;	/*!< the adaptive hash index,
+					btr_search_n_parts hash tables
 					mapping dtuple_fold values
-					to rec_t pointers on index pages */
+					to rec_t pointers on index pages,
+					see btr_search_get_hash_table() */
 };
 
 /** The adaptive hash index */
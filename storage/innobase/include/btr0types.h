@@ -41,10 +41,11 @@ struct btr_search_t;
 
 #ifndef UNIV_HOTBACKUP
 
-/** @brief The latch protecting the adaptive search system
+/** @brief The latches protecting the adaptive search system
 
-This latch protects the
-(1) hash index;
+The adaptive hash index is partitioned by index id, see
+btr_search_get_latch(). The latch of a partition protects the
+(1) hash index of the partition;
 (2) columns of a record to which we have a pointer in the hash index;
 
 but does NOT protect:
@@ -54,15 +55,15 @@ but does NOT protect:
 
 Bear in mind (3) and (4) when using the hash index.
 */
-extern rw_lock_t*	btr_search_latch_temp;
+extern rw_lock_t**	btr_search_latches;
 
 #endif /* UNIV_HOTBACKUP */
 
-/** The latch protecting the adaptive search system */
-#define btr_search_latch	(*btr_search_latch_temp)
+/** Number of adaptive hash index partitions */
+extern ulong	btr_search_n_parts;
 
 /** Flag: has the search system been enabled?
-Protected by btr_search_latch. */
+Protected by all btr_search_latches. */
 extern char	btr_search_enabled;
 
 #ifdef UNIV_BLOB_DEBUG
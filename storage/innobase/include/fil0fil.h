@@ -331,6 +331,59 @@ UNIV_INTERN
 void
 fil_close(void);
 /*===========*/
+#ifdef WITH_INNODB_DISALLOW_WRITES
+/********************************************************************//**
+Begins a snapshot for state transfer: until fil_snapshot_end(), the
+original contents of pages are saved before they are overwritten. The
+caller must make sure that the log is written up to the changes that the
+snapshot must include.
+@return DB_SUCCESS or error code */
+UNIV_INTERN
+dberr_t
+fil_snapshot_begin(void);
+/*====================*/
+/********************************************************************//**
+Ends the snapshot and leaves the saved pages in ib_snapshot.done in the data
+directory, for the state transfer to copy as ib_snapshot. */
+UNIV_INTERN
+void
+fil_snapshot_end(void);
+/*==================*/
+/********************************************************************//**
+Ends the snapshot as failed if it has been active for too long, so that a
+snapshot left active does not keep tablespace DDL waiting forever.
+@return TRUE if the snapshot was ended */
+UNIV_INTERN
+ibool
+fil_snapshot_end_if_expired(
+/*========================*/
+	ulint	timeout);	/*!< in: seconds */
+/********************************************************************//**
+Waits until no snapshot is active. Tablespace files must not be created,
+deleted or renamed while a snapshot is active. The caller must not hold
+dictionary locks. */
+UNIV_INTERN
+void
+fil_snapshot_wait(void);
+/*===================*/
+/********************************************************************//**
+Checks if a snapshot is active. A snapshot does not begin while
+dict_operation_lock is x-locked.
+@return TRUE if a snapshot is active */
+UNIV_INTERN
+ibool
+fil_snapshot_is_active(void);
+/*========================*/
+/********************************************************************//**
+Writes the pages saved by a snapshot on another node back over the data and
+log files copied from there, if ib_snapshot exists. Called at startup
+before the files are opened.
+@return DB_SUCCESS or error code */
+UNIV_INTERN
+dberr_t
+fil_snapshot_apply(void);
+/*====================*/
+#endif /* WITH_INNODB_DISALLOW_WRITES */
 /*******************************************************************//**
 Opens all log files and system tablespace data files. They stay open until the
 database server shutdown. This should be called at a server startup after the
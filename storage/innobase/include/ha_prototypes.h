@@ -35,6 +35,7 @@ Created 5/11/2006 Osku Salerma
 #include "debug_sync.h"
 
 #include "trx0types.h"
+#include "dict0types.h"
 #include "m_ctype.h" /* CHARSET_INFO */
 
 // Forward declarations
@@ -277,7 +278,8 @@ innobase_casedn_str(
 UNIV_INTERN
 int
 wsrep_innobase_kill_one_trx(void *thd_ptr,
-                            const trx_t *bf_trx, trx_t *victim_trx, ibool signal);
+                            const trx_t *bf_trx, trx_t *victim_trx, ibool signal,
+                            const dict_index_t* index);
 my_bool wsrep_thd_set_PA_safe(void *thd_ptr, my_bool safe);
 int wsrep_thd_conflict_state(void *thd_ptr, my_bool sync);
 my_bool wsrep_thd_is_BF(void *thd_ptr, my_bool sync);
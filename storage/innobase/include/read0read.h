@@ -47,6 +47,16 @@ read_view_open_now(
 	mem_heap_t*	heap);		/*!< in: memory heap from which
 					allocated */
 /*********************************************************************//**
+Opens a read view for a MySQL transaction. Reopens the view that the
+transaction closed last if no read-write transaction has ended since it
+was built, instead of building a new one.
+@return	own: read view struct */
+UNIV_INTERN
+read_view_t*
+read_view_open_for_mysql(
+/*=====================*/
+	trx_t*		trx);		/*!< in/out: transaction */
+/*********************************************************************//**
 Makes a copy of the oldest existing read view, or opens a new. The view
 must be closed with ..._close.
 @return	own: read view struct */
@@ -156,6 +166,9 @@ struct read_view_t{
 	trx_id_t	creator_trx_id;
 				/*!< trx id of creating transaction, or
 				0 used in purge */
+	ib_uint64_t	rw_trx_n_ended;
+				/*!< trx_sys->rw_trx_n_ended when the
+				view was built */
 	UT_LIST_NODE_T(read_view_t) view_list;
 				/*!< List of read views in trx_sys */
 };
@@ -182,6 +182,10 @@ enum monitor_id_t {
 	MONITOR_FLUSH_PCT_FOR_DIRTY,
 	MONITOR_FLUSH_PCT_FOR_LSN,
 	MONITOR_FLUSH_SYNC_WAITS,
+	MONITOR_FLUSH_AVG_TIME_THREAD,
+	MONITOR_FLUSH_MAX_TIME_THREAD,
+	MONITOR_LRU_BATCH_FLUSH_AVG_TIME_THREAD,
+	MONITOR_LRU_BATCH_FLUSH_MAX_TIME_THREAD,
 	MONITOR_FLUSH_ADAPTIVE_TOTAL_PAGE,
 	MONITOR_FLUSH_ADAPTIVE_COUNT,
 	MONITOR_FLUSH_ADAPTIVE_PAGES,
@@ -266,6 +270,7 @@ enum monitor_id_t {
 	MONITOR_TRX_ROLLBACK_SAVEPOINT,
 	MONITOR_TRX_ROLLBACK_ACTIVE,
 	MONITOR_TRX_ACTIVE,
+	MONITOR_TRX_ID_NOMUTEX,
 	MONITOR_RSEG_HISTORY_LEN,
 	MONITOR_NUM_UNDO_SLOT_USED,
 	MONITOR_NUM_UNDO_SLOT_CACHED,
@@ -212,6 +212,14 @@ extern ibool	srv_locks_unsafe_for_binlog;
 
 /** Sort buffer size in index creation */
 extern ulong	srv_sort_buf_size;
+/** Number of runs merged in one pass of the index creation merge sort */
+extern ulong	srv_sort_merge_fan_in;
+/** Memory for the sort buffers of an index creation beyond the three
+it always uses */
+extern ulong	srv_sort_memory_limit;
+/** Maximum number of threads scanning the clustered index in an index
+creation that is not online */
+extern ulong	srv_sort_scan_threads;
 /** Maximum modification log file size for online index creation */
 extern unsigned long long	srv_online_max_size;
 
@@ -264,6 +272,10 @@ extern char	srv_adaptive_flushing;
 #ifdef WITH_INNODB_DISALLOW_WRITES
 /* When this event is reset we do not allow any file writes to take place. */
 extern os_event_t	srv_allow_writes_event;
+/* TRUE while a snapshot for state transfer is active, innodb_snapshot */
+extern my_bool		srv_snapshot;
+/* Seconds after which the master thread ends an active snapshot */
+extern ulong		srv_snapshot_timeout;
 #endif /* WITH_INNODB_DISALLOW_WRITES */
 /* If this flag is TRUE, then we will load the indexes' (and tables') metadata
 even if they are marked as "corrupted". Mostly it is for DBA to process
@@ -439,6 +451,9 @@ extern ulong srv_n_purge_threads;
 /* the number of pages to purge in one batch */
 extern ulong srv_purge_batch_size;
 
+/* the number of page_cleaner threads, including the coordinator */
+extern ulong srv_n_page_cleaners;
+
 /* the number of sync wait arrays */
 extern ulong srv_sync_array_size;
 
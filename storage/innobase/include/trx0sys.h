@@ -179,6 +179,14 @@ trx_id_t
 trx_sys_get_new_trx_id(void);
 /*========================*/
 /*****************************************************************//**
+Allocates a transaction id which is not assigned to a transaction in
+trx_sys->rw_trx_list, without acquiring trx_sys->mutex.
+@return	new, allocated trx id */
+UNIV_INTERN
+trx_id_t
+trx_sys_get_new_trx_id_nolock(void);
+/*===============================*/
+/*****************************************************************//**
 Determines the maximum transaction id.
 @return maximum currently allocated trx id; will be stale after the
 next call to trx_sys_get_new_trx_id() */
@@ -315,6 +323,13 @@ trx_sys_update_wsrep_checkpoint(
         trx_sysf_t*     sys_header,  /*!< in: sys_header */
         mtr_t*          mtr);        /*!< in: mtr       */
 
+/** Write WSREP checkpoint XID to sys header in a mini-transaction of its
+own, for commits which do not go through the InnoDB transaction commit.
+@return end lsn of the mini-transaction */
+lsn_t
+trx_sys_set_wsrep_checkpoint(
+        const XID*      xid);        /*!< in: WSREP XID */
+
 void
 /** Read WSREP checkpoint XID from sys header. */
 trx_sys_read_wsrep_checkpoint(
@@ -692,6 +707,10 @@ struct trx_sys_t{
 	UT_LIST_BASE_NODE_T(read_view_t) view_list;
 					/*!< List of read views sorted
 					on trx no, biggest first */
+	ib_uint64_t	rw_trx_n_ended;	/*!< Number of transactions removed
+					from rw_trx_list. A read view built
+					when this had the same value is still
+					current, see read_view_open_for_mysql() */
 };
 
 /** When a trx id which is zero modulo this number (which must be a power of
@@ -1679,7 +1679,9 @@ wsrep_kill_victim(const trx_t * const trx, const lock_t *lock) {
 				}
 			}
 			wsrep_innobase_kill_one_trx(trx->mysql_thd,
-				(const trx_t*) trx, lock->trx, TRUE);
+				(const trx_t*) trx, lock->trx, TRUE,
+				lock_get_type_low(lock) == LOCK_REC
+				? lock->index : NULL);
 		}
 	}
 }
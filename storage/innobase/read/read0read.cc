@@ -343,6 +343,7 @@ read_view_open_now_low(
 	view->undo_no = 0;
 	view->type = VIEW_NORMAL;
 	view->creator_trx_id = cr_trx_id;
+	view->rw_trx_n_ended = trx_sys->rw_trx_n_ended;
 
 	/* No future transactions should be visible in the view */
 
@@ -392,6 +393,58 @@ read_view_open_now(
 	return(view);
 }
 
+/*********************************************************************//**
+Opens a read view for a MySQL transaction. Reopens the view that the
+transaction closed last if no read-write transaction has ended since it
+was built, instead of building a new one.
+
+Such a view is still exact: every transaction it does not see is either
+still active, or started after the view, or ended without becoming
+visible, because the end of any read-write transaction increments
+trx_sys->rw_trx_n_ended. Purge may have advanced while the view was
+closed, but only up to a view that was equivalent to it.
+@return	own: read view struct */
+UNIV_INTERN
+read_view_t*
+read_view_open_for_mysql(
+/*=====================*/
+	trx_t*		trx)		/*!< in/out: transaction */
+{
+	read_view_t*	view = trx->closed_read_view;
+
+	ut_ad(trx->global_read_view == NULL);
+
+	trx->closed_read_view = NULL;
+
+	mutex_enter(&trx_sys->mutex);
+
+	/* A read-only transaction has no changes of its own that the
+	view would have to see, so it can take a view built for another
+	transaction. */
+
+	if (view != NULL
+	    && view->rw_trx_n_ended == trx_sys->rw_trx_n_ended
+	    && (trx->read_only || view->creator_trx_id == trx->id)) {
+
+		view->creator_trx_id = trx->id;
+		read_view_add(view);
+	} else {
+		if (view != NULL) {
+			mem_heap_empty(trx->global_read_view_heap);
+		}
+
+		view = read_view_open_now_low(
+			trx->id, trx->global_read_view_heap);
+	}
+
+	mutex_exit(&trx_sys->mutex);
+
+	trx->read_view = view;
+	trx->global_read_view = view;
+
+	return(view);
+}
+
 /*********************************************************************//**
 Makes a copy of the oldest existing read view, with the exception that also
 the creating trx of the oldest view is set as not visible in the 'copied'
@@ -489,7 +542,10 @@ read_view_close_for_mysql(
 
 	read_view_remove(trx->global_read_view, false);
 
-	mem_heap_empty(trx->global_read_view_heap);
+	/* Keep the view in global_read_view_heap, so that the next
+	statement can reopen it. */
+
+	trx->closed_read_view = trx->global_read_view;
 
 	trx->read_view = NULL;
 	trx->global_read_view = NULL;
@@ -575,6 +631,7 @@ read_cursor_view_create_for_mysql(
 	view->undo_no = cr_trx->undo_no;
 	view->type = VIEW_HIGH_GRANULARITY;
 	view->creator_trx_id = UINT64_UNDEFINED;
+	view->rw_trx_n_ended = trx_sys->rw_trx_n_ended;
 
 	/* No future transactions should be visible in the view */
 
@@ -25,6 +25,7 @@ Completed by Sunny Bains and Marko Makela
 *******************************************************/
 
 #include "row0merge.h"
+#include "btr0bulk.h"
 #include "row0ext.h"
 #include "row0log.h"
 #include "row0ins.h"
@@ -51,7 +52,7 @@ Completed by Sunny Bains and Marko Makela
 static ibool	row_merge_print_read;
 /** Log each record write to temporary file. */
 static ibool	row_merge_print_write;
-/** Log each row_merge_blocks() call, merging two blocks of records to
+/** Log each row_merge_runs() call, merging runs of records to
 a bigger one. */
 static ibool	row_merge_print_block;
 /** Log each block read from temporary file. */
@@ -634,8 +635,12 @@ row_merge_dup_report(
 {
 	if (!dup->n_dup++) {
 		/* Only report the first duplicate record,
-		but count all duplicate records. */
-		innobase_fields_to_mysql(dup->table, dup->index, entry);
+		but count all duplicate records.  A parallel scan
+		copies the record later, when no other thread can. */
+		if (dup->table != NULL) {
+			innobase_fields_to_mysql(
+				dup->table, dup->index, entry);
+		}
 	}
 }
 
@@ -808,31 +813,36 @@ row_merge_buf_write(
 
 /******************************************************//**
 Create a memory heap and allocate space for row_merge_rec_offsets()
-and mrec_buf_t[3].
+and mrec_buf_t[n + 1].
 @return	memory heap */
 static
 mem_heap_t*
 row_merge_heap_create(
 /*==================*/
 	const dict_index_t*	index,		/*!< in: record descriptor */
-	mrec_buf_t**		buf,		/*!< out: 3 buffers */
-	ulint**			offsets1,	/*!< out: offsets */
-	ulint**			offsets2)	/*!< out: offsets */
+	ulint			n,		/*!< in: number of input runs */
+	mrec_buf_t**		buf,		/*!< out: n + 1 buffers */
+	ulint***		offsets)	/*!< out: n offsets */
 {
 	ulint		i	= 1 + REC_OFFS_HEADER_SIZE
 		+ dict_index_get_n_fields(index);
-	mem_heap_t*	heap	= mem_heap_create(2 * i * sizeof **offsets1
-						  + 3 * sizeof **buf);
+	mem_heap_t*	heap	= mem_heap_create(
+		n * (i * sizeof ***offsets + sizeof **offsets)
+		+ (n + 1) * sizeof **buf);
 
 	*buf = static_cast<mrec_buf_t*>(
-		mem_heap_alloc(heap, 3 * sizeof **buf));
-	*offsets1 = static_cast<ulint*>(
-		mem_heap_alloc(heap, i * sizeof **offsets1));
-	*offsets2 = static_cast<ulint*>(
-		mem_heap_alloc(heap, i * sizeof **offsets2));
+		mem_heap_alloc(heap, (n + 1) * sizeof **buf));
+	*offsets = static_cast<ulint**>(
+		mem_heap_alloc(heap, n * sizeof **offsets));
+
+	for (ulint j = 0; j < n; j++) {
+		ulint*	offs = static_cast<ulint*>(
+			mem_heap_alloc(heap, i * sizeof ***offsets));
 
-	(*offsets1)[0] = (*offsets2)[0] = i;
-	(*offsets1)[1] = (*offsets2)[1] = dict_index_get_n_fields(index);
+		offs[0] = i;
+		offs[1] = dict_index_get_n_fields(index);
+		(*offsets)[j] = offs;
+	}
 
 	return(heap);
 }
@@ -1286,6 +1296,651 @@ row_merge_file_create_if_needed(
 	return(file->fd);
 }
 
+/** Identify the columns that were flagged NOT NULL in the new table
+when a table is rebuilt, so that we can quickly check that the records
+in the old table do not violate the added NOT NULL constraints.
+@param[in]	old_table	table where rows are read from
+@param[in]	new_table	table being created
+@param[in]	col_map		mapping of old column numbers to new ones
+@param[out]	n_nonnull	number of columns changed to NOT NULL
+@return	columns changed to NOT NULL, to be freed with mem_free(),
+or NULL if none */
+static MY_ATTRIBUTE((nonnull, warn_unused_result))
+ulint*
+row_merge_get_nonnull(
+	const dict_table_t*	old_table,
+	const dict_table_t*	new_table,
+	const ulint*		col_map,
+	ulint*			n_nonnull)
+{
+	ulint*	nonnull = static_cast<ulint*>(
+		mem_alloc(dict_table_get_n_cols(new_table)
+			  * sizeof *nonnull));
+
+	*n_nonnull = 0;
+
+	for (ulint i = 0; i < dict_table_get_n_cols(old_table); i++) {
+		if (dict_table_get_nth_col(old_table, i)->prtype
+		    & DATA_NOT_NULL) {
+			continue;
+		}
+
+		const ulint j = col_map[i];
+
+		if (j == ULINT_UNDEFINED) {
+			/* The column was dropped. */
+			continue;
+		}
+
+		if (dict_table_get_nth_col(new_table, j)->prtype
+		    & DATA_NOT_NULL) {
+			nonnull[(*n_nonnull)++] = j;
+		}
+	}
+
+	if (!*n_nonnull) {
+		mem_free(nonnull);
+		nonnull = NULL;
+	}
+
+	return(nonnull);
+}
+
+/* Parallel scan of the clustered index.
+
+When the indexes are not created online, no AUTO_INCREMENT column is added
+and no FULLTEXT index is created, the clustered index is split into key
+ranges at the node pointers of its root page, and each range is scanned by
+a thread of its own.  A thread sorts the records of each index in its own
+buffers and appends them to the shared temporary file of the index as runs
+of one block, which row_merge_sort() then merges like those of a serial
+scan. */
+
+/** State shared by the threads of a parallel scan */
+struct row_merge_scan_ctx_t {
+	trx_t*			trx;		/*!< transaction */
+	struct TABLE*		table;		/*!< MySQL table, for reporting
+						a duplicate key */
+	const dict_table_t*	old_table;	/*!< table where rows are
+						read from */
+	const dict_table_t*	new_table;	/*!< table where indexes are
+						created */
+	dict_index_t**		index;		/*!< indexes to be created */
+	merge_file_t*		files;		/*!< temporary files */
+	const ulint*		key_numbers;	/*!< MySQL key numbers */
+	ulint			n_index;	/*!< number of indexes */
+	const dtuple_t*		add_cols;	/*!< default values of added
+						columns, or NULL */
+	const ulint*		col_map;	/*!< column mapping, or NULL */
+	const ulint*		nonnull;	/*!< columns changed to
+						NOT NULL, or NULL */
+	ulint			n_nonnull;	/*!< number of nonnull[] */
+	const char*		path;		/*!< temporary file directory */
+	int*			tmpfd;		/*!< temporary file handle */
+	ib_mutex_t		mutex;		/*!< protects files, tmpfd,
+						table and the fields below */
+	dberr_t			error;		/*!< first error of a thread */
+	ulint			error_key_num;	/*!< trx->error_key_num for
+						error, or ULINT_UNDEFINED */
+};
+
+/** Key range of the clustered index scanned by one thread */
+struct row_merge_scan_t {
+	row_merge_scan_ctx_t*	ctx;		/*!< shared state */
+	const dtuple_t*		start;		/*!< first key of the range,
+						or NULL for the start of
+						the index */
+	const dtuple_t*		end;		/*!< first key after the
+						range, or NULL for the end
+						of the index */
+	os_thread_t		thread_hdl;	/*!< thread handle */
+};
+
+#ifdef UNIV_PFS_MUTEX
+/* Key to register the parallel scan mutex with performance schema */
+UNIV_INTERN mysql_pfs_key_t	row_merge_scan_mutex_key;
+#endif /* UNIV_PFS_MUTEX */
+
+/** Record the error of a thread of a parallel scan, unless another thread
+failed already.  The other threads stop at their next page.
+@param[in,out]	ctx	parallel scan
+@param[in]	err	error code
+@param[in]	key_num	trx->error_key_num, or ULINT_UNDEFINED
+@param[in]	buf	sorted buffer with a duplicate if
+			err == DB_DUPLICATE_KEY, else NULL */
+static
+void
+row_merge_scan_set_error(
+	row_merge_scan_ctx_t*	ctx,
+	dberr_t			err,
+	ulint			key_num,
+	row_merge_buf_t*	buf)
+{
+	mutex_enter(&ctx->mutex);
+
+	if (ctx->error == DB_SUCCESS) {
+		ctx->error = err;
+		ctx->error_key_num = key_num;
+
+		if (buf != NULL) {
+			/* Sort the buffer again to copy the duplicate
+			to the MySQL record, which all threads share.
+			Equal neighbours of a sorted buffer are always
+			compared. */
+			row_merge_dup_t	dup = {
+				buf->index, ctx->table, ctx->col_map, 0};
+
+			row_merge_buf_sort(buf, &dup);
+			ut_ad(dup.n_dup);
+		}
+	}
+
+	mutex_exit(&ctx->mutex);
+}
+
+/** Sort a buffer of a parallel scan and append it to the temporary file
+of its index as a run of one block, and empty the buffer.
+@param[in,out]	ctx	parallel scan
+@param[in]	i	index number
+@param[in,out]	merge_buf	buffer of index i, not empty
+@param[in,out]	block	file buffer
+@return	DB_SUCCESS or error code */
+static MY_ATTRIBUTE((nonnull, warn_unused_result))
+dberr_t
+row_merge_scan_write(
+	row_merge_scan_ctx_t*	ctx,
+	ulint			i,
+	row_merge_buf_t**	merge_buf,
+	row_merge_block_t*	block)
+{
+	row_merge_buf_t*	buf = *merge_buf;
+	merge_file_t*		file = &ctx->files[i];
+	ulint			offset = 0;
+	dberr_t			err = DB_SUCCESS;
+
+	ut_ad(buf->n_tuples);
+
+	if (dict_index_is_unique(buf->index)) {
+		row_merge_dup_t	dup = {buf->index, NULL, ctx->col_map, 0};
+
+		row_merge_buf_sort(buf, &dup);
+
+		if (dup.n_dup) {
+			row_merge_scan_set_error(
+				ctx, DB_DUPLICATE_KEY,
+				ctx->key_numbers[i], buf);
+			return(DB_DUPLICATE_KEY);
+		}
+	} else {
+		row_merge_buf_sort(buf, NULL);
+	}
+
+	row_merge_buf_write(buf, file, block);
+
+	mutex_enter(&ctx->mutex);
+
+	if (row_merge_file_create_if_needed(
+		    file, ctx->tmpfd, 0, ctx->path) < 0) {
+		err = DB_OUT_OF_MEMORY;
+	} else {
+		offset = file->offset++;
+		file->n_rec += buf->n_tuples;
+	}
+
+	mutex_exit(&ctx->mutex);
+
+	if (err == DB_SUCCESS && !row_merge_write(file->fd, offset, block)) {
+		err = DB_TEMP_FILE_WRITE_FAILURE;
+	}
+
+	if (err != DB_SUCCESS) {
+		row_merge_scan_set_error(ctx, err, i, NULL);
+	}
+
+	UNIV_MEM_INVALID(&block[0], srv_sort_buf_size);
+	*merge_buf = row_merge_buf_empty(buf);
+
+	return(err);
+}
+
+/** Scan a key range of the clustered index for a parallel scan.
+@param[in]	scan	key range
+@return	DB_SUCCESS or error code */
+static MY_ATTRIBUTE((nonnull))
+dberr_t
+row_merge_scan_range(
+	const row_merge_scan_t*	scan)
+{
+	row_merge_scan_ctx_t*	ctx = scan->ctx;
+	const dict_table_t*	old_table = ctx->old_table;
+	dict_index_t*		clust_index;
+	row_merge_buf_t**	merge_buf;
+	row_merge_block_t*	block;
+	ulint			block_size = srv_sort_buf_size;
+	mem_heap_t*		row_heap;
+	mem_heap_t*		conv_heap = NULL;
+	btr_pcur_t		pcur;
+	mtr_t			mtr;
+	doc_id_t		doc_id = 0;
+	dberr_t			err = DB_SUCCESS;
+
+	block = static_cast<row_merge_block_t*>(
+		os_mem_alloc_large(&block_size));
+
+	if (block == NULL) {
+		row_merge_scan_set_error(
+			ctx, DB_OUT_OF_MEMORY, ULINT_UNDEFINED, NULL);
+		return(DB_OUT_OF_MEMORY);
+	}
+
+	merge_buf = static_cast<row_merge_buf_t**>(
+		mem_alloc(ctx->n_index * sizeof *merge_buf));
+
+	for (ulint i = 0; i < ctx->n_index; i++) {
+		merge_buf[i] = row_merge_buf_create(ctx->index[i]);
+	}
+
+	row_heap = mem_heap_create(sizeof(mrec_buf_t));
+
+	if (dict_table_is_comp(old_table)
+	    && !dict_table_is_comp(ctx->new_table)) {
+		conv_heap = mem_heap_create(sizeof(mrec_buf_t));
+	}
+
+	clust_index = dict_table_get_first_index(old_table);
+
+	mtr_start(&mtr);
+
+	if (scan->start == NULL) {
+		btr_pcur_open_at_index_side(
+			true, clust_index, BTR_SEARCH_LEAF, &pcur, true, 0,
+			&mtr);
+	} else {
+		/* Position the cursor before the first record of the
+		range, as page_cur_move_to_next() is done first below. */
+		btr_pcur_open(clust_index, scan->start, PAGE_CUR_L,
+			      BTR_SEARCH_LEAF, &pcur, &mtr);
+	}
+
+	for (;;) {
+		const rec_t*	rec;
+		ulint*		offsets;
+		const dtuple_t*	row;
+		row_ext_t*	ext;
+		page_cur_t*	cur	= btr_pcur_get_page_cur(&pcur);
+
+		mem_heap_empty(row_heap);
+
+		page_cur_move_to_next(cur);
+
+		if (page_cur_is_after_last(cur)) {
+			if (UNIV_UNLIKELY(trx_is_interrupted(ctx->trx))) {
+				err = DB_INTERRUPTED;
+				row_merge_scan_set_error(ctx, err, 0, NULL);
+				break;
+			}
+
+			if (ctx->error != DB_SUCCESS) {
+				/* Another thread failed. */
+				err = DB_INTERRUPTED;
+				break;
+			}
+
+#ifdef DBUG_OFF
+# define dbug_run_purge	false
+#else /* DBUG_OFF */
+			bool	dbug_run_purge = false;
+#endif /* DBUG_OFF */
+			DBUG_EXECUTE_IF(
+				"ib_purge_on_create_index_page_switch",
+				dbug_run_purge = true;);
+
+			if (dbug_run_purge
+			    || rw_lock_get_waiters(
+				    dict_index_get_lock(clust_index))) {
+				/* Yield to the waiters, like the serial
+				scan does. */
+				btr_pcur_move_to_prev_on_page(&pcur);
+				ut_ad(btr_pcur_is_on_user_rec(&pcur)
+				      || buf_block_get_page_no(
+					      btr_pcur_get_block(&pcur))
+				      == clust_index->page);
+
+				btr_pcur_store_position(&pcur, &mtr);
+				mtr_commit(&mtr);
+
+				if (dbug_run_purge) {
+					trx_purge_run();
+					os_thread_sleep(1000000);
+				}
+
+				os_thread_yield();
+
+				mtr_start(&mtr);
+				btr_pcur_restore_position(
+					BTR_SEARCH_LEAF, &pcur, &mtr);
+
+				if (!btr_pcur_move_to_next_user_rec(
+					    &pcur, &mtr)) {
+					break;
+				}
+			} else {
+				ulint		next_page_no;
+				buf_block_t*	block;
+
+				next_page_no = btr_page_get_next(
+					page_cur_get_page(cur), &mtr);
+
+				if (next_page_no == FIL_NULL) {
+					break;
+				}
+
+				block = page_cur_get_block(cur);
+				block = btr_block_get(
+					buf_block_get_space(block),
+					buf_block_get_zip_size(block),
+					next_page_no, BTR_SEARCH_LEAF,
+					clust_index, &mtr);
+
+				btr_leaf_page_release(page_cur_get_block(cur),
+						      BTR_SEARCH_LEAF, &mtr);
+				page_cur_set_before_first(block, cur);
+				page_cur_move_to_next(cur);
+
+				ut_ad(!page_cur_is_after_last(cur));
+			}
+		}
+
+		rec = page_cur_get_rec(cur);
+
+		offsets = rec_get_offsets(rec, clust_index, NULL,
+					  ULINT_UNDEFINED, &row_heap);
+
+		if (scan->end != NULL
+		    && cmp_dtuple_rec(scan->end, rec, offsets) <= 0) {
+			/* The next range begins here. */
+			break;
+		}
+
+		if (rec_get_deleted_flag(rec, dict_table_is_comp(old_table))) {
+			continue;
+		}
+
+		ut_ad(!rec_offs_any_null_extern(rec, offsets));
+
+		row = row_build(ROW_COPY_POINTERS, clust_index,
+				rec, offsets, ctx->new_table,
+				ctx->add_cols, ctx->col_map, &ext, row_heap);
+		ut_ad(row);
+
+		for (ulint i = 0; i < ctx->n_nonnull; i++) {
+			if (dfield_is_null(&row->fields[ctx->nonnull[i]])) {
+				err = DB_INVALID_NULL;
+				row_merge_scan_set_error(ctx, err, 0, NULL);
+				break;
+			}
+		}
+
+		for (ulint i = 0; err == DB_SUCCESS && i < ctx->n_index; i++) {
+			bool	exceed_page = false;
+
+			if (!row_merge_buf_add(merge_buf[i], NULL, old_table,
+					       NULL, row, ext, &doc_id,
+					       conv_heap, &exceed_page)) {
+				/* The buffer is full.  Write it out and
+				try again. */
+				err = row_merge_scan_write(
+					ctx, i, &merge_buf[i], block);
+
+				if (err != DB_SUCCESS) {
+					break;
+				}
+
+				if (!row_merge_buf_add(
+					    merge_buf[i], NULL, old_table,
+					    NULL, row, ext, &doc_id,
+					    conv_heap, &exceed_page)) {
+					/* An empty buffer should have enough
+					room for at least one record. */
+					ut_error;
+				}
+			}
+
+			if (exceed_page) {
+				err = DB_TOO_BIG_RECORD;
+				row_merge_scan_set_error(
+					ctx, err, ULINT_UNDEFINED, NULL);
+			}
+		}
+
+		if (err != DB_SUCCESS) {
+			break;
+		}
+	}
+
+	mtr_commit(&mtr);
+	btr_pcur_close(&pcur);
+
+	for (ulint i = 0; i < ctx->n_index; i++) {
+		if (err == DB_SUCCESS && merge_buf[i]->n_tuples) {
+			err = row_merge_scan_write(
+				ctx, i, &merge_buf[i], block);
+		}
+
+		row_merge_buf_free(merge_buf[i]);
+	}
+
+	if (conv_heap != NULL) {
+		mem_heap_free(conv_heap);
+	}
+
+	mem_heap_free(row_heap);
+	mem_free(merge_buf);
+	os_mem_free_large(block, block_size);
+
+	return(err);
+}
+
+/** Thread of a parallel scan.
+@param[in]	arg	key range, row_merge_scan_t
+@return	OS_THREAD_DUMMY_RETURN */
+static
+os_thread_ret_t
+row_merge_scan_thread(
+	void*	arg)
+{
+	my_thread_init();
+
+	/* Errors are recorded in the shared state. */
+	row_merge_scan_range(static_cast<row_merge_scan_t*>(arg));
+
+	my_thread_end();
+	os_thread_exit(NULL, false);
+
+	OS_THREAD_DUMMY_RETURN;
+}
+
+/** Split the clustered index into key ranges at the node pointers of the
+root page.
+@param[in]	clust_index	clustered index
+@param[in]	n		maximum number of ranges
+@param[in,out]	heap		memory heap for the keys
+@param[out]	keys		n - 1 keys, where ranges 1 and up begin
+@return	number of ranges, 1 if the index cannot be split */
+static MY_ATTRIBUTE((nonnull, warn_unused_result))
+ulint
+row_merge_scan_split(
+	dict_index_t*	clust_index,
+	ulint		n,
+	mem_heap_t*	heap,
+	dtuple_t**	keys)
+{
+	mtr_t		mtr;
+	buf_block_t*	root;
+	const page_t*	page;
+	ulint		n_recs;
+
+	mtr_start(&mtr);
+	mtr_s_lock(dict_index_get_lock(clust_index), &mtr);
+
+	root = btr_block_get(dict_index_get_space(clust_index),
+			     dict_table_zip_size(clust_index->table),
+			     dict_index_get_page(clust_index), RW_S_LATCH,
+			     clust_index, &mtr);
+	page = buf_block_get_frame(root);
+	n_recs = page_get_n_recs(page);
+
+	if (btr_page_get_level(page, &mtr) == 0 || n_recs < 2) {
+		mtr_commit(&mtr);
+		return(1);
+	}
+
+	if (n > n_recs) {
+		n = n_recs;
+	}
+
+	/* The first node pointer points to the start of the index. */
+	rec_t*	rec = page_rec_get_next(page_get_infimum_rec(page));
+	ulint	rec_no = 0;
+
+	for (ulint i = 1; i < n; i++) {
+		ulint	target = i * n_recs / n;
+
+		while (rec_no < target) {
+			rec = page_rec_get_next(rec);
+			rec_no++;
+		}
+
+		keys[i - 1] = dict_index_build_data_tuple(
+			clust_index, rec,
+			dict_index_get_n_unique_in_tree(clust_index), heap);
+	}
+
+	mtr_commit(&mtr);
+
+	return(n);
+}
+
+/** Read the clustered index with a parallel scan, if it can be split.
+@param[in]	trx		transaction
+@param[in,out]	table		MySQL table object, for reporting erroneous
+				records
+@param[in]	old_table	table where rows are read from
+@param[in]	new_table	table where indexes are created
+@param[in]	index		indexes to be created
+@param[in]	files		temporary files
+@param[in]	key_numbers	MySQL key numbers to create
+@param[in]	n_index		number of indexes to create
+@param[in]	add_cols	default values of added columns, or NULL
+@param[in]	col_map		mapping of old column numbers to new ones, or
+				NULL if old_table == new_table
+@param[in,out]	tmpfd		temporary file handle
+@param[out]	scanned		whether the parallel scan was done
+@return	DB_SUCCESS or error code */
+static MY_ATTRIBUTE((nonnull(1,2,3,4,5,6,7,12), warn_unused_result))
+dberr_t
+row_merge_read_clustered_index_parallel(
+	trx_t*			trx,
+	struct TABLE*		table,
+	const dict_table_t*	old_table,
+	const dict_table_t*	new_table,
+	dict_index_t**		index,
+	merge_file_t*		files,
+	const ulint*		key_numbers,
+	ulint			n_index,
+	const dtuple_t*		add_cols,
+	const ulint*		col_map,
+	int*			tmpfd,
+	bool*			scanned)
+{
+	row_merge_scan_ctx_t	ctx;
+	row_merge_scan_t*	scan;
+	dtuple_t**		keys;
+	mem_heap_t*		heap;
+	ulint			n;
+
+	*scanned = false;
+
+	/* Each thread has a sort buffer for each index and a file
+	buffer, of about innodb_sort_buffer_size each. */
+	n = srv_sort_memory_limit / ((n_index + 1) * srv_sort_buf_size);
+	n = ut_min(n, ulint(srv_sort_scan_threads));
+
+	if (n < 2) {
+		return(DB_SUCCESS);
+	}
+
+	heap = mem_heap_create(1024);
+	keys = static_cast<dtuple_t**>(
+		mem_heap_alloc(heap, (n - 1) * sizeof *keys));
+
+	n = row_merge_scan_split(
+		dict_table_get_first_index(old_table), n, heap, keys);
+
+	if (n < 2) {
+		mem_heap_free(heap);
+		return(DB_SUCCESS);
+	}
+
+	*scanned = true;
+
+	ctx.trx = trx;
+	ctx.table = table;
+	ctx.old_table = old_table;
+	ctx.new_table = new_table;
+	ctx.index = index;
+	ctx.files = files;
+	ctx.key_numbers = key_numbers;
+	ctx.n_index = n_index;
+	ctx.add_cols = add_cols;
+	ctx.col_map = col_map;
+	ctx.nonnull = NULL;
+	ctx.n_nonnull = 0;
+	ctx.path = thd_innodb_tmpdir(trx->mysql_thd);
+	ctx.tmpfd = tmpfd;
+	ctx.error = DB_SUCCESS;
+	ctx.error_key_num = ULINT_UNDEFINED;
+
+	if (old_table != new_table) {
+		ctx.nonnull = row_merge_get_nonnull(
+			old_table, new_table, col_map, &ctx.n_nonnull);
+	}
+
+	mutex_create(row_merge_scan_mutex_key, &ctx.mutex, SYNC_ANY_LATCH);
+
+	scan = static_cast<row_merge_scan_t*>(
+		mem_heap_alloc(heap, n * sizeof *scan));
+
+	for (ulint i = 0; i < n; i++) {
+		os_thread_id_t	thd_id;
+
+		scan[i].ctx = &ctx;
+		scan[i].start = i ? keys[i - 1] : NULL;
+		scan[i].end = i + 1 < n ? keys[i] : NULL;
+		scan[i].thread_hdl = os_thread_create(
+			row_merge_scan_thread, &scan[i], &thd_id);
+	}
+
+	for (ulint i = 0; i < n; i++) {
+		os_thread_join(scan[i].thread_hdl);
+	}
+
+	mutex_free(&ctx.mutex);
+
+	if (ctx.nonnull != NULL) {
+		mem_free(const_cast<ulint*>(ctx.nonnull));
+	}
+
+	mem_heap_free(heap);
+
+	if (ctx.error != DB_SUCCESS
+	    && ctx.error_key_num != ULINT_UNDEFINED) {
+		trx->error_key_num = ctx.error_key_num;
+	}
+
+	return(ctx.error);
+}
+
 /** Reads clustered index of the table and create temporary files
 containing the index entries for the indexes to be built.
 @param[in]	trx		transaction
@@ -1365,6 +2020,21 @@ row_merge_read_clustered_index(
 	ut_ad(trx->mysql_thd != NULL);
 	const char*	path = thd_innodb_tmpdir(trx->mysql_thd);
 
+	if (!online && fts_sort_idx == NULL
+	    && add_autoinc == ULINT_UNDEFINED) {
+		bool	scanned;
+
+		err = row_merge_read_clustered_index_parallel(
+			trx, table, old_table, new_table, index, files,
+			key_numbers, n_index, add_cols, col_map, tmpfd,
+			&scanned);
+
+		if (scanned) {
+			trx->op_info = "";
+			DBUG_RETURN(err);
+		}
+	}
+
 	/* Create and initialize memory for record buffers */
 
 	merge_buf = static_cast<row_merge_buf_t**>(
@@ -1413,38 +2083,8 @@ row_merge_read_clustered_index(
 		true, clust_index, BTR_SEARCH_LEAF, &pcur, true, 0, &mtr);
 
 	if (old_table != new_table) {
-		/* The table is being rebuilt.  Identify the columns
-		that were flagged NOT NULL in the new table, so that
-		we can quickly check that the records in the old table
-		do not violate the added NOT NULL constraints. */
-
-		nonnull = static_cast<ulint*>(
-			mem_alloc(dict_table_get_n_cols(new_table)
-				  * sizeof *nonnull));
-
-		for (ulint i = 0; i < dict_table_get_n_cols(old_table); i++) {
-			if (dict_table_get_nth_col(old_table, i)->prtype
-			    & DATA_NOT_NULL) {
-				continue;
-			}
-
-			const ulint j = col_map[i];
-
-			if (j == ULINT_UNDEFINED) {
-				/* The column was dropped. */
-				continue;
-			}
-
-			if (dict_table_get_nth_col(new_table, j)->prtype
-			    & DATA_NOT_NULL) {
-				nonnull[n_nonnull++] = j;
-			}
-		}
-
-		if (!n_nonnull) {
-			mem_free(nonnull);
-			nonnull = NULL;
-		}
+		nonnull = row_merge_get_nonnull(
+			old_table, new_table, col_map, &n_nonnull);
 	}
 
 	row_heap = mem_heap_create(sizeof(mrec_buf_t));
@@ -2001,213 +2641,191 @@ wait_again:
 	DBUG_RETURN(err);
 }
 
-/** Write a record via buffer 2 and read the next record to buffer N.
-@param N	number of the buffer (0 or 1)
-@param INDEX	record descriptor
-@param AT_END	statement to execute at end of input */
-#define ROW_MERGE_WRITE_GET_NEXT(N, INDEX, AT_END)			\
-	do {								\
-		b2 = row_merge_write_rec(&block[2 * srv_sort_buf_size], \
-					 &buf[2], b2,			\
-					 of->fd, &of->offset,		\
-					 mrec##N, offsets##N);		\
-		if (UNIV_UNLIKELY(!b2 || ++of->n_rec > file->n_rec)) {	\
-			goto corrupt;					\
-		}							\
-		b##N = row_merge_read_rec(&block[N * srv_sort_buf_size],\
-					  &buf[N], b##N, INDEX,		\
-					  file->fd, foffs##N,		\
-					  &mrec##N, offsets##N);	\
-		if (UNIV_UNLIKELY(!b##N)) {				\
-			if (mrec##N) {					\
-				goto corrupt;				\
-			}						\
-			AT_END;						\
-		}							\
-	} while (0)
+/*************************************************************//**
+Determine whether the current record of one merge run must be written
+before that of another.  A run that is exhausted never precedes, and the
+sentinel n, which is only present while the tree of losers is being set
+up, always precedes.
+@return	true if run a precedes run b */
+static
+bool
+row_merge_precedes(
+/*===============*/
+	ulint			a,	/*!< in: run number, or n */
+	ulint			b,	/*!< in: run number, or n */
+	ulint			n,	/*!< in: number of runs */
+	const mrec_t**		mrec,	/*!< in: current records */
+	ulint**			offsets,/*!< in: offsets of mrec[] */
+	const row_merge_dup_t*	dup,	/*!< in: descriptor of
+					index being created */
+	bool*			dupkey)	/*!< out: set to true if the
+					records are duplicates */
+{
+	int	cmp;
+
+	if (a == n) {
+		return(true);
+	} else if (b == n || !mrec[a]) {
+		return(false);
+	} else if (!mrec[b]) {
+		return(true);
+	}
+
+	cmp = cmp_rec_rec_simple(mrec[a], mrec[b], offsets[a], offsets[b],
+				 dup->index, dup->table);
+
+	if (!cmp) {
+		*dupkey = true;
+	}
+
+	return(cmp < 0);
+}
+
+/*************************************************************//**
+Replay the matches on the path from a leaf of the tree of losers to the
+root after the current record of that run has changed.  tree[0] is the
+winner, tree[1..n-1] are the losers of the matches, and run i is the
+leaf n + i.  Because the record that enters a match is always compared
+with the winner of the other subtree, two equal records at the heads of
+their runs are bound to meet in some match before either is written. */
+static
+void
+row_merge_tree_adjust(
+/*==================*/
+	ulint*			tree,	/*!< in/out: tree of losers */
+	ulint			s,	/*!< in: run whose record changed */
+	ulint			n,	/*!< in: number of runs */
+	const mrec_t**		mrec,	/*!< in: current records */
+	ulint**			offsets,/*!< in: offsets of mrec[] */
+	const row_merge_dup_t*	dup,	/*!< in: descriptor of
+					index being created */
+	bool*			dupkey)	/*!< out: set to true if
+					duplicates were found */
+{
+	for (ulint t = (s + n) / 2; t > 0; t /= 2) {
+		if (row_merge_precedes(tree[t], s, n, mrec, offsets,
+				       dup, dupkey)) {
+			ulint	loser = s;
+
+			s = tree[t];
+			tree[t] = loser;
+		}
+	}
+
+	tree[0] = s;
+}
 
 /*************************************************************//**
-Merge two blocks of records on disk and write a bigger block.
+Merge n runs of records on disk into one bigger run.
 @return	DB_SUCCESS or error code */
 static MY_ATTRIBUTE((nonnull, warn_unused_result))
 dberr_t
-row_merge_blocks(
-/*=============*/
+row_merge_runs(
+/*===========*/
 	const row_merge_dup_t*	dup,	/*!< in: descriptor of
 					index being created */
 	const merge_file_t*	file,	/*!< in: file containing
 					index entries */
-	row_merge_block_t*	block,	/*!< in/out: 3 buffers */
-	ulint*			foffs0,	/*!< in/out: offset of first
-					source list in the file */
-	ulint*			foffs1,	/*!< in/out: offset of second
-					source list in the file */
+	row_merge_block_t*	block,	/*!< in/out: n + 1 buffers */
+	const ulint*		run_offset,/*!< in: offsets of the first
+					blocks of the source runs */
+	ulint			n,	/*!< in: number of source runs */
 	merge_file_t*		of)	/*!< in/out: output file */
 {
-	mem_heap_t*	heap;	/*!< memory heap for offsets0, offsets1 */
-
-	mrec_buf_t*	buf;	/*!< buffer for handling
-				split mrec in block[] */
-	const byte*	b0;	/*!< pointer to block[0] */
-	const byte*	b1;	/*!< pointer to block[srv_sort_buf_size] */
-	byte*		b2;	/*!< pointer to block[2 * srv_sort_buf_size] */
-	const mrec_t*	mrec0;	/*!< merge rec, points to block[0] or buf[0] */
-	const mrec_t*	mrec1;	/*!< merge rec, points to
-				block[srv_sort_buf_size] or buf[1] */
-	ulint*		offsets0;/* offsets of mrec0 */
-	ulint*		offsets1;/* offsets of mrec1 */
+	mem_heap_t*	heap;	/*!< memory heap for the arrays below */
+	mrec_buf_t*	buf;	/*!< buffers for handling split mrec
+				in block[]; buf[n] is for the output */
+	ulint*		foffs;	/*!< input file offsets */
+	const byte**	b;	/*!< pointers to the input blocks */
+	byte*		b_out;	/*!< pointer to block[n * srv_sort_buf_size] */
+	const mrec_t**	mrec;	/*!< merge recs, point to the input
+				blocks or buf[] */
+	ulint**		offsets;/*!< offsets of mrec[] */
+	ulint*		tree;	/*!< tree of losers over the runs */
+	bool		dupkey	= false;
+	row_merge_block_t* block_out = &block[n * srv_sort_buf_size];
+
+	ut_ad(n > 0);
 
 #ifdef UNIV_DEBUG
 	if (row_merge_print_block) {
 		fprintf(stderr,
-			"row_merge_blocks fd=%d ofs=%lu + fd=%d ofs=%lu"
+			"row_merge_runs fd=%d ofs=%lu n=%lu"
 			" = fd=%d ofs=%lu\n",
-			file->fd, (ulong) *foffs0,
-			file->fd, (ulong) *foffs1,
+			file->fd, (ulong) run_offset[0], (ulong) n,
 			of->fd, (ulong) of->offset);
 	}
 #endif /* UNIV_DEBUG */
 
-	heap = row_merge_heap_create(dup->index, &buf, &offsets0, &offsets1);
+	heap = row_merge_heap_create(dup->index, n, &buf, &offsets);
 
-	/* Write a record and read the next record.  Split the output
-	file in two halves, which can be merged on the following pass. */
+	foffs = static_cast<ulint*>(mem_heap_alloc(heap, n * sizeof *foffs));
+	b = static_cast<const byte**>(mem_heap_alloc(heap, n * sizeof *b));
+	mrec = static_cast<const mrec_t**>(
+		mem_heap_alloc(heap, n * sizeof *mrec));
+	tree = static_cast<ulint*>(mem_heap_alloc(heap, n * sizeof *tree));
 
-	if (!row_merge_read(file->fd, *foffs0, &block[0])
-	    || !row_merge_read(file->fd, *foffs1, &block[srv_sort_buf_size])) {
-corrupt:
-		mem_heap_free(heap);
-		return(DB_CORRUPTION);
-	}
+	memcpy(foffs, run_offset, n * sizeof *foffs);
 
-	b0 = &block[0];
-	b1 = &block[srv_sort_buf_size];
-	b2 = &block[2 * srv_sort_buf_size];
+	for (ulint i = 0; i < n; i++) {
+		row_merge_block_t*	bl = &block[i * srv_sort_buf_size];
 
-	b0 = row_merge_read_rec(
-		&block[0], &buf[0], b0, dup->index,
-		file->fd, foffs0, &mrec0, offsets0);
-	b1 = row_merge_read_rec(
-		&block[srv_sort_buf_size],
-		&buf[srv_sort_buf_size], b1, dup->index,
-		file->fd, foffs1, &mrec1, offsets1);
-	if (UNIV_UNLIKELY(!b0 && mrec0)
-	    || UNIV_UNLIKELY(!b1 && mrec1)) {
+		if (!row_merge_read(file->fd, foffs[i], bl)) {
+			goto corrupt;
+		}
 
-		goto corrupt;
-	}
+		b[i] = row_merge_read_rec(bl, &buf[i], bl, dup->index,
+					  file->fd, &foffs[i],
+					  &mrec[i], offsets[i]);
 
-	while (mrec0 && mrec1) {
-		switch (cmp_rec_rec_simple(
-				mrec0, mrec1, offsets0, offsets1,
-				dup->index, dup->table)) {
-		case 0:
-			mem_heap_free(heap);
-			return(DB_DUPLICATE_KEY);
-		case -1:
-			ROW_MERGE_WRITE_GET_NEXT(0, dup->index, goto merged);
-			break;
-		case 1:
-			ROW_MERGE_WRITE_GET_NEXT(1, dup->index, goto merged);
-			break;
-		default:
-			ut_error;
+		if (UNIV_UNLIKELY(!b[i] && mrec[i])) {
+			goto corrupt;
 		}
-	}
 
-merged:
-	if (mrec0) {
-		/* append all mrec0 to output */
-		for (;;) {
-			ROW_MERGE_WRITE_GET_NEXT(0, dup->index, goto done0);
-		}
+		tree[i] = n;
 	}
-done0:
-	if (mrec1) {
-		/* append all mrec1 to output */
-		for (;;) {
-			ROW_MERGE_WRITE_GET_NEXT(1, dup->index, goto done1);
-		}
-	}
-done1:
-
-	mem_heap_free(heap);
-	b2 = row_merge_write_eof(&block[2 * srv_sort_buf_size],
-				 b2, of->fd, &of->offset);
-	return(b2 ? DB_SUCCESS : DB_CORRUPTION);
-}
-
-/*************************************************************//**
-Copy a block of index entries.
-@return	TRUE on success, FALSE on failure */
-static MY_ATTRIBUTE((nonnull, warn_unused_result))
-ibool
-row_merge_blocks_copy(
-/*==================*/
-	const dict_index_t*	index,	/*!< in: index being created */
-	const merge_file_t*	file,	/*!< in: input file */
-	row_merge_block_t*	block,	/*!< in/out: 3 buffers */
-	ulint*			foffs0,	/*!< in/out: input file offset */
-	merge_file_t*		of)	/*!< in/out: output file */
-{
-	mem_heap_t*	heap;	/*!< memory heap for offsets0, offsets1 */
 
-	mrec_buf_t*	buf;	/*!< buffer for handling
-				split mrec in block[] */
-	const byte*	b0;	/*!< pointer to block[0] */
-	byte*		b2;	/*!< pointer to block[2 * srv_sort_buf_size] */
-	const mrec_t*	mrec0;	/*!< merge rec, points to block[0] */
-	ulint*		offsets0;/* offsets of mrec0 */
-	ulint*		offsets1;/* dummy offsets */
-
-#ifdef UNIV_DEBUG
-	if (row_merge_print_block) {
-		fprintf(stderr,
-			"row_merge_blocks_copy fd=%d ofs=%lu"
-			" = fd=%d ofs=%lu\n",
-			file->fd, (ulong) foffs0,
-			of->fd, (ulong) of->offset);
+	for (ulint i = n; i--; ) {
+		row_merge_tree_adjust(tree, i, n, mrec, offsets, dup, &dupkey);
 	}
-#endif /* UNIV_DEBUG */
 
-	heap = row_merge_heap_create(index, &buf, &offsets0, &offsets1);
+	b_out = block_out;
 
-	/* Write a record and read the next record.  Split the output
-	file in two halves, which can be merged on the following pass. */
+	while (!dupkey && mrec[tree[0]]) {
+		const ulint	w = tree[0];
 
-	if (!row_merge_read(file->fd, *foffs0, &block[0])) {
-corrupt:
-		mem_heap_free(heap);
-		return(FALSE);
-	}
+		b_out = row_merge_write_rec(block_out, &buf[n], b_out,
+					    of->fd, &of->offset,
+					    mrec[w], offsets[w]);
 
-	b0 = &block[0];
+		if (UNIV_UNLIKELY(!b_out || ++of->n_rec > file->n_rec)) {
+			goto corrupt;
+		}
 
-	b2 = &block[2 * srv_sort_buf_size];
+		b[w] = row_merge_read_rec(&block[w * srv_sort_buf_size],
+					  &buf[w], b[w], dup->index,
+					  file->fd, &foffs[w],
+					  &mrec[w], offsets[w]);
 
-	b0 = row_merge_read_rec(&block[0], &buf[0], b0, index,
-				file->fd, foffs0, &mrec0, offsets0);
-	if (UNIV_UNLIKELY(!b0 && mrec0)) {
+		if (UNIV_UNLIKELY(!b[w] && mrec[w])) {
+			goto corrupt;
+		}
 
-		goto corrupt;
+		row_merge_tree_adjust(tree, w, n, mrec, offsets, dup, &dupkey);
 	}
 
-	if (mrec0) {
-		/* append all mrec0 to output */
-		for (;;) {
-			ROW_MERGE_WRITE_GET_NEXT(0, index, goto done0);
-		}
+	mem_heap_free(heap);
+
+	if (dupkey) {
+		return(DB_DUPLICATE_KEY);
 	}
-done0:
 
-	/* The file offset points to the beginning of the last page
-	that has been read.  Update it to point to the next block. */
-	(*foffs0)++;
+	b_out = row_merge_write_eof(block_out, b_out, of->fd, &of->offset);
+	return(b_out ? DB_SUCCESS : DB_CORRUPTION);
 
+corrupt:
 	mem_heap_free(heap);
-	return(row_merge_write_eof(&block[2 * srv_sort_buf_size],
-				   b2, of->fd, &of->offset)
-	       != NULL);
+	return(DB_CORRUPTION);
 }
 
 /*************************************************************//**
@@ -2222,7 +2840,9 @@ row_merge(
 					index being created */
 	merge_file_t*		file,	/*!< in/out: file containing
 					index entries */
-	row_merge_block_t*	block,	/*!< in/out: 3 buffers */
+	row_merge_block_t*	block,	/*!< in/out: fan_in + 1 buffers */
+	ulint			fan_in,	/*!< in: maximum number of runs
+					to merge into one */
 	int*			tmpfd,	/*!< in/out: temporary file handle */
 	ulint*			num_run,/*!< in/out: Number of runs remain
 					to be merged */
@@ -2230,18 +2850,15 @@ row_merge(
 					first offset number for each merge
 					run */
 {
-	ulint		foffs0;	/*!< first input offset */
-	ulint		foffs1;	/*!< second input offset */
 	dberr_t		error;	/*!< error code */
 	merge_file_t	of;	/*!< output file */
-	const ulint	ihalf	= run_offset[*num_run / 2];
-				/*!< half the input file */
 	ulint		n_run	= 0;
 				/*!< num of runs generated from this merge */
 
-	UNIV_MEM_ASSERT_W(&block[0], 3 * srv_sort_buf_size);
+	UNIV_MEM_ASSERT_W(&block[0], (fan_in + 1) * srv_sort_buf_size);
 
-	ut_ad(ihalf < file->offset);
+	ut_ad(fan_in >= 2);
+	ut_ad(*num_run > 1);
 
 	of.fd = *tmpfd;
 	of.offset = 0;
@@ -2249,75 +2866,40 @@ row_merge(
 
 #ifdef POSIX_FADV_SEQUENTIAL
 	/* The input file will be read sequentially, starting from the
-	beginning and the middle.  In Linux, the POSIX_FADV_SEQUENTIAL
+	beginning of each run.  In Linux, the POSIX_FADV_SEQUENTIAL
 	affects the entire file.  Each block will be read exactly once. */
 	posix_fadvise(file->fd, 0, 0,
 		      POSIX_FADV_SEQUENTIAL | POSIX_FADV_NOREUSE);
 #endif /* POSIX_FADV_SEQUENTIAL */
 
-	/* Merge blocks to the output file. */
-	foffs0 = 0;
-	foffs1 = ihalf;
+	/* Merge each group of up to fan_in consecutive runs into one
+	run of the output file.  The output run number never exceeds
+	the input run number, so run_offset[] can be updated in place. */
 
-	UNIV_MEM_INVALID(run_offset, *num_run * sizeof *run_offset);
-
-	for (; foffs0 < ihalf && foffs1 < file->offset; foffs0++, foffs1++) {
+	for (ulint i = 0; i < *num_run; i += fan_in) {
+		const ulint	n = ut_min(fan_in, *num_run - i);
+		const ulint	offset = of.offset;
 
 		if (trx_is_interrupted(trx)) {
 			return(DB_INTERRUPTED);
 		}
 
-		/* Remember the offset number for this run */
-		run_offset[n_run++] = of.offset;
-
-		error = row_merge_blocks(dup, file, block,
-					 &foffs0, &foffs1, &of);
+		error = row_merge_runs(dup, file, block, &run_offset[i],
+				       n, &of);
 
 		if (error != DB_SUCCESS) {
 			return(error);
 		}
 
-	}
-
-	/* Copy the last blocks, if there are any. */
-
-	while (foffs0 < ihalf) {
-		if (UNIV_UNLIKELY(trx_is_interrupted(trx))) {
-			return(DB_INTERRUPTED);
-		}
-
-		/* Remember the offset number for this run */
-		run_offset[n_run++] = of.offset;
-
-		if (!row_merge_blocks_copy(dup->index, file, block,
-					   &foffs0, &of)) {
-			return(DB_CORRUPTION);
-		}
-	}
-
-	ut_ad(foffs0 == ihalf);
-
-	while (foffs1 < file->offset) {
-		if (trx_is_interrupted(trx)) {
-			return(DB_INTERRUPTED);
-		}
-
 		/* Remember the offset number for this run */
-		run_offset[n_run++] = of.offset;
-
-		if (!row_merge_blocks_copy(dup->index, file, block,
-					   &foffs1, &of)) {
-			return(DB_CORRUPTION);
-		}
+		run_offset[n_run++] = offset;
 	}
 
-	ut_ad(foffs1 == file->offset);
-
 	if (UNIV_UNLIKELY(of.n_rec != file->n_rec)) {
 		return(DB_CORRUPTION);
 	}
 
-	ut_ad(n_run <= *num_run);
+	ut_ad(n_run < *num_run);
 
 	*num_run = n_run;
 
@@ -2335,7 +2917,7 @@ row_merge(
 	*tmpfd = file->fd;
 	*file = of;
 
-	UNIV_MEM_INVALID(&block[0], 3 * srv_sort_buf_size);
+	UNIV_MEM_INVALID(&block[0], (fan_in + 1) * srv_sort_buf_size);
 
 	return(DB_SUCCESS);
 }
@@ -2355,10 +2937,12 @@ row_merge_sort(
 	row_merge_block_t*	block,	/*!< in/out: 3 buffers */
 	int*			tmpfd)	/*!< in/out: temporary file handle */
 {
-	const ulint	half	= file->offset / 2;
-	ulint		num_runs;
-	ulint*		run_offset;
-	dberr_t		error	= DB_SUCCESS;
+	ulint			num_runs;
+	ulint*			run_offset;
+	ulint			fan_in;
+	row_merge_block_t*	merge_block	= block;
+	ulint			merge_block_size = 0;
+	dberr_t			error	= DB_SUCCESS;
 	DBUG_ENTER("row_merge_sort");
 
 	/* Record the number of merge runs we need to perform */
@@ -2369,20 +2953,41 @@ row_merge_sort(
 		DBUG_RETURN(error);
 	}
 
-	/* "run_offset" records each run's first offset number */
-	run_offset = (ulint*) mem_alloc(file->offset * sizeof(ulint));
+	/* "run_offset" records each run's first offset number.
+	Initially, each block of the file is a run by itself. */
+	run_offset = (ulint*) mem_alloc(num_runs * sizeof(ulint));
+
+	for (ulint i = 0; i < num_runs; i++) {
+		run_offset[i] = i;
+	}
 
-	/* This tells row_merge() where to start for the first round
-	of merge. */
-	run_offset[half] = half;
+	/* Merging more than two runs at a time needs one more buffer
+	per additional run, within innodb_sort_memory_limit.  Fall back
+	to two-way merge passes in the buffers of the caller if they
+	cannot be allocated. */
+	fan_in = ut_min(ulint(srv_sort_merge_fan_in), num_runs);
 
-	/* The file should always contain at least one byte (the end
-	of file marker).  Thus, it must be at least one block. */
-	ut_ad(file->offset > 0);
+	if ((fan_in + 1) * srv_sort_buf_size > srv_sort_memory_limit) {
+		fan_in = srv_sort_memory_limit / srv_sort_buf_size;
+		fan_in = fan_in ? fan_in - 1 : 0;
+	}
+
+	if (fan_in > 2) {
+		merge_block_size = (fan_in + 1) * srv_sort_buf_size;
+		merge_block = static_cast<row_merge_block_t*>(
+			os_mem_alloc_large(&merge_block_size));
+
+		if (merge_block == NULL) {
+			merge_block = block;
+			fan_in = 2;
+		}
+	} else {
+		fan_in = 2;
+	}
 
 	/* Merge the runs until we have one big run */
 	do {
-		error = row_merge(trx, dup, file, block, tmpfd,
+		error = row_merge(trx, dup, file, merge_block, fan_in, tmpfd,
 				  &num_runs, run_offset);
 
 		if (error != DB_SUCCESS) {
@@ -2392,6 +2997,10 @@ row_merge_sort(
 		UNIV_MEM_ASSERT_RW(run_offset, num_runs * sizeof *run_offset);
 	} while (num_runs > 1);
 
+	if (merge_block != block) {
+		os_mem_free_large(merge_block, merge_block_size);
+	}
+
 	mem_free(run_offset);
 
 	DBUG_RETURN(error);
@@ -2442,7 +3051,8 @@ row_merge_copy_blobs(
 
 /********************************************************************//**
 Read sorted file containing index data tuples and insert these data
-tuples to the index
+tuples to the index.  The tree is built bottom-up by btr_bulk_insert(),
+unless the table is compressed.
 @return	DB_SUCCESS or error number */
 static MY_ATTRIBUTE((nonnull, warn_unused_result))
 dberr_t
@@ -2462,6 +3072,7 @@ row_merge_insert_index_tuples(
 	ulint			foffs = 0;
 	ulint*			offsets;
 	mrec_buf_t*		buf;
+	btr_bulk_t*		bulk;
 	DBUG_ENTER("row_merge_insert_index_tuples");
 
 	ut_ad(!srv_read_only_mode);
@@ -2469,6 +3080,7 @@ row_merge_insert_index_tuples(
 	ut_ad(trx_id);
 
 	tuple_heap = mem_heap_create(1000);
+	bulk = btr_bulk_create(index, trx_id);
 
 	{
 		ulint i	= 1 + REC_OFFS_HEADER_SIZE
@@ -2552,6 +3164,18 @@ row_merge_insert_index_tuples(
 			}
 
 			ut_ad(dtuple_validate(dtuple));
+
+			if (bulk) {
+				error = btr_bulk_insert(bulk, dtuple);
+
+				if (error != DB_SUCCESS) {
+					goto err_exit;
+				}
+
+				mem_heap_empty(tuple_heap);
+				continue;
+			}
+
 			log_free_check();
 
 			mtr_start(&mtr);
@@ -2642,6 +3266,10 @@ row_merge_insert_index_tuples(
 	}
 
 err_exit:
+	if (bulk) {
+		error = btr_bulk_finish(bulk, error);
+	}
+
 	mem_heap_free(tuple_heap);
 	mem_heap_free(ins_heap);
 	mem_heap_free(heap);
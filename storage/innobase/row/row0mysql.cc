@@ -2141,7 +2141,27 @@ row_mysql_lock_data_dictionary_func(
 	/* Serialize data dictionary operations with dictionary mutex:
 	no deadlocks or lock waits can occur then in these operations */
 
+#ifdef WITH_INNODB_DISALLOW_WRITES
+	/* Tablespace files cannot be created, deleted or renamed while
+	a snapshot is active. Wait for it to end before locking, so that
+	other threads can use the dictionary meanwhile. No snapshot
+	begins while dict_operation_lock is x-locked. */
+	for (;;) {
+		if (trx->dict_operation_lock_mode != RW_X_LATCH) {
+			fil_snapshot_wait();
+		}
+
+		rw_lock_x_lock_inline(&dict_operation_lock, 0, file, line);
+
+		if (!fil_snapshot_is_active()) {
+			break;
+		}
+
+		rw_lock_x_unlock(&dict_operation_lock);
+	}
+#else
 	rw_lock_x_lock_inline(&dict_operation_lock, 0, file, line);
+#endif /* WITH_INNODB_DISALLOW_WRITES */
 	trx->dict_operation_lock_mode = RW_X_LATCH;
 
 	mutex_enter(&(dict_sys->mutex));
@@ -392,6 +392,27 @@ static monitor_info_t	innodb_counter_info[] =
 	 MONITOR_NONE,
 	 MONITOR_DEFAULT_START, MONITOR_FLUSH_SYNC_WAITS},
 
+	/* Time spent by each page_cleaner thread in the last batch */
+	{"buffer_flush_avg_time_thread", "buffer",
+	 "Avg time (ms) spent by a page cleaner thread in a flush list batch",
+	 MONITOR_NONE,
+	 MONITOR_DEFAULT_START, MONITOR_FLUSH_AVG_TIME_THREAD},
+
+	{"buffer_flush_max_time_thread", "buffer",
+	 "Max time (ms) spent by a page cleaner thread in a flush list batch",
+	 MONITOR_NONE,
+	 MONITOR_DEFAULT_START, MONITOR_FLUSH_MAX_TIME_THREAD},
+
+	{"buffer_LRU_batch_flush_avg_time_thread", "buffer",
+	 "Avg time (ms) spent by a page cleaner thread in an LRU batch",
+	 MONITOR_NONE,
+	 MONITOR_DEFAULT_START, MONITOR_LRU_BATCH_FLUSH_AVG_TIME_THREAD},
+
+	{"buffer_LRU_batch_flush_max_time_thread", "buffer",
+	 "Max time (ms) spent by a page cleaner thread in an LRU batch",
+	 MONITOR_NONE,
+	 MONITOR_DEFAULT_START, MONITOR_LRU_BATCH_FLUSH_MAX_TIME_THREAD},
+
 	/* Cumulative counter for flush batches for adaptive flushing  */
 	{"buffer_flush_adaptive_total_pages", "buffer",
 	 "Total pages flushed as part of adaptive flushing",
@@ -716,6 +737,11 @@ static monitor_info_t	innodb_counter_info[] =
 	 MONITOR_NONE,
 	 MONITOR_DEFAULT_START, MONITOR_TRX_ACTIVE},
 
+	{"trx_ids_allocated_nomutex", "transaction",
+	 "Number of transaction ids allocated without trx_sys->mutex",
+	 MONITOR_NONE,
+	 MONITOR_DEFAULT_START, MONITOR_TRX_ID_NOMUTEX},
+
 	{"trx_rseg_history_len", "transaction",
 	 "Length of the TRX_RSEG_HISTORY list",
 	 static_cast<monitor_type_t>(
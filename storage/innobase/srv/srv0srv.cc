@@ -143,6 +143,14 @@ on duplicate key checking and foreign key checking */
 UNIV_INTERN ibool	srv_locks_unsafe_for_binlog = FALSE;
 /** Sort buffer size in index creation */
 UNIV_INTERN ulong	srv_sort_buf_size = 1048576;
+/** Number of runs merged in one pass of the index creation merge sort */
+UNIV_INTERN ulong	srv_sort_merge_fan_in = 8;
+/** Memory for the sort buffers of an index creation beyond the three
+it always uses */
+UNIV_INTERN ulong	srv_sort_memory_limit = 128 << 20;
+/** Maximum number of threads scanning the clustered index in an index
+creation that is not online */
+UNIV_INTERN ulong	srv_sort_scan_threads = 4;
 /** Maximum modification log file size for online index creation */
 UNIV_INTERN unsigned long long	srv_online_max_size;
 
@@ -217,6 +225,9 @@ with mutex_enter(), which will wait until it gets the mutex. */
 
 #ifdef WITH_INNODB_DISALLOW_WRITES
 UNIV_INTERN os_event_t	srv_allow_writes_event;
+/* Must always init to FALSE. */
+UNIV_INTERN my_bool	srv_snapshot = FALSE;
+UNIV_INTERN ulong	srv_snapshot_timeout = 86400;
 #endif /* WITH_INNODB_DISALLOW_WRITES */
 
 /** The sort order table of the MySQL latin1_swedish_ci character set
@@ -303,6 +314,9 @@ UNIV_INTERN ulong	srv_n_purge_threads = 1;
 /* the number of pages to purge in one batch */
 UNIV_INTERN ulong	srv_purge_batch_size = 20;
 
+/* The number of page_cleaner threads to use, including the coordinator.*/
+UNIV_INTERN ulong	srv_n_page_cleaners = 1;
+
 /* Internal setting for "innodb_stats_method". Decides how InnoDB treats
 NULL value when collecting statistics. By default, it is set to
 SRV_STATS_NULLS_EQUAL(0), ie. all NULL value are treated equal */
@@ -1233,7 +1247,9 @@ srv_printf_innodb_monitor(
 	      "-------------------------------------\n", file);
 	ibuf_print(file);
 
-	ha_print_info(file, btr_search_sys->hash_index);
+	for (ulint i = 0; i < btr_search_n_parts; i++) {
+		ha_print_info(file, btr_search_sys->hash_tables[i]);
+	}
 
 	fprintf(file,
 		"%.2f hash searches/s, %.2f non-hash searches/s\n",
@@ -2379,6 +2395,12 @@ loop:
 
 		MONITOR_INC(MONITOR_MASTER_THREAD_SLEEP);
 
+#ifdef WITH_INNODB_DISALLOW_WRITES
+		if (fil_snapshot_end_if_expired(srv_snapshot_timeout)) {
+			srv_snapshot = FALSE;
+		}
+#endif /* WITH_INNODB_DISALLOW_WRITES */
+
 		if (srv_check_activity(old_activity_count)) {
 			old_activity_count = srv_get_activity_count();
 			srv_master_do_active_tasks();
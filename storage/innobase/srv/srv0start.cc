@@ -1869,6 +1869,7 @@ innobase_start_or_create_for_mysql(void)
 			    + srv_n_read_io_threads
 			    + srv_n_write_io_threads
 			    + srv_n_purge_threads
+			    + srv_n_page_cleaners
 			    /* FTS Parallel Sort */
 			    + fts_sort_pll_degree * FTS_NUM_AUX_INDEX
 			      * max_connections;
@@ -1879,6 +1880,12 @@ innobase_start_or_create_for_mysql(void)
 		srv_buf_pool_instances = 1;
 	}
 
+	if (srv_n_page_cleaners > srv_buf_pool_instances) {
+		/* Each page_cleaner thread flushes whole buffer pool
+		instances, more threads would have nothing to do. */
+		srv_n_page_cleaners = srv_buf_pool_instances;
+	}
+
 	srv_boot();
 
 	ib_logf(IB_LOG_LEVEL_INFO,
@@ -2116,6 +2123,18 @@ innobase_start_or_create_for_mysql(void)
 	recv_sys_create();
 	recv_sys_init(buf_pool_get_curr_size());
 
+#ifdef WITH_INNODB_DISALLOW_WRITES
+	/* Files copied from a snapshot are consistent only after the
+	pages saved by the snapshot are written back. */
+	if (!srv_read_only_mode) {
+		err = fil_snapshot_apply();
+
+		if (err != DB_SUCCESS) {
+			return(err);
+		}
+	}
+#endif /* WITH_INNODB_DISALLOW_WRITES */
+
 	err = open_or_create_data_files(&create_new_db,
 #ifdef UNIV_LOG_ARCHIVE
 					&min_arch_log_no, &max_arch_log_no,
@@ -2762,7 +2781,14 @@ files_checked:
 	}
 
 	if (!srv_read_only_mode) {
+		buf_flush_page_cleaner_init();
+
 		os_thread_create(buf_flush_page_cleaner_thread, NULL, NULL);
+
+		for (i = 1; i < srv_n_page_cleaners; ++i) {
+			os_thread_create(
+				buf_flush_page_cleaner_worker, NULL, NULL);
+		}
 	}
 
 #ifdef UNIV_DEBUG
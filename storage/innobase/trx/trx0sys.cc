@@ -46,6 +46,7 @@ Created 3/26/1996 Heikki Tuuri
 #include "log0recv.h"
 #include "os0file.h"
 #include "read0read.h"
+#include "srv0mon.h"
 
 #ifdef WITH_WSREP
 #include "ha_prototypes.h" /* wsrep_is_wsrep_xid() */
@@ -181,12 +182,7 @@ trx_sys_flush_max_trx_id(void)
 	mtr_t		mtr;
 	trx_sysf_t*	sys_header;
 
-#ifndef WITH_WSREP
-	/* wsrep_fake_trx_id  violates this assert
-	 * Copied from trx_sys_get_new_trx_id
-	 */
 	ut_ad(mutex_own(&trx_sys->mutex));
-#endif /* WITH_WSREP */
 
 	if (!srv_read_only_mode) {
 		mtr_start(&mtr);
@@ -201,6 +197,20 @@ trx_sys_flush_max_trx_id(void)
 	}
 }
 
+/*****************************************************************//**
+Allocates a transaction id which is not assigned to a transaction in
+trx_sys->rw_trx_list, without acquiring trx_sys->mutex.
+@return	new, allocated trx id */
+UNIV_INTERN
+trx_id_t
+trx_sys_get_new_trx_id_nolock(void)
+/*===============================*/
+{
+	MONITOR_ATOMIC_INC(MONITOR_TRX_ID_NOMUTEX);
+
+	return(trx_sys_alloc_trx_id(FALSE));
+}
+
 /*****************************************************************//**
 Updates the offset information about the end of the MySQL binlog entry
 which corresponds to the transaction just being committed. In a MySQL
@@ -395,6 +405,19 @@ trx_sys_update_wsrep_checkpoint(
 
 }
 
+lsn_t
+trx_sys_set_wsrep_checkpoint(const XID* xid)
+/*========================================*/
+{
+        mtr_t   mtr;
+
+        mtr_start(&mtr);
+        trx_sys_update_wsrep_checkpoint(xid, trx_sysf_get(&mtr), &mtr);
+        mtr_commit(&mtr);
+
+        return(mtr.end_lsn);
+}
+
 void
 trx_sys_read_wsrep_checkpoint(XID* xid)
 /*===================================*/
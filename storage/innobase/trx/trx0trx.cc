@@ -1227,6 +1227,7 @@ trx_commit_in_memory(
 		} else {
 			UT_LIST_REMOVE(trx_list, trx_sys->rw_trx_list, trx);
 			ut_d(trx->in_rw_trx_list = FALSE);
+			trx_sys->rw_trx_n_ended++;
 			MONITOR_INC(MONITOR_TRX_RW_COMMIT);
 		}
 
@@ -1249,7 +1250,10 @@ trx_commit_in_memory(
 
 	if (trx->global_read_view != NULL) {
 
-		mem_heap_empty(trx->global_read_view_heap);
+		/* Keep the view in global_read_view_heap, so that the
+		next transaction can reopen it. */
+
+		trx->closed_read_view = trx->global_read_view;
 
 		trx->global_read_view = NULL;
 	}
@@ -1474,6 +1478,7 @@ trx_cleanup_at_db_startup(
 
 	assert_trx_in_rw_list(trx);
 	ut_d(trx->in_rw_trx_list = FALSE);
+	trx_sys->rw_trx_n_ended++;
 
 	mutex_exit(&trx_sys->mutex);
 
@@ -1504,15 +1509,7 @@ trx_assign_read_view(
 		return(trx->read_view);
 	}
 
-	if (!trx->read_view) {
-
-		trx->read_view = read_view_open_now(
-			trx->id, trx->global_read_view_heap);
-
-		trx->global_read_view = trx->read_view;
-	}
-
-	return(trx->read_view);
+	return(read_view_open_for_mysql(trx));
 }
 
 /****************************************************************//**
@@ -105,4 +105,41 @@ TEST(Murmur3, Bug16396598)
     EXPECT_GT(4U, buckets[i]);
 }
 
+
+
+/* Check 128-bit hash against the reference implementation value. */
+
+TEST(Murmur3, Basic128)
+{
+  const char *str= "The quick brown fox jumps over the lazy dog";
+  const uchar expected[MURMUR3_128_LEN]=
+    { 0x6c, 0x1b, 0x07, 0xbc, 0x7b, 0xbc, 0x4b, 0xe3,
+      0x47, 0x93, 0x9a, 0xc4, 0xa9, 0x3c, 0x43, 0x7a };
+  uchar hash[MURMUR3_128_LEN];
+
+  murmur3_128((uchar*)str, strlen(str), 0, hash);
+  EXPECT_EQ(0, memcmp(expected, hash, sizeof(hash)));
+}
+
+
+/* Test that all tail lengths and seed matter for 128-bit hash. */
+
+TEST(Murmur3, TailAndSeed128)
+{
+  uchar buff[32];
+  uchar hash1[MURMUR3_128_LEN];
+  uchar hash2[MURMUR3_128_LEN];
+  memset(buff, 0, sizeof(buff));
+
+  for (size_t len= 1; len < sizeof(buff); ++len)
+  {
+    murmur3_128(buff, len - 1, 0, hash1);
+    murmur3_128(buff, len, 0, hash2);
+    EXPECT_NE(0, memcmp(hash1, hash2, sizeof(hash1)));
+
+    murmur3_128(buff, len, 1, hash1);
+    EXPECT_NE(0, memcmp(hash1, hash2, sizeof(hash1)));
+  }
+}
+
 }  // namespace